@@ -0,0 +1,305 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "BandedEigensolver.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	const PetscInt MaxIterations = 5;
+
+	// further solves once the growth shows convergence
+	const PetscInt Extra = 2;
+
+	// eigenvalues closer than Cluster ||A|| get mutually orthogonal vectors
+	const PetscReal Cluster = 1e-3;
+    }
+
+    BandedEigensolver::BandedEigensolver( MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _A(NULL), _N(0), _b(0), _norm(0), _pivmin(0), _counts(0), _iterations(0), _bisection(0), _inverse(0)
+    {}
+
+    void BandedEigensolver::solve( const BandedMatrix& A, PetscInt nev /*= 1*/, PetscTruth largest /*= PETSC_TRUE*/ )
+    {
+	PetscMPIInt rank;
+	PetscInt i, j, n;
+	PetscReal lo = 0, hi = 0, radius, pertol, shift;
+	PetscLogDouble t0, t1, t2;
+	std::vector< PetscReal > work;
+	std::vector< PetscInt > cluster;
+
+	_A = &A;
+	_N = A.size();
+	_b = A.lower();
+	_counts = _iterations = 0;
+	n = PetscMin( nev, _N );
+	MPI_Comm_rank( _comm, &rank );
+
+	PetscGetTime( &t0 );
+	gather( A );
+
+	_k.assign( n, 0.0 );
+	_X.assign( n * _N, 0.0 );
+	if ( !rank )
+	    {
+		// Gershgorin bounds of the symmetric band
+		for ( i = 0; i < _N; ++i )
+		    {
+			radius = 0;
+			for ( j = 1; j <= _b; ++j )
+			    {
+				if ( i - j >= 0 ) { radius += PetscAbsReal( _L[j+i*(_b+1)] ); }
+				if ( i + j < _N ) { radius += PetscAbsReal( _L[j+(i+j)*(_b+1)] ); }
+			    }
+			lo = i ? PetscMin( lo, _L[i*(_b+1)] - radius ) : _L[0] - radius;
+			hi = i ? PetscMax( hi, _L[i*(_b+1)] + radius ) : _L[0] + radius;
+		    }
+		_norm = PetscMax( PetscAbsReal( lo ), PetscAbsReal( hi ) );
+		_pivmin = std::numeric_limits< PetscReal >::min() * PetscMax( (PetscReal)1.0, _norm * _norm );
+		lo -= 2 * PETSC_MACHINE_EPSILON * _norm + _pivmin;
+		hi += 2 * PETSC_MACHINE_EPSILON * _norm + _pivmin;
+
+		for ( i = 0; i < n; ++i ) { _k[i] = bisect( largest ? _N - 1 - i : i, lo, hi, work ); }
+		PetscGetTime( &t1 );
+
+		pertol = 10 * PETSC_MACHINE_EPSILON * _norm;
+		for ( i = 0; i < n; ++i )
+		    {
+			// an eigenvalue repeated to working precision is moved off its neighbour
+			shift = _k[i];
+			if ( i && PetscAbsReal( _k[i] - _k[i-1] ) < pertol ) { shift = _k[i-1] + ( largest ? -pertol : pertol ); }
+
+			cluster.clear();
+			for ( j = i - 1; j >= 0 && PetscAbsReal( _k[j] - _k[i] ) <= Cluster * _norm; --j ) { cluster.push_back( j ); }
+			_iterations += inverseIteration( shift, &_X[i*_N], cluster );
+		    }
+	    }
+	else { PetscGetTime( &t1 ); }
+
+	MPI_Bcast( &_k[0], n, MPIU_REAL, 0, _comm );
+	MPI_Bcast( &_X[0], n * _N, MPIU_REAL, 0, _comm );
+	MPI_Bcast( &_counts, 1, MPIU_INT, 0, _comm );
+	MPI_Bcast( &_iterations, 1, MPIU_INT, 0, _comm );
+	PetscGetTime( &t2 );
+
+	_bisection = t1 - t0;
+	_inverse = t2 - t1;
+    }
+
+    void BandedEigensolver::getEigenpair( PetscInt i, PetscReal* k, Vec x /*= PETSC_NULL*/ ) const
+    {
+	PetscInt first, last, j;
+	PetscScalar* p;
+
+	*k = _k[i];
+	if ( !x ) { return; }
+
+	VecGetOwnershipRange( x, &first, &last );
+	VecGetArray( x, &p );
+	for ( j = first; j < last; ++j ) { p[j-first] = _X[j+i*_N]; }
+	VecRestoreArray( x, &p );
+    }
+
+    PetscReal BandedEigensolver::getRelativeError( PetscInt i ) const
+    {
+	PetscReal k, error, norm;
+	Vec x, y;
+
+	MatGetVecs( *_A, &x, &y );
+	getEigenpair( i, &k, x );
+	MatMult( *_A, x, y );
+	VecAXPY( y, -k, x );
+	VecNorm( y, NORM_2, &error );
+	VecNorm( x, NORM_2, &norm );
+	if ( k != 0 ) { norm *= PetscAbsReal( k ); }
+	VecDestroy( x );
+	VecDestroy( y );
+	return error / norm;
+    }
+
+    void BandedEigensolver::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Banded eigensolver: %d rows, %d lower diagonals, %d eigenpairs\n",_N,_b,(PetscInt)_k.size());
+	PetscPrintf(_comm," Sturm counts: %d, bisection %.3g s, inverse iterations: %d, %.3g s\n\n",_counts,_bisection,_iterations,_inverse);
+    }
+
+    void BandedEigensolver::gather( const BandedMatrix& A )
+    {
+	PetscMPIInt rank, size, p;
+	PetscInt first, last, i, k, w = _b + 1, complex = 0, any;
+	PetscScalar v;
+
+	MPI_Comm_rank( _comm, &rank );
+	MPI_Comm_size( _comm, &size );
+	A.getOwnershipRange( &first, &last );
+
+	std::vector< PetscReal > local( ( last - first ) * w + 1, 0.0 );
+	for ( i = first; i < last; ++i )
+	    {
+		for ( k = 0; k <= _b && k <= i; ++k )
+		    {
+			v = A.getValue( i, i - k );
+			local[k+(i-first)*w] = PetscRealPart( v );
+			if ( PetscImaginaryPart( v ) != 0.0 ) { complex = 1; }
+		    }
+	    }
+	MPI_Allreduce( &complex, &any, 1, MPIU_INT, MPI_MAX, _comm );
+	if ( any ) { throw std::runtime_error( "BandedEigensolver: the band must be real symmetric" ); }
+
+	PetscMPIInt count = ( last - first ) * w;
+	std::vector< PetscMPIInt > counts( size ), displs( size, 0 );
+	MPI_Gather( &count, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, _comm );
+	for ( p = 1; p < size; ++p ) { displs[p] = displs[p-1] + counts[p-1]; }
+
+	_L.clear();
+	if ( !rank ) { _L.resize( _N * w + 1 ); }
+	MPI_Gatherv( &local[0], count, MPIU_REAL, rank ? PETSC_NULL : &_L[0], &counts[0], &displs[0], MPIU_REAL, 0, _comm );
+    }
+
+    PetscInt BandedEigensolver::count( PetscReal s, std::vector< PetscReal >& work ) const
+    {
+	PetscInt negative = 0, w = _b + 1, i, j, k;
+	PetscReal d, l;
+
+	++_counts;
+
+	// the three-term recurrence, no copy of the band
+	if ( _b <= 1 )
+	    {
+		for ( d = 1, i = 0; i < _N; ++i )
+		    {
+			d = _L[i*w] - s - ( i && _b ? _L[1+i*w] * _L[1+i*w] / d : 0.0 );
+			if ( PetscAbsReal( d ) < _pivmin ) { d = -_pivmin; }
+			if ( d < 0 ) { ++negative; }
+		    }
+		return negative;
+	    }
+
+	// LDL^T of A - sI within the band, row i holding column i-k at work[k+i*w]
+	work.assign( _L.begin(), _L.begin() + _N * w );
+	for ( i = 0; i < _N; ++i ) { work[i*w] -= s; }
+	for ( j = 0; j < _N; ++j )
+	    {
+		d = work[j*w];
+		if ( PetscAbsReal( d ) < _pivmin ) { d = -_pivmin; }
+		if ( d < 0 ) { ++negative; }
+		for ( i = j + 1; i <= j + _b && i < _N; ++i )
+		    {
+			l = work[(i-j)+i*w] / d;
+			for ( k = j + 1; k <= i; ++k ) { work[(i-k)+i*w] -= l * work[(k-j)+k*w]; }
+		    }
+	    }
+	return negative;
+    }
+
+    PetscReal BandedEigensolver::bisect( PetscInt i, PetscReal lo, PetscReal hi, std::vector< PetscReal >& work ) const
+    {
+	PetscReal mid;
+
+	while ( hi - lo > 2 * PETSC_MACHINE_EPSILON * PetscMax( PetscAbsReal( lo ), PetscAbsReal( hi ) ) + 4 * _pivmin )
+	    {
+		mid = 0.5 * ( lo + hi );
+		if ( mid == lo || mid == hi ) { break; }
+		if ( count( mid, work ) > i ) { hi = mid; }
+		else { lo = mid; }
+	    }
+	return 0.5 * ( lo + hi );
+    }
+
+    PetscInt BandedEigensolver::inverseIteration( PetscReal k, PetscReal* x, const std::vector< PetscInt >& cluster ) const
+    {
+	PetscInt b = _b, w = 3 * b + 1, N = _N, i, j, c, p, last, its, extra = 0;
+	PetscReal l, s, norm, tiny = PETSC_MACHINE_EPSILON * PetscMax( _norm, _pivmin );
+	std::vector< PetscReal > T( N * w, 0.0 );
+	std::vector< PetscInt > piv( N );
+	unsigned long seed = 1;
+
+	// A - kI by rows, row i holding columns i-b..i+2b at T[(c-i+b)+i*w]
+	for ( i = 0; i < N; ++i )
+	    {
+		for ( c = PetscMax( i - b, 0 ); c <= i; ++c ) { T[(c-i+b)+i*w] = _L[(i-c)+i*(b+1)]; }
+		for ( c = i + 1; c <= i + b && c < N; ++c ) { T[(c-i+b)+i*w] = _L[(c-i)+c*(b+1)]; }
+		T[b+i*w] -= k;
+	    }
+
+	// LU with partial pivoting, the multipliers of column j below its pivot
+	for ( j = 0; j < N; ++j )
+	    {
+		last = PetscMin( j + 2 * b, N - 1 );
+		for ( p = j, i = j + 1; i <= j + b && i < N; ++i )
+		    {
+			if ( PetscAbsReal( T[(j-i+b)+i*w] ) > PetscAbsReal( T[(j-p+b)+p*w] ) ) { p = i; }
+		    }
+		piv[j] = p;
+		if ( p != j )
+		    {
+			for ( c = j; c <= last; ++c ) { std::swap( T[(c-j+b)+j*w], T[(c-p+b)+p*w] ); }
+		    }
+		if ( PetscAbsReal( T[b+j*w] ) < tiny ) { T[b+j*w] = tiny; }
+		for ( i = j + 1; i <= j + b && i < N; ++i )
+		    {
+			l = T[(j-i+b)+i*w] /= T[b+j*w];
+			for ( c = j + 1; c <= last; ++c ) { T[(c-i+b)+i*w] -= l * T[(c-j+b)+j*w]; }
+		    }
+	    }
+
+	for ( i = 0; i < N; ++i )
+	    {
+		seed = seed * 1103515245 + 12345;
+		x[i] = (PetscReal)( ( seed >> 16 ) & 0x7fff ) / 0x7fff - 0.5;
+	    }
+
+	for ( its = 1; its <= MaxIterations + Extra; ++its )
+	    {
+		for ( j = 0; j < N; ++j )
+		    {
+			if ( piv[j] != j ) { std::swap( x[j], x[piv[j]] ); }
+			for ( i = j + 1; i <= j + b && i < N; ++i ) { x[i] -= T[(j-i+b)+i*w] * x[j]; }
+		    }
+		for ( j = N - 1; j >= 0; --j )
+		    {
+			last = PetscMin( j + 2 * b, N - 1 );
+			for ( s = x[j], c = j + 1; c <= last; ++c ) { s -= T[(c-j+b)+j*w] * x[c]; }
+			x[j] = s / T[b+j*w];
+		    }
+
+		for ( c = 0; c < (PetscInt)cluster.size(); ++c )
+		    {
+			const PetscReal* v = &_X[cluster[c]*N];
+			for ( s = 0, i = 0; i < N; ++i ) { s += v[i] * x[i]; }
+			for ( i = 0; i < N; ++i ) { x[i] -= s * v[i]; }
+		    }
+
+		for ( norm = 0, i = 0; i < N; ++i ) { norm += x[i] * x[i]; }
+		norm = std::sqrt( norm );
+		for ( i = 0; i < N; ++i ) { x[i] /= norm; }
+
+		// a growth near 1/(eps ||A||) means k is an eigenvalue to working precision
+		if ( norm * tiny * 1e3 >= std::sqrt( 0.1 / N ) ) { ++extra; }
+		if ( extra > Extra || ( its == MaxIterations && !extra ) ) { break; }
+	    }
+	return PetscMin( its, MaxIterations + Extra );
+    }
+}
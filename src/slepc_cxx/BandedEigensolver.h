@@ -0,0 +1,104 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_BandedEigensolver_h
+#define _slepc_cxx_BandedEigensolver_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+#include "BandedMatrix.h"
+
+namespace slepc_cxx
+{
+    /*
+     * The nev smallest or largest eigenpairs of a real symmetric band, read
+     * from its lower half. The band is gathered on rank 0, where every
+     * eigenvalue is found by bisection on Sturm counts and its eigenvector by
+     * inverse iteration, then both are broadcast.
+     *
+     * A count is the number of negative pivots of the LDL^T factorisation of
+     * A - sI on the band itself, O(n b^2) for the half bandwidth b and the
+     * classical three-term recurrence for a tridiagonal matrix. Reducing a
+     * wider band to tridiagonal form first would cost O(n^2 b), so it is not
+     * done. Inverse iteration factors A - kI once per eigenvalue with partial
+     * pivoting within the band; the vectors of eigenvalues closer than
+     * 1e-3 ||A|| are kept orthogonal to each other. For a fixed bandwidth the
+     * whole solve is about O(n nev).
+     */
+    class BandedEigensolver : public core_library::Printable
+    {
+    public:
+	BandedEigensolver( MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// collective, A must outlive getRelativeError()
+	void solve( const BandedMatrix& A, PetscInt nev = 1, PetscTruth largest = PETSC_TRUE );
+
+	PetscInt getConverged() const { return _k.size(); }
+
+	// eigenvalues in descending order when largest, ascending otherwise
+	void getEigenpair( PetscInt i, PetscReal* k, Vec x = PETSC_NULL ) const;
+
+	// collective, ||Ax-kx|| / ||kx||
+	PetscReal getRelativeError( PetscInt i ) const;
+
+	// wall time of the bisection and of the inverse iteration
+	PetscLogDouble bisectionTime() const { return _bisection; }
+	PetscLogDouble inverseIterationTime() const { return _inverse; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	BandedEigensolver( const BandedEigensolver& );
+	BandedEigensolver& operator=( const BandedEigensolver& );
+
+	// the lower half of A on rank 0, row i holding A(i, i-k) at _L[k+i*(b+1)]
+	void gather( const BandedMatrix& A );
+
+	// eigenvalues of A strictly smaller than s
+	PetscInt count( PetscReal s, std::vector< PetscReal >& work ) const;
+
+	// the eigenvalue of index i in ascending order, within [lo, hi]
+	PetscReal bisect( PetscInt i, PetscReal lo, PetscReal hi, std::vector< PetscReal >& work ) const;
+
+	// unit eigenvector for k into x, orthogonal to the vectors of cluster
+	PetscInt inverseIteration( PetscReal k, PetscReal* x, const std::vector< PetscInt >& cluster ) const;
+
+    private:
+	MPI_Comm _comm;
+	const BandedMatrix* _A;
+	PetscInt _N;
+	PetscInt _b;
+	PetscReal _norm;
+	PetscReal _pivmin;
+
+	std::vector< PetscReal > _L;
+	std::vector< PetscReal > _k;
+	std::vector< PetscReal > _X;
+	mutable PetscInt _counts;
+	mutable PetscInt _iterations;
+	PetscLogDouble _bisection;
+	PetscLogDouble _inverse;
+    };
+}
+
+#endif // !_slepc_cxx_BandedEigensolver_h
@@ -0,0 +1,194 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <stdexcept>
+
+#include "BandedMatrix.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// rows of y kept in cache while every diagonal is added to them
+	const PetscInt Block = 512;
+    }
+
+    BandedMatrix::BandedMatrix( PetscInt N, PetscInt lower, PetscInt upper, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _N(N), _lower(lower), _upper(upper), _first(0), _m(PETSC_DECIDE), _shell(PETSC_NULL), _products(0)
+    {
+	PetscSplitOwnership( _comm, &_m, &_N );
+	create( _m );
+    }
+
+    BandedMatrix::BandedMatrix( Mat A )
+	: _shell(PETSC_NULL), _products(0)
+    {
+	PetscInt first, last, row, ncols, j;
+	const PetscInt* cols;
+	const PetscScalar* vals;
+
+	PetscObjectGetComm( (PetscObject)A, &_comm );
+	MatGetSize( A, &_N, PETSC_NULL );
+	bandwidth( A, &_lower, &_upper );
+	MatGetOwnershipRange( A, &first, &last );
+	create( last - first );
+
+	for ( row = first; row < last; ++row )
+	    {
+		MatGetRow( A, row, &ncols, &cols, &vals );
+		for ( j = 0; j < ncols; ++j ) { setValue( row, cols[j], vals[j] ); }
+		MatRestoreRow( A, row, &ncols, &cols, &vals );
+	    }
+    }
+
+    BandedMatrix::~BandedMatrix()
+    {
+	if ( _shell ) { MatDestroy( _shell ); }
+    }
+
+    void BandedMatrix::setValue( PetscInt i, PetscInt j, PetscScalar value )
+    {
+	PetscInt d = j - i;
+
+	if ( i < _first || i >= _first + _m || j < 0 || j >= _N || d < -_lower || d > _upper )
+	    {
+		throw std::runtime_error( "BandedMatrix: entry outside the band or the local rows" );
+	    }
+	_band[(d+_lower)*_m+i-_first] = value;
+    }
+
+    PetscScalar BandedMatrix::getValue( PetscInt i, PetscInt j ) const
+    {
+	PetscInt d = j - i;
+
+	if ( i < _first || i >= _first + _m ) { throw std::runtime_error( "BandedMatrix: row outside the local rows" ); }
+	return d < -_lower || d > _upper ? 0.0 : _band[(d+_lower)*_m+i-_first];
+    }
+
+    void BandedMatrix::bandwidth( Mat A, PetscInt* lower, PetscInt* upper )
+    {
+	PetscInt first, last, row, ncols, j, local[2] = { 0, 0 }, global[2];
+	const PetscInt* cols;
+	MPI_Comm comm;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MatGetOwnershipRange( A, &first, &last );
+	for ( row = first; row < last; ++row )
+	    {
+		MatGetRow( A, row, &ncols, &cols, PETSC_NULL );
+		for ( j = 0; j < ncols; ++j )
+		    {
+			local[0] = PetscMax( local[0], row - cols[j] );
+			local[1] = PetscMax( local[1], cols[j] - row );
+		    }
+		MatRestoreRow( A, row, &ncols, &cols, PETSC_NULL );
+	    }
+	MPI_Allreduce( local, global, 2, MPIU_INT, MPI_MAX, comm );
+	*lower = global[0];
+	*upper = global[1];
+    }
+
+    void BandedMatrix::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Banded operator: %d rows, %d lower and %d upper diagonals, products: %d\n\n",
+		    _N,_lower,_upper,_products);
+    }
+
+    void BandedMatrix::create( PetscInt m )
+    {
+	PetscInt last, room, fewest;
+
+	// the exchange of mult only reaches the neighbour ranks
+	room = m - PetscMax( _lower, _upper );
+	MPI_Allreduce( &room, &fewest, 1, MPIU_INT, MPI_MIN, _comm );
+	if ( fewest < 0 ) { throw std::runtime_error( "BandedMatrix: a rank owns fewer rows than the bandwidth" ); }
+
+	MPI_Scan( &m, &last, 1, MPIU_INT, MPI_SUM, _comm );
+	_m = m;
+	_first = last - m;
+	_band.assign( ( _lower + _upper + 1 ) * m, 0.0 );
+	_halo.assign( _lower + m + _upper, 0.0 );
+
+	MatCreateShell( _comm, m, m, _N, _N, this, &_shell );
+	MatShellSetOperation( _shell, MATOP_MULT, (void(*)(void))mult );
+	MatShellSetOperation( _shell, MATOP_GET_DIAGONAL, (void(*)(void))getDiagonal );
+    }
+
+    PetscErrorCode BandedMatrix::mult( Mat shell, Vec x, Vec y )
+    {
+	BandedMatrix* self;
+	PetscScalar *px, *py;
+	PetscMPIInt rank, size, prev, next;
+	MPI_Status status;
+	PetscInt r, r0, r1, d;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+
+	const PetscInt m = self->_m, lower = self->_lower, upper = self->_upper;
+	PetscScalar* h = &self->_halo[0];
+
+	ierr = VecGetArray( x, &px );CHKERRQ(ierr);
+	for ( r = 0; r < m; ++r ) { h[lower+r] = px[r]; }
+	ierr = VecRestoreArray( x, &px );CHKERRQ(ierr);
+
+	// the halo entries outside 0..N-1 are never received and stay zero
+	MPI_Comm_rank( self->_comm, &rank );
+	MPI_Comm_size( self->_comm, &size );
+	prev = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+	next = rank < size - 1 ? rank + 1 : MPI_PROC_NULL;
+	if ( upper ) { MPI_Sendrecv( h + lower, upper, MPIU_SCALAR, prev, 0, h + lower + m, upper, MPIU_SCALAR, next, 0, self->_comm, &status ); }
+	if ( lower ) { MPI_Sendrecv( h + m, lower, MPIU_SCALAR, next, 1, h, lower, MPIU_SCALAR, prev, 1, self->_comm, &status ); }
+
+	ierr = VecGetArray( y, &py );CHKERRQ(ierr);
+	for ( r0 = 0; r0 < m; r0 += Block )
+	    {
+		r1 = PetscMin( r0 + Block, m );
+		for ( r = r0; r < r1; ++r ) { py[r] = 0.0; }
+		for ( d = -lower; d <= upper; ++d )
+		    {
+			const PetscScalar* a = &self->_band[(d+lower)*m];
+			const PetscScalar* z = h + lower + d;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+			for ( r = r0; r < r1; ++r ) { py[r] += a[r] * z[r]; }
+		    }
+	    }
+	ierr = VecRestoreArray( y, &py );CHKERRQ(ierr);
+	++self->_products;
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode BandedMatrix::getDiagonal( Mat shell, Vec d )
+    {
+	BandedMatrix* self;
+	PetscScalar* p;
+	PetscInt r;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = VecGetArray( d, &p );CHKERRQ(ierr);
+	for ( r = 0; r < self->_m; ++r ) { p[r] = self->_band[self->_lower*self->_m+r]; }
+	ierr = VecRestoreArray( d, &p );CHKERRQ(ierr);
+	PetscFunctionReturn(0);
+    }
+}
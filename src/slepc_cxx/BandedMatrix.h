@@ -0,0 +1,99 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_BandedMatrix_h
+#define _slepc_cxx_BandedMatrix_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Square operator with lower + upper + 1 nonzero diagonals, stored by
+     * diagonal over the local rows and applied through a shell matrix. The
+     * product reads every diagonal and the matching slice of x with unit
+     * stride, with no column indices to load, so the compiler vectorises it;
+     * the neighbour ranks only exchange the lower and upper entries of x
+     * next to their boundary.
+     *
+     * Every rank needs at least max(lower, upper) rows. The shell provides
+     * the product and the diagonal, see BandedEigensolver for a direct
+     * solve of the symmetric case.
+     */
+    class BandedMatrix : public core_library::Printable
+    {
+    public:
+	// collective, all zero, local rows as PetscSplitOwnership
+	BandedMatrix( PetscInt N, PetscInt lower, PetscInt upper, MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// collective, copy of an assembled A with its row layout and the smallest band holding it
+	BandedMatrix( Mat A );
+
+	~BandedMatrix();
+
+	// local row i only, j within the band
+	void setValue( PetscInt i, PetscInt j, PetscScalar value );
+	PetscScalar getValue( PetscInt i, PetscInt j ) const;
+
+	PetscInt size() const { return _N; }
+	PetscInt lower() const { return _lower; }
+	PetscInt upper() const { return _upper; }
+	void getOwnershipRange( PetscInt* first, PetscInt* last ) const { *first = _first; *last = _first + _m; }
+	MPI_Comm comm() const { return _comm; }
+
+	// collective, the largest lower and upper bandwidths of an assembled A
+	static void bandwidth( Mat A, PetscInt* lower, PetscInt* upper );
+
+	operator Mat() const { return _shell; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	BandedMatrix( const BandedMatrix& );
+	BandedMatrix& operator=( const BandedMatrix& );
+
+	void create( PetscInt m );
+
+	static PetscErrorCode mult( Mat shell, Vec x, Vec y );
+	static PetscErrorCode getDiagonal( Mat shell, Vec d );
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _N;
+	PetscInt _lower;
+	PetscInt _upper;
+	PetscInt _first;
+	PetscInt _m;
+
+	// entry (first + r, first + r + d) at _band[(d + lower) * m + r]
+	std::vector< PetscScalar > _band;
+
+	// x over the local rows, widened by lower entries before and upper after
+	mutable std::vector< PetscScalar > _halo;
+
+	Mat _shell;
+	PetscInt _products;
+    };
+}
+
+#endif // !_slepc_cxx_BandedMatrix_h
@@ -0,0 +1,115 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include <petscblaslapack.h>
+
+#include "CholeskyQR.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// in place, G = R^H R with R upper triangular, PETSC_FALSE on a non positive pivot
+	PetscTruth cholesky( std::vector< PetscScalar >& G, PetscInt l )
+	{
+	    PetscInt i, j, k;
+
+	    for ( j = 0; j < l; ++j )
+		{
+		    PetscReal d = PetscRealPart( G[j+j*l] );
+		    for ( i = 0; i < j; ++i ) { d -= PetscRealPart( PetscConj( G[i+j*l] ) * G[i+j*l] ); }
+		    if ( !( d > 0 ) ) { return PETSC_FALSE; }
+		    d = std::sqrt( d );
+		    G[j+j*l] = d;
+		    for ( k = j + 1; k < l; ++k )
+			{
+			    PetscScalar s = G[j+k*l];
+			    for ( i = 0; i < j; ++i ) { s -= PetscConj( G[i+j*l] ) * G[i+k*l]; }
+			    G[j+k*l] = s / d;
+			}
+		    for ( i = j + 1; i < l; ++i ) { G[i+j*l] = 0; }
+		}
+	    return PETSC_TRUE;
+	}
+
+	void invertUpper( const std::vector< PetscScalar >& R, std::vector< PetscScalar >& Ri, PetscInt l )
+	{
+	    PetscInt i, j, k;
+
+	    Ri.assign( l * l, 0.0 );
+	    for ( j = 0; j < l; ++j )
+		{
+		    Ri[j+j*l] = 1.0 / R[j+j*l];
+		    for ( i = j - 1; i >= 0; --i )
+			{
+			    PetscScalar s = 0;
+			    for ( k = i + 1; k <= j; ++k ) { s += R[i+k*l] * Ri[k+j*l]; }
+			    Ri[i+j*l] = -s / R[i+i*l];
+			}
+		}
+	}
+    }
+
+    PetscInt choleskyQR( MPI_Comm comm, std::vector< PetscScalar >& X, PetscInt m, PetscInt l, std::vector< PetscScalar >& R )
+    {
+	PetscBLASInt bm = m, bl = l, ld = PetscMax( m, 1 );
+	PetscScalar one = 1.0, zero = 0.0;
+	std::vector< PetscScalar > local( l * l, 0.0 ), G( l * l ), Ri, Y( X.size() ), T( l * l );
+	PetscInt passes = 2, shifted = 0, pass, j, M;
+
+	MPI_Allreduce( &m, &M, 1, MPIU_INT, MPI_SUM, comm );
+
+	R.assign( l * l, 0.0 );
+	for ( j = 0; j < l; ++j ) { R[j+j*l] = 1.0; }
+
+	for ( pass = 0; pass < passes; ++pass )
+	    {
+		if ( m > 0 ) { BLASgemm_( "C", "N", &bl, &bl, &bm, &one, &X[0], &ld, &X[0], &ld, &zero, &local[0], &bl ); }
+		MPI_Allreduce( &local[0], &G[0], l * l, MPIU_SCALAR, MPIU_SUM, comm );
+
+		std::vector< PetscScalar > gram( G );
+		if ( !cholesky( G, l ) )
+		    {
+			// the shift of shifted Cholesky QR, one more pass restores the orthogonality
+			PetscReal trace = 0, shift;
+			for ( j = 0; j < l; ++j ) { trace += PetscRealPart( gram[j+j*l] ); }
+			// in real arithmetic, M l does not fit an int on the tall problems
+			shift = 11.0 * ( (PetscReal)M * l + (PetscReal)l * ( l + 1 ) ) * PETSC_MACHINE_EPSILON * trace;
+			for ( j = 0; j < l; ++j ) { gram[j+j*l] += shift; }
+			G = gram;
+			if ( !cholesky( G, l ) ) { throw std::runtime_error( "choleskyQR: breakdown" ); }
+			++shifted;
+			if ( passes < 4 ) { ++passes; }
+		    }
+
+		invertUpper( G, Ri, l );
+		if ( m > 0 )
+		    {
+			BLASgemm_( "N", "N", &bm, &bl, &bl, &one, &X[0], &ld, &Ri[0], &bl, &zero, &Y[0], &ld );
+			X.swap( Y );
+		    }
+		BLASgemm_( "N", "N", &bl, &bl, &bl, &one, &G[0], &bl, &R[0], &bl, &zero, &T[0], &bl );
+		R.swap( T );
+	    }
+	return shifted;
+    }
+}
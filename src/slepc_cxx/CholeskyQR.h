@@ -0,0 +1,42 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_CholeskyQR_h
+#define _slepc_cxx_CholeskyQR_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * X = Q R in place for a distributed tall block, X holding the m local
+     * rows of its l columns in column-major order and R being the l x l upper
+     * triangular factor, the same on every rank.
+     *
+     * Cholesky QR run twice: the Gram matrix is one BLAS-3 product and one
+     * reduction, X is then multiplied by R^-1. When the Gram matrix is not
+     * numerically positive definite the pass is shifted and one more is run.
+     * Collective, returns the number of shifted passes.
+     */
+    PetscInt choleskyQR( MPI_Comm comm, std::vector< PetscScalar >& X, PetscInt m, PetscInt l, std::vector< PetscScalar >& R );
+}
+
+#endif // !_slepc_cxx_CholeskyQR_h
@@ -0,0 +1,775 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <petscblaslapack.h>
+
+#include "CompactQEP.h"
+#include "QEPResidual.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	PetscScalar* data( std::vector< PetscScalar >& v ) { return v.empty() ? PETSC_NULL : &v[0]; }
+
+	// collective, 2-norm of a distributed array
+	PetscReal norm( MPI_Comm comm, const PetscScalar* p, PetscInt n )
+	{
+	    PetscReal local = 0, global;
+	    for ( PetscInt i = 0; i < n; ++i ) { local += PetscRealPart( PetscConj( p[i] ) * p[i] ); }
+	    MPI_Allreduce( &local, &global, 1, MPIU_REAL, MPI_SUM, comm );
+	    return std::sqrt( global );
+	}
+
+	// by decreasing magnitude, a conjugate pair staying in place
+	bool greater( const std::pair< PetscReal, PetscInt >& a, const std::pair< PetscReal, PetscInt >& b )
+	{
+	    return a.first > b.first;
+	}
+    }
+
+    CompactQEP::CompactQEP( Structure structure /*= Automatic*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _structure(structure), _used(General), _configured(PETSC_FALSE), _M(PETSC_NULL), _C(PETSC_NULL), _K(PETSC_NULL),
+	  _sigma(0), _shifted(PETSC_FALSE), _Ms(PETSC_NULL), _Cs(PETSC_NULL), _Ks(PETSC_NULL),
+	  _x1(PETSC_NULL), _x2(PETSC_NULL), _y(PETSC_NULL), _r(PETSC_NULL),
+	  _n(0), _ncv(0), _ld(0), _l(0), _nconv(0), _iterations(0), _vectors(0), _orthogonalization(0), _lost(PETSC_FALSE)
+    {
+	KSPCreate( comm, &_ksp );
+	KSPAppendOptionsPrefix( _ksp, "compact_" );
+    }
+
+    CompactQEP::~CompactQEP()
+    {
+	release();
+	KSPDestroy( _ksp );
+    }
+
+    void CompactQEP::solve( Mat M, Mat C, Mat K, PetscInt nev /*= 1*/, PetscInt ncv /*= PETSC_DECIDE*/, PetscReal tol /*= 1e-8*/, PetscInt maxit /*= 100*/ )
+    {
+	PetscInt N, m, k = 0, p, c, i;
+	PetscTruth breakdown = PETSC_FALSE;
+	PetscReal nrm;
+	PetscScalar dot, sum, z1[2], z2[2];
+	PetscRandom rnd;
+	std::vector< PetscScalar > eigr, eigi, Y;
+	std::vector< PetscReal > residuals;
+
+	// whatever a solve that threw left behind
+	release();
+	_M = M;
+	_C = C;
+	_K = K;
+	_Ms = M;
+	_Cs = C;
+	_Ks = K;
+	if ( _shifted )
+	    {
+		// P(sigma) and C + 2 sigma M, assembled once for the whole solve
+		MatDuplicate( K, MAT_COPY_VALUES, &_Ms );
+		MatAXPY( _Ms, _sigma, C, DIFFERENT_NONZERO_PATTERN );
+		MatAXPY( _Ms, _sigma * _sigma, M, DIFFERENT_NONZERO_PATTERN );
+		MatDuplicate( C, MAT_COPY_VALUES, &_Cs );
+		MatAXPY( _Cs, 2.0 * _sigma, M, DIFFERENT_NONZERO_PATTERN );
+		_Ks = M;
+	    }
+	_used = ( _structure == Automatic ) ? detect( _Ms, _Cs, _Ks ) : _structure;
+	MatGetSize( K, &N, PETSC_NULL );
+	MatGetLocalSize( K, &_n, PETSC_NULL );
+
+	_ncv = PetscMin( ncv == PETSC_DECIDE ? PetscMax( 2 * nev, nev + 15 ) : ncv, 2 * N );
+	nev = PetscMin( nev, _ncv - 1 );
+	_ld = _ncv + 2;
+	_Q.assign( _n * _ld, 0.0 );
+	_U1.assign( _ld * ( _ncv + 1 ), 0.0 );
+	_U2.assign( _ld * ( _ncv + 1 ), 0.0 );
+	_H.assign( ( _ncv + 1 ) * _ncv, 0.0 );
+	_omega.assign( _ncv + 1, 1.0 );
+	_MQ.assign( _used == General ? 0 : _ld * _ld, 0.0 );
+	_XQ.assign( _used == General ? 0 : _ld * _ld, 0.0 );
+	_nconv = 0;
+	_iterations = 0;
+	_orthogonalization = 0;
+	_lost = PETSC_FALSE;
+
+	KSPSetOperators( _ksp, _Ms, _Ms, DIFFERENT_NONZERO_PATTERN );
+	if ( !_configured )
+	    {
+		KSPSetFromOptions( _ksp );
+		_configured = PETSC_TRUE;
+	    }
+
+	MatGetVecs( K, &_x1, &_y );
+	VecDuplicate( _x1, &_x2 );
+	VecDuplicate( _x1, &_r );
+
+	// v_1 = [q1; q2] with random orthonormal q1 and q2, [q; 0] would be B-neutral for a zero damping
+	PetscRandomCreate( _comm, &rnd );
+	PetscRandomSetFromOptions( rnd );
+	for ( c = 0; c < 2; ++c )
+	    {
+		VecPlaceArray( _r, data( _Q ) + c * _n );
+		VecSetRandom( _r, rnd );
+		VecResetArray( _r );
+	    }
+	PetscRandomDestroy( rnd );
+	for ( c = 0; c < 2; ++c )
+	    {
+		PetscScalar* q = data( _Q ) + c * _n;
+		if ( c == 1 )
+		    {
+			sum = 0;
+			for ( i = 0; i < _n; ++i ) { sum += PetscConj( _Q[i] ) * q[i]; }
+			MPI_Allreduce( &sum, &dot, 1, MPIU_SCALAR, MPIU_SUM, _comm );
+			for ( i = 0; i < _n; ++i ) { q[i] -= dot * _Q[i]; }
+		    }
+		nrm = norm( _comm, q, _n );
+		for ( i = 0; i < _n; ++i ) { q[i] /= nrm; }
+		_l = c + 1;
+		if ( _used != General ) { project(); }
+	    }
+	_vectors = 2;
+	_U1[0] = 1.0;
+	_U2[1] = 1.0;
+	nrm = 2;
+	if ( _used != General )
+	    {
+		applyW( &_U1[0], &_U2[0], z1, z2 );
+		nrm = PetscRealPart( z1[0] + z2[1] );
+		_omega[0] = nrm > 0 ? 1.0 : -1.0;
+	    }
+	_U1[0] /= std::sqrt( PetscAbsReal( nrm ) );
+	_U2[1] /= std::sqrt( PetscAbsReal( nrm ) );
+
+	for ( ;; )
+	    {
+		++_iterations;
+		m = _ncv;
+		for ( i = k; i < _ncv; ++i )
+		    {
+			if ( !step( i ) )
+			    {
+				m = i + 1;
+				breakdown = PETSC_TRUE;
+				break;
+			    }
+		    }
+
+		// Q is full before v_{i+1} could be added: the cycle ends at m = i and the restart frees
+		// the columns, unless no step was made since the last one
+		if ( _lost && i > k && i > 1 )
+		    {
+			_lost = PETSC_FALSE;
+			breakdown = PETSC_FALSE;
+			m = i;
+		    }
+		if ( _lost )
+		    {
+			_nconv = 0;
+			break;
+		    }
+
+		ritz( m, eigr, eigi, Y, residuals );
+		for ( _nconv = 0; _nconv < m; ++_nconv )
+		    {
+			PetscReal a = PetscAbsScalar( eigr[_nconv] ), b = PetscAbsScalar( eigi[_nconv] );
+			if ( residuals[_nconv] > tol * std::sqrt( a * a + b * b ) ) { break; }
+		    }
+		if ( _nconv >= nev || breakdown || _iterations >= maxit ) { break; }
+
+		// the converged ones and half of the others, a conjugate pair is not split
+		p = PetscMax( _nconv, nev );
+		p = PetscMin( p + ( m - p ) / 2, m - 1 );
+		if ( PetscRealPart( eigi[p-1] ) > 0 ) { p = ( p + 1 < m ) ? p + 1 : p - 1; }
+		k = restart( m, p, Y );
+	    }
+
+	// x = Q U1 y, the top block of the Ritz vector
+	c = _nconv;
+	_eigr.assign( eigr.begin(), eigr.begin() + c );
+	_eigi.assign( eigi.begin(), eigi.begin() + c );
+	_X.assign( _n * c, 0.0 );
+	if ( c > 0 )
+	    {
+		PetscBLASInt bn = _n, bl = _l, bm = m, bc = c, ld = PetscMax( _n, 1 ), ldu = _ld;
+		PetscScalar one = 1.0, zero = 0.0;
+		std::vector< PetscScalar > G( _l * c );
+		std::vector< PetscReal > local( c, 0.0 ), sums( c );
+
+		BLASgemm_( "N", "N", &bl, &bc, &bm, &one, &_U1[0], &ldu, &Y[0], &bm, &zero, &G[0], &bl );
+		if ( _n > 0 ) { BLASgemm_( "N", "N", &bn, &bc, &bl, &one, &_Q[0], &ld, &G[0], &bl, &zero, &_X[0], &ld ); }
+
+		for ( p = 0; p < c; ++p )
+		    {
+			for ( i = 0; i < _n; ++i ) { local[p] += PetscRealPart( PetscConj( _X[i+p*_n] ) * _X[i+p*_n] ); }
+		    }
+		MPI_Allreduce( &local[0], &sums[0], c, MPIU_REAL, MPI_SUM, _comm );
+		for ( p = 0; p < c; ++p )
+		    {
+			// the real and imaginary parts of a pair share one norm
+			PetscReal s = sums[p];
+			if ( PetscRealPart( _eigi[p] ) > 0 && p + 1 < c ) { s += sums[p+1]; }
+			else if ( PetscRealPart( _eigi[p] ) < 0 && p > 0 ) { s += sums[p-1]; }
+			s = std::sqrt( s );
+			for ( i = 0; i < _n; ++i ) { _X[i+p*_n] /= ( s > 0 ? s : 1 ); }
+		    }
+	    }
+
+	// l = sigma + 1/t, a pair t = a +- ib giving sigma + (a -+ ib) / |t|^2 with the same vectors
+	for ( p = 0; p < c && _shifted; ++p )
+	    {
+#ifdef PETSC_USE_COMPLEX
+		_eigr[p] = _sigma + 1.0 / _eigr[p];
+#else
+		PetscReal a = _eigr[p], b = _eigi[p], t = a * a + b * b;
+		_eigr[p] = _sigma + a / t;
+		_eigi[p] = b / t;
+		if ( b < 0 )
+		    {
+			// the vector of the positive imaginary part is now xr - i xi
+			for ( i = 0; i < _n; ++i ) { _X[i+p*_n] = -_X[i+p*_n]; }
+		    }
+#endif
+	    }
+
+	release();
+
+	if ( _lost )
+	    {
+		throw std::runtime_error( "CompactQEP: [U1 U2] has full rank, the basis no longer fits in Q; increase ncv or use the linearization" );
+	    }
+    }
+
+    void CompactQEP::release()
+    {
+	if ( _Ms && _Ms != _M ) { MatDestroy( _Ms ); }
+	if ( _Cs && _Cs != _C ) { MatDestroy( _Cs ); }
+	_Ms = _Cs = _Ks = PETSC_NULL;
+	if ( _x1 ) { VecDestroy( _x1 ); _x1 = PETSC_NULL; }
+	if ( _x2 ) { VecDestroy( _x2 ); _x2 = PETSC_NULL; }
+	if ( _y ) { VecDestroy( _y ); _y = PETSC_NULL; }
+	if ( _r ) { VecDestroy( _r ); _r = PETSC_NULL; }
+    }
+
+    CompactQEP::Structure CompactQEP::detect( Mat M, Mat C, Mat K ) const
+    {
+	PetscTruth m = PETSC_FALSE, k = PETSC_FALSE, c = PETSC_FALSE, shell;
+	Mat matrices[3] = { M, C, K };
+
+	// MatIsSymmetric and MatTranspose would fail on them with an error trace
+	for ( PetscInt i = 0; i < 3; ++i )
+	    {
+		PetscTypeCompare( (PetscObject)matrices[i], MATSHELL, &shell );
+		if ( shell ) { return General; }
+	    }
+
+#ifdef PETSC_USE_COMPLEX
+	MatIsHermitian( M, 0.0, &m );
+	MatIsHermitian( K, 0.0, &k );
+	if ( !m || !k ) { return General; }
+	MatIsHermitian( C, 0.0, &c );
+#else
+	PetscReal norm = 0, skew = 1;
+	Mat T;
+
+	MatIsSymmetric( M, 0.0, &m );
+	MatIsSymmetric( K, 0.0, &k );
+	if ( !m || !k ) { return General; }
+
+	// C^T + C = 0, a zero damping included since the form [K 0; 0 M] may then be definite
+	MatTranspose( C, MAT_INITIAL_MATRIX, &T );
+	MatNorm( C, NORM_FROBENIUS, &norm );
+	MatAXPY( T, 1.0, C, DIFFERENT_NONZERO_PATTERN );
+	MatNorm( T, NORM_FROBENIUS, &skew );
+	MatDestroy( T );
+	if ( skew <= 100 * PETSC_MACHINE_EPSILON * norm ) { return Gyroscopic; }
+	MatIsSymmetric( C, 0.0, &c );
+#endif
+	return c ? Symmetric : General;
+    }
+
+    PetscTruth CompactQEP::step( PetscInt j )
+    {
+	PetscInt l, ldh = _ncv + 1, L, i, c, pass;
+
+	// rounding can raise the rank of [U1 U2] above j + 1, a pseudo-Lanczos basis being far from orthonormal;
+	// when no column of Q can be freed without dropping a direction, the cycle ends here
+	if ( _l >= _ld ) { compress( j + 1 ); }
+	if ( _l >= _ld )
+	    {
+		_lost = PETSC_TRUE;
+		return PETSC_FALSE;
+	    }
+	l = _l;
+
+	PetscBLASInt bn = _n, bl = l, ld = PetscMax( _n, 1 ), inc = 1;
+	PetscScalar one = 1.0, zero = 0.0, mone = -1.0;
+	PetscScalar* x;
+	PetscScalar* r = data( _Q ) + l * _n;
+	PetscReal r0, beta, nsv, nrm, nu;
+	PetscLogDouble t0, t1;
+	std::vector< PetscScalar > s( l + 1, 0.0 ), local( l ), d( l );
+
+	// x1 = Q U1 e_j, x2 = Q U2 e_j
+	VecGetArray( _x1, &x );
+	if ( _n > 0 ) { BLASgemv_( "N", &bn, &bl, &one, &_Q[0], &ld, &_U1[j*_ld], &inc, &zero, x, &inc ); }
+	VecRestoreArray( _x1, &x );
+	VecGetArray( _x2, &x );
+	if ( _n > 0 ) { BLASgemv_( "N", &bn, &bl, &one, &_Q[0], &ld, &_U2[j*_ld], &inc, &zero, x, &inc ); }
+	VecRestoreArray( _x2, &x );
+
+	// r = -M^-1 (K x1 + C x2), in the next column of Q
+	MatMult( _Ks, _x1, _y );
+	MatMult( _Cs, _x2, _x1 );
+	VecAXPY( _y, 1.0, _x1 );
+	VecScale( _y, -1.0 );
+	VecPlaceArray( _r, r );
+	KSPSolve( _ksp, _y, _r );
+	VecResetArray( _r );
+
+	// r = Q s + beta q, classical Gram-Schmidt run twice
+	PetscGetTime( &t0 );
+	r0 = norm( _comm, r, _n );
+	for ( pass = 0; pass < 2; ++pass )
+	    {
+		std::fill( local.begin(), local.end(), 0.0 );
+		if ( _n > 0 ) { BLASgemv_( "C", &bn, &bl, &one, &_Q[0], &ld, r, &inc, &zero, &local[0], &inc ); }
+		MPI_Allreduce( &local[0], &d[0], l, MPIU_SCALAR, MPIU_SUM, _comm );
+		if ( _n > 0 ) { BLASgemv_( "N", &bn, &bl, &mone, &_Q[0], &ld, &d[0], &inc, &one, r, &inc ); }
+		for ( i = 0; i < l; ++i ) { s[i] += d[i]; }
+	    }
+	beta = norm( _comm, r, _n );
+	PetscGetTime( &t1 );
+	_orthogonalization += t1 - t0;
+
+	// a new direction unless r already lies in the span of Q
+	if ( beta > 100 * PETSC_MACHINE_EPSILON * r0 )
+	    {
+		for ( i = 0; i < _n; ++i ) { r[i] /= beta; }
+		s[l] = beta;
+		++_l;
+		_vectors = PetscMax( _vectors, _l );
+		if ( _used != General )
+		    {
+			// the form is part of the structured orthogonalisation
+			PetscGetTime( &t0 );
+			project();
+			PetscGetTime( &t1 );
+			_orthogonalization += t1 - t0;
+		    }
+	    }
+	L = _l;
+
+	// coordinates of S v_j = [Q w1; Q w2], then Arnoldi, or pseudo-Lanczos for the form W, with a full
+	// reorthogonalisation that is cheap on the coordinates and keeps V^H W V = Omega through the restarts
+	PetscGetTime( &t0 );
+	std::vector< PetscScalar > w1( L, 0.0 ), w2( L, 0.0 ), z1( L ), z2( L ), h( j + 1, 0.0 );
+	for ( i = 0; i < l; ++i ) { w1[i] = _U2[i+j*_ld]; }
+	for ( i = 0; i < L; ++i ) { w2[i] = s[i]; }
+	nsv = 0;
+	for ( i = 0; i < L; ++i ) { nsv += PetscRealPart( PetscConj( w1[i] ) * w1[i] + PetscConj( w2[i] ) * w2[i] ); }
+
+	for ( pass = 0; pass < 2; ++pass )
+	    {
+		if ( _used == General )
+		    {
+			z1 = w1;
+			z2 = w2;
+		    }
+		else
+		    {
+			applyW( &w1[0], &w2[0], &z1[0], &z2[0] );
+		    }
+		for ( c = 0; c <= j; ++c )
+		    {
+			h[c] = 0;
+			for ( i = 0; i < L; ++i ) { h[c] += PetscConj( _U1[i+c*_ld] ) * z1[i] + PetscConj( _U2[i+c*_ld] ) * z2[i]; }
+			h[c] *= _omega[c];
+		    }
+		for ( c = 0; c <= j; ++c )
+		    {
+			for ( i = 0; i < L; ++i )
+			    {
+				w1[i] -= _U1[i+c*_ld] * h[c];
+				w2[i] -= _U2[i+c*_ld] * h[c];
+			    }
+			_H[c+j*ldh] += h[c];
+		    }
+	    }
+
+	nrm = 0;
+	for ( i = 0; i < L; ++i ) { nrm += PetscRealPart( PetscConj( w1[i] ) * w1[i] + PetscConj( w2[i] ) * w2[i] ); }
+	nu = nrm;
+	nrm = std::sqrt( nrm );
+	if ( _used != General )
+	    {
+		applyW( &w1[0], &w2[0], &z1[0], &z2[0] );
+		nu = 0;
+		for ( i = 0; i < L; ++i ) { nu += PetscRealPart( PetscConj( w1[i] ) * z1[i] + PetscConj( w2[i] ) * z2[i] ); }
+	    }
+	PetscGetTime( &t1 );
+	_orthogonalization += t1 - t0;
+
+	// an invariant subspace, or a W-neutral direction that the recurrence cannot normalise:
+	// the last vector is then only normalised in the 2-norm so that the residuals stay exact
+	PetscTruth next = PETSC_TRUE;
+	PetscReal scale = 0;
+	for ( i = 0; i < L && _used != General; ++i ) { scale = PetscMax( scale, PetscAbsScalar( _MQ[i+i*_ld] ) + PetscAbsScalar( _XQ[i+i*_ld] ) ); }
+	if ( nrm <= 10 * PETSC_MACHINE_EPSILON * std::sqrt( nsv ) ) { nrm = 0; next = PETSC_FALSE; }
+	else if ( _used != General && PetscAbsReal( nu ) <= 100 * PETSC_MACHINE_EPSILON * nrm * nrm * scale ) { next = PETSC_FALSE; }
+	if ( !next ) { nu = nrm * nrm; }
+
+	beta = std::sqrt( PetscAbsReal( nu ) );
+	_omega[j+1] = nu < 0 ? -1.0 : 1.0;
+	_H[j+1+j*ldh] = beta;
+	for ( i = 0; i < _ld; ++i )
+	    {
+		_U1[i+(j+1)*_ld] = ( i < L && beta > 0 ) ? w1[i] / beta : 0.0;
+		_U2[i+(j+1)*_ld] = ( i < L && beta > 0 ) ? w2[i] / beta : 0.0;
+	    }
+	return next;
+    }
+
+    void CompactQEP::applyW( const PetscScalar* a1, const PetscScalar* a2, PetscScalar* z1, PetscScalar* z2 ) const
+    {
+	PetscInt L = _l, i, k;
+
+	// [C M; M 0] for the symmetric form, [K 0; 0 M] for the gyroscopic one, X standing for C or K
+	for ( i = 0; i < L; ++i )
+	    {
+		z1[i] = 0;
+		z2[i] = 0;
+		for ( k = 0; k < L; ++k )
+		    {
+			z1[i] += _XQ[i+k*_ld] * a1[k];
+			z2[i] += _MQ[i+k*_ld] * ( _used == Symmetric ? a1[k] : a2[k] );
+			if ( _used == Symmetric ) { z1[i] += _MQ[i+k*_ld] * a2[k]; }
+		    }
+	    }
+    }
+
+    void CompactQEP::project()
+    {
+	PetscInt c = _l - 1, i;
+	PetscBLASInt bn = _n, bl = _l, ld = PetscMax( _n, 1 ), inc = 1;
+	PetscScalar one = 1.0, zero = 0.0;
+	PetscScalar* x;
+	std::vector< PetscScalar > local( 2 * _l, 0.0 ), d( 2 * _l );
+
+	VecPlaceArray( _r, data( _Q ) + c * _n );
+	MatMult( _Ms, _r, _x1 );
+	MatMult( _used == Symmetric ? _Cs : _Ks, _r, _x2 );
+	VecResetArray( _r );
+
+	// both columns in one reduction
+	VecGetArray( _x1, &x );
+	if ( _n > 0 ) { BLASgemv_( "C", &bn, &bl, &one, &_Q[0], &ld, x, &inc, &zero, &local[0], &inc ); }
+	VecRestoreArray( _x1, &x );
+	VecGetArray( _x2, &x );
+	if ( _n > 0 ) { BLASgemv_( "C", &bn, &bl, &one, &_Q[0], &ld, x, &inc, &zero, &local[_l], &inc ); }
+	VecRestoreArray( _x2, &x );
+	MPI_Allreduce( &local[0], &d[0], 2 * _l, MPIU_SCALAR, MPIU_SUM, _comm );
+
+	for ( i = 0; i <= c; ++i )
+	    {
+		_MQ[i+c*_ld] = d[i];
+		_MQ[c+i*_ld] = PetscConj( d[i] );
+		_XQ[i+c*_ld] = d[_l+i];
+		_XQ[c+i*_ld] = PetscConj( d[_l+i] );
+	    }
+	_MQ[c+c*_ld] = PetscRealPart( d[c] );
+	_XQ[c+c*_ld] = PetscRealPart( d[_l+c] );
+    }
+
+    void CompactQEP::projected( PetscInt m, std::vector< PetscScalar >& T ) const
+    {
+	PetscInt ldh = _ncv + 1, i, j;
+
+	T.resize( m * m );
+	for ( j = 0; j < m; ++j )
+	    {
+		for ( i = 0; i < m; ++i ) { T[i+j*m] = _H[i+j*ldh]; }
+	    }
+	if ( _used != Gyroscopic ) { return; }
+
+	// Omega H is skew-Hermitian up to rounding, which would split the pairs (l, -conj(l));
+	// the indefinite form of the symmetric case may grow the basis, whose Krylov relation is then kept as computed
+	for ( j = 0; j < m; ++j )
+	    {
+		for ( i = 0; i <= j; ++i )
+		    {
+			PetscScalar g = ( _omega[i] * _H[i+j*ldh] - PetscConj( _omega[j] * _H[j+i*ldh] ) ) / 2.0;
+			T[i+j*m] = _omega[i] * g;
+			T[j+i*m] = -_omega[j] * PetscConj( g );
+		    }
+	    }
+    }
+
+    void CompactQEP::ritz( PetscInt m, std::vector< PetscScalar >& eigr, std::vector< PetscScalar >& eigi,
+			   std::vector< PetscScalar >& Y, std::vector< PetscReal >& residuals ) const
+    {
+	PetscInt ldh = _ncv + 1, i, j, k, size;
+	PetscBLASInt bm = m, ione = 1, lwork = 8 * m, ldu = _ld, info;
+	PetscScalar one = 1.0, zero = 0.0, dummy;
+	std::vector< PetscScalar > A, VR( m * m ), wr( m ), wi( m, 0.0 ), work( lwork ), UY1( _ld * m ), UY2( _ld * m );
+	std::vector< PetscReal > rwork( 2 * m ), res( m ), norms( m, 0.0 );
+	std::vector< std::pair< PetscReal, PetscInt > > order;
+	PetscReal next = 0;
+
+	projected( m, A );
+
+#ifndef PETSC_USE_COMPLEX
+	LAPACKgeev_( "N", "V", &bm, &A[0], &bm, &wr[0], &wi[0], &dummy, &ione, &VR[0], &bm, &work[0], &lwork, &info );
+#else
+	LAPACKgeev_( "N", "V", &bm, &A[0], &bm, &wr[0], &dummy, &ione, &VR[0], &bm, &work[0], &lwork, &rwork[0], &info );
+#endif
+	if ( info ) { throw std::runtime_error( "CompactQEP: xGEEV failed" ); }
+
+	// ||S V y - theta V y|| / ||V y|| = |h_{m+1}^T y| ||v_{m+1}|| / ||V y||, the basis not being orthonormal for a form W
+	BLASgemm_( "N", "N", &ldu, &bm, &bm, &one, &_U1[0], &ldu, &VR[0], &bm, &zero, &UY1[0], &ldu );
+	BLASgemm_( "N", "N", &ldu, &bm, &bm, &one, &_U2[0], &ldu, &VR[0], &bm, &zero, &UY2[0], &ldu );
+	for ( i = 0; i < _ld; ++i )
+	    {
+		next += PetscRealPart( PetscConj( _U1[i+m*_ld] ) * _U1[i+m*_ld] + PetscConj( _U2[i+m*_ld] ) * _U2[i+m*_ld] );
+		for ( j = 0; j < m; ++j ) { norms[j] += PetscRealPart( PetscConj( UY1[i+j*_ld] ) * UY1[i+j*_ld] + PetscConj( UY2[i+j*_ld] ) * UY2[i+j*_ld] ); }
+	    }
+	next = std::sqrt( next );
+
+	// y = VR(:,i) + i VR(:,i+1) for a pair
+	for ( i = 0; i < m; ++i )
+	    {
+		PetscScalar re = 0, im = 0;
+		PetscInt first = ( PetscRealPart( wi[i] ) < 0 ) ? i - 1 : i;
+		PetscReal ny = norms[first];
+		for ( k = 0; k < m; ++k )
+		    {
+			re += _H[m+k*ldh] * VR[k+first*m];
+			if ( PetscRealPart( wi[i] ) != 0 ) { im += _H[m+k*ldh] * VR[k+(first+1)*m]; }
+		    }
+		if ( PetscRealPart( wi[i] ) != 0 ) { ny += norms[first+1]; }
+		res[i] = std::sqrt( PetscAbsScalar( re ) * PetscAbsScalar( re ) + PetscAbsScalar( im ) * PetscAbsScalar( im ) ) * next / std::sqrt( ny );
+		if ( PetscRealPart( wi[i] ) >= 0 )
+		    {
+			PetscReal a = PetscAbsScalar( wr[i] ), b = PetscAbsScalar( wi[i] );
+			order.push_back( std::make_pair( std::sqrt( a * a + b * b ), i ) );
+		    }
+	    }
+	std::stable_sort( order.begin(), order.end(), greater );
+
+	eigr.resize( m );
+	eigi.resize( m );
+	residuals.resize( m );
+	Y.resize( m * m );
+	for ( j = 0, k = 0; k < (PetscInt)order.size(); ++k )
+	    {
+		i = order[k].second;
+		for ( size = ( PetscRealPart( wi[i] ) > 0 ) ? 2 : 1; size > 0; --size, ++i, ++j )
+		    {
+			eigr[j] = wr[i];
+			eigi[j] = wi[i];
+			residuals[j] = res[i];
+			std::copy( VR.begin() + i * m, VR.begin() + ( i + 1 ) * m, Y.begin() + j * m );
+		    }
+	    }
+    }
+
+    PetscInt CompactQEP::restart( PetscInt m, PetscInt p, std::vector< PetscScalar >& Y )
+    {
+	PetscInt ldh = _ncv + 1, i, j, k, q;
+	PetscBLASInt bm = m, bp = p, bq, ldu = _ld, lwork = 3 * p, info;
+	PetscScalar one = 1.0, zero = 0.0;
+	PetscReal dmax = 0;
+	std::vector< PetscScalar > OY( m * p ), G( p * p ), YZ( m * p ), Yn( m * p ), T, HY( m * p ), Tn( p * p ), b( p, 0.0 ), W( _ld * p ), work( lwork );
+	std::vector< PetscReal > D( p ), omega( p ), rwork( 3 * p );
+
+	// Y Z |D|^-1/2 with Y^H Omega Y = Z D Z^H is Omega-orthonormal, Omega = I without a form
+	for ( j = 0; j < p; ++j )
+	    {
+		for ( i = 0; i < m; ++i ) { OY[i+j*m] = _omega[i] * Y[i+j*m]; }
+	    }
+	BLASgemm_( "C", "N", &bp, &bp, &bm, &one, &Y[0], &bm, &OY[0], &bm, &zero, &G[0], &bp );
+#ifndef PETSC_USE_COMPLEX
+	LAPACKsyev_( "V", "U", &bp, &G[0], &bp, &D[0], &work[0], &lwork, &info );
+#else
+	LAPACKsyev_( "V", "U", &bp, &G[0], &bp, &D[0], &work[0], &lwork, &rwork[0], &info );
+#endif
+	if ( info ) { throw std::runtime_error( "CompactQEP: xSYEV failed" ); }
+	BLASgemm_( "N", "N", &bm, &bp, &bp, &one, &Y[0], &bm, &G[0], &bp, &zero, &YZ[0], &bm );
+
+	// the W-neutral part of the wanted subspace is dropped
+	for ( j = 0; j < p; ++j ) { dmax = PetscMax( dmax, PetscAbsReal( D[j] ) ); }
+	for ( j = 0, q = 0; j < p; ++j )
+	    {
+		if ( PetscAbsReal( D[j] ) <= p * PETSC_MACHINE_EPSILON * dmax ) { continue; }
+		for ( i = 0; i < m; ++i ) { Yn[i+q*m] = YZ[i+j*m] / std::sqrt( PetscAbsReal( D[j] ) ); }
+		omega[q++] = D[j] < 0 ? -1.0 : 1.0;
+	    }
+	bq = q;
+
+	// S V Yn = V Yn T + v_{m+1} b^T, with T = Omega' Yn^H Omega H Yn and b^T = h_{m+1}^T Yn
+	projected( m, T );
+	for ( j = 0; j < m; ++j )
+	    {
+		for ( i = 0; i < m; ++i ) { T[i+j*m] *= _omega[i]; }
+	    }
+	BLASgemm_( "N", "N", &bm, &bq, &bm, &one, &T[0], &bm, &Yn[0], &bm, &zero, &HY[0], &bm );
+	BLASgemm_( "C", "N", &bq, &bq, &bm, &one, &Yn[0], &bm, &HY[0], &bm, &zero, &Tn[0], &bq );
+	for ( j = 0; j < q; ++j )
+	    {
+		for ( k = 0; k < m; ++k ) { b[j] += _H[m+k*ldh] * Yn[k+j*m]; }
+	    }
+	std::fill( _H.begin(), _H.end(), 0.0 );
+	for ( j = 0; j < q; ++j )
+	    {
+		for ( i = 0; i < q; ++i ) { _H[i+j*ldh] = omega[i] * Tn[i+j*q]; }
+		_H[q+j*ldh] = b[j];
+	    }
+
+	// U(:,1:q) = U(:,1:m) Yn, U(:,q+1) = U(:,m+1)
+	BLASgemm_( "N", "N", &ldu, &bq, &bm, &one, &_U1[0], &ldu, &Yn[0], &bm, &zero, &W[0], &ldu );
+	std::copy( W.begin(), W.begin() + _ld * q, _U1.begin() );
+	std::copy( _U1.begin() + m * _ld, _U1.begin() + ( m + 1 ) * _ld, _U1.begin() + q * _ld );
+	BLASgemm_( "N", "N", &ldu, &bq, &bm, &one, &_U2[0], &ldu, &Yn[0], &bm, &zero, &W[0], &ldu );
+	std::copy( W.begin(), W.begin() + _ld * q, _U2.begin() );
+	std::copy( _U2.begin() + m * _ld, _U2.begin() + ( m + 1 ) * _ld, _U2.begin() + q * _ld );
+	_omega[q] = _omega[m];
+	std::copy( omega.begin(), omega.begin() + q, _omega.begin() );
+
+	compress( q + 1 );
+	return q;
+    }
+
+    void CompactQEP::compress( PetscInt j )
+    {
+	PetscInt L = _l, r, i, c;
+	PetscBLASInt bL = L, b2j = 2 * j, bj = j, bn = _n, ld = PetscMax( _n, 1 ), ldu = _ld, mn = PetscMin( L, 2 * j ), ione = 1, lwork = 5 * ( L + 2 * j ), info;
+	PetscScalar one = 1.0, zero = 0.0, dummy;
+	std::vector< PetscScalar > W( L * 2 * j ), Z( L * mn ), work( lwork );
+	std::vector< PetscReal > s( mn ), rwork( 5 * mn );
+
+	for ( c = 0; c < j; ++c )
+	    {
+		for ( i = 0; i < L; ++i )
+		    {
+			W[i+c*L] = _U1[i+c*_ld];
+			W[i+(j+c)*L] = _U2[i+c*_ld];
+		    }
+	    }
+
+#ifndef PETSC_USE_COMPLEX
+	LAPACKgesvd_( "S", "N", &bL, &b2j, &W[0], &bL, &s[0], &Z[0], &bL, &dummy, &ione, &work[0], &lwork, &info );
+#else
+	LAPACKgesvd_( "S", "N", &bL, &b2j, &W[0], &bL, &s[0], &Z[0], &bL, &dummy, &ione, &work[0], &lwork, &rwork[0], &info );
+#endif
+	if ( info ) { throw std::runtime_error( "CompactQEP: xGESVD failed" ); }
+
+	// the numerical rank, every direction above rounding is kept so that the Krylov relation holds
+	for ( r = 0; r < mn && s[r] > L * PETSC_MACHINE_EPSILON * s[0]; ++r ) {}
+	if ( r == L ) { return; }
+
+	// Q = Q Z, U = Z^H U
+	PetscBLASInt br = r;
+	std::vector< PetscScalar > Q( _n * r ), U( r * j );
+	if ( _n > 0 )
+	    {
+		BLASgemm_( "N", "N", &bn, &br, &bL, &one, &_Q[0], &ld, &Z[0], &bL, &zero, &Q[0], &ld );
+		std::copy( Q.begin(), Q.end(), _Q.begin() );
+	    }
+	BLASgemm_( "C", "N", &br, &bj, &bL, &one, &Z[0], &bL, &_U1[0], &ldu, &zero, &U[0], &br );
+	for ( c = 0; c < j; ++c )
+	    {
+		for ( i = 0; i < _ld; ++i ) { _U1[i+c*_ld] = i < r ? U[i+c*r] : 0.0; }
+	    }
+	BLASgemm_( "C", "N", &br, &bj, &bL, &one, &Z[0], &bL, &_U2[0], &ldu, &zero, &U[0], &br );
+	for ( c = 0; c < j; ++c )
+	    {
+		for ( i = 0; i < _ld; ++i ) { _U2[i+c*_ld] = i < r ? U[i+c*r] : 0.0; }
+	    }
+
+	// and the projections of M and C (or K) to Z^H P Z
+	if ( _used != General )
+	    {
+		std::vector< PetscScalar > PZ( L * r ), P( r * r );
+		std::vector< PetscScalar >* projections[2] = { &_MQ, &_XQ };
+		for ( c = 0; c < 2; ++c )
+		    {
+			std::vector< PetscScalar >& X = *projections[c];
+			BLASgemm_( "N", "N", &bL, &br, &bL, &one, &X[0], &ldu, &Z[0], &bL, &zero, &PZ[0], &bL );
+			BLASgemm_( "C", "N", &br, &br, &bL, &one, &Z[0], &bL, &PZ[0], &bL, &zero, &P[0], &br );
+			std::fill( X.begin(), X.end(), 0.0 );
+			for ( i = 0; i < r * r; ++i ) { X[i%r+(i/r)*_ld] = P[i]; }
+		    }
+	    }
+	_l = r;
+    }
+
+    void CompactQEP::getEigenpair( PetscInt i, PetscScalar* kr, PetscScalar* ki, Vec xr /*= PETSC_NULL*/, Vec xi /*= PETSC_NULL*/ ) const
+    {
+	PetscInt re = i, im = -1, k;
+	PetscScalar sign = 1.0;
+	PetscScalar* p;
+
+	*kr = _eigr[i];
+	if ( ki ) { *ki = _eigi[i]; }
+
+	// a pair is stored as the real and the imaginary part of its first vector
+	if ( PetscRealPart( _eigi[i] ) > 0 ) { im = i + 1; }
+	else if ( PetscRealPart( _eigi[i] ) < 0 ) { re = i - 1; im = i; sign = -1.0; }
+
+	if ( xr )
+	    {
+		VecGetArray( xr, &p );
+		for ( k = 0; k < _n; ++k ) { p[k] = _X[k+re*_n]; }
+		VecRestoreArray( xr, &p );
+	    }
+	if ( xi )
+	    {
+		VecGetArray( xi, &p );
+		for ( k = 0; k < _n; ++k ) { p[k] = im < 0 ? 0.0 : sign * _X[k+im*_n]; }
+		VecRestoreArray( xi, &p );
+	    }
+    }
+
+    PetscReal CompactQEP::getRelativeError( PetscInt i ) const
+    {
+	PetscScalar kr, ki;
+	PetscReal error;
+	Vec xr, xi;
+
+	MatGetVecs( _K, &xr, PETSC_NULL );
+	VecDuplicate( xr, &xi );
+	getEigenpair( i, &kr, &ki, xr, xi );
+	error = relativeError( _M, _C, _K, kr, ki, xr, xi );
+	VecDestroy( xr );
+	VecDestroy( xi );
+	return error;
+    }
+
+    void CompactQEP::printOn(std::ostream&) const
+    {
+	const char* names[] = { "automatic", "general", "symmetric", "gyroscopic" };
+	PetscPrintf(_comm," Compact Q-Arnoldi (%s): %d iterations, %d converged eigenpairs\n",names[_used],_iterations,_nconv);
+	if ( _shifted ) { PetscPrintf(_comm," Shift-and-invert around %g%+gi, on P(sigma) of size n\n",PetscRealPart(_sigma),PetscImaginaryPart(_sigma)); }
+	PetscPrintf(_comm," Orthogonalisation: %.3f s\n",_orthogonalization);
+	PetscPrintf(_comm," Basis: at most %d vectors of size n, against %d of size 2n for the explicit linearization\n\n",_vectors,_ncv+1);
+    }
+}
@@ -0,0 +1,221 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_CompactQEP_h
+#define _slepc_cxx_CompactQEP_h
+
+#include <vector>
+#include <stdexcept>
+
+#include <petscksp.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Eigenpairs of largest magnitude of the quadratic eigenproblem
+     * (l^2 M + l C + K) x = 0, by Krylov-Schur on the companion
+     * linearization
+     *
+     *   S [x1; x2] = [x2; -M^-1 (K x1 + C x2)]
+     *
+     * which is only applied through products by K and C and solves with M
+     * (inner KSP, options prefix "compact_").
+     *
+     * Since the top block of S v is the bottom block of v, every basis
+     * vector lies in the span of the same n-vectors: the 2n x j basis is
+     * stored as V = [Q U1; Q U2] with Q orthonormal n x l, l <= j + 2, and
+     * U1, U2 small l x j factors, as in TOAR. A step orthogonalises one new
+     * n-vector against Q and runs the Arnoldi orthogonalisation on the
+     * coordinates; a restart keeps the Ritz vectors of the wanted values and
+     * compresses Q to the rank of [U1 U2]. The basis holds about half the
+     * entries of an explicit linearization with the same number of columns.
+     *
+     * S is also B^-1 A for the pencils
+     *
+     *   symmetric M, C, K:              A = [-K 0; 0 M],  B = [C M; M 0]
+     *   gyroscopic (C skew-symmetric):  A = [-K 0; 0 -M], B = [C M; -M 0]
+     *
+     * so that it is self-adjoint for the indefinite form W = B in the first
+     * case, and skew-adjoint for W = -A = [K 0; 0 M] in the second one. With
+     * such a structure, the basis is made W-orthogonal, V^H W V = diag(+-1),
+     * by a pseudo-Lanczos process whose form is evaluated on the coordinates
+     * through Q^H M Q and Q^H C Q (or Q^H K Q). The restarts keep V^H W V
+     * diagonal, and the projected matrix of the gyroscopic case is made
+     * exactly pseudo-skew-symmetric so that its Ritz values come in pairs
+     * (l, -conj(l)). The structure buys that pairing, not speed: the form
+     * costs two more products per new column of Q, and the coordinates are
+     * reorthogonalised in full as in the general mode, a three-term
+     * recurrence losing W-orthogonality after the first restart. The
+     * orthogonalisation is therefore slower than in the general mode;
+     * t-structured-qep measures both on the same problem.
+     *
+     * With a shift sigma, the same iteration runs on the reversed problem
+     *
+     *   t^2 P(sigma) + t (C + 2 sigma M) + M,  P(sigma) = sigma^2 M + sigma C + K
+     *
+     * whose largest t give the eigenvalues l = sigma + 1/t nearest to sigma.
+     * It is neither Hermitian nor gyroscopic in general, so only Automatic,
+     * which then checks the reversed matrices, or General can be shifted.
+     * This is shift-and-invert on the linearization, but the inner KSP only
+     * sees the n x n matrix P(sigma), so that a direct solver (for instance
+     * -compact_ksp_type preonly -compact_pc_type lu) factorises it once per
+     * solve instead of a 2n x 2n pencil.
+     */
+    class CompactQEP : public core_library::Printable
+    {
+    public:
+	enum Structure { Automatic, General, Symmetric, Gyroscopic };
+
+	CompactQEP( Structure structure = Automatic, MPI_Comm comm = PETSC_COMM_WORLD );
+	~CompactQEP();
+
+	// Automatic checks M, C and K with MatIsSymmetric, shell matrices are then General;
+	// with a shift, Automatic or General only, the reversed problem losing the structure of (M, C, K)
+	void setStructure( Structure structure )
+	{
+	    if ( _shifted && ( structure == Symmetric || structure == Gyroscopic ) )
+		{
+		    throw std::runtime_error( "CompactQEP: a shifted problem is not structured, use Automatic or General" );
+		}
+	    _structure = structure;
+	}
+	Structure requestedStructure() const { return _structure; }
+
+	// eigenvalues nearest to sigma from then on, the matrices must then be assembled
+	void setShift( PetscScalar sigma )
+	{
+	    if ( _structure == Symmetric || _structure == Gyroscopic )
+		{
+		    throw std::runtime_error( "CompactQEP: a shifted problem is not structured, use Automatic or General" );
+		}
+	    _sigma = sigma;
+	    _shifted = PETSC_TRUE;
+	}
+
+	// back to the eigenvalues of largest magnitude
+	void clearShift() { _shifted = PETSC_FALSE; }
+
+	PetscTruth shifted() const { return _shifted; }
+
+	// collective, the matrices must outlive getRelativeError(), ncv = PETSC_DECIDE takes max(2 nev, nev + 15)
+	void solve( Mat M, Mat C, Mat K, PetscInt nev = 1, PetscInt ncv = PETSC_DECIDE, PetscReal tol = 1e-8, PetscInt maxit = 100 );
+
+	PetscInt getConverged() const { return _nconv; }
+
+	// as QEPGetEigenpair, in decreasing magnitude; xr and xi may be PETSC_NULL
+	void getEigenpair( PetscInt i, PetscScalar* kr, PetscScalar* ki, Vec xr = PETSC_NULL, Vec xi = PETSC_NULL ) const;
+
+	// collective, ||(k^2 M + k C + K) x|| / ||k x|| as QEPComputeRelativeError
+	PetscReal getRelativeError( PetscInt i ) const;
+
+	// outer iterations, each one ending with a restart but the last
+	PetscInt iterations() const { return _iterations; }
+
+	// the one used by the last solve
+	Structure structure() const { return _used; }
+
+	// wall time of the orthogonalisations, against Q and on the coordinates, with the products of the form
+	PetscLogDouble orthogonalizationTime() const { return _orthogonalization; }
+
+	// largest number of n-vectors held by Q during the last solve
+	PetscInt basisVectors() const { return _vectors; }
+
+	KSP ksp() const { return _ksp; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	Structure detect( Mat M, Mat C, Mat K ) const;
+
+	// v_{j+1} from S v_j, PETSC_FALSE on an invariant subspace or a W-neutral direction
+	PetscTruth step( PetscInt j );
+
+	// the coordinates z of W [Q a1; Q a2]
+	void applyW( const PetscScalar* a1, const PetscScalar* a2, PetscScalar* z1, PetscScalar* z2 ) const;
+
+	// Q^H M q and Q^H C q (or Q^H K q) for the last column q of Q
+	void project();
+
+	// leading m x m block of H, made exactly pseudo-skew-symmetric in the gyroscopic case
+	void projected( PetscInt m, std::vector< PetscScalar >& T ) const;
+
+	// eigenvalues of the leading m x m block of H by decreasing magnitude, with their eigenvectors and residuals
+	void ritz( PetscInt m, std::vector< PetscScalar >& eigr, std::vector< PetscScalar >& eigi,
+		   std::vector< PetscScalar >& Y, std::vector< PetscReal >& residuals ) const;
+
+	// keeps the span of the p leading columns of Y, returns its W-nondegenerate dimension
+	PetscInt restart( PetscInt m, PetscInt p, std::vector< PetscScalar >& Y );
+
+	// Q to the numerical rank of [U1 U2] over the first j columns, unchanged when it is full
+	void compress( PetscInt j );
+
+	// the shifted matrices and the work vectors of the last solve, also when it threw
+	void release();
+
+    private:
+	CompactQEP( const CompactQEP& );
+	CompactQEP& operator=( const CompactQEP& );
+
+	MPI_Comm _comm;
+	Structure _structure;
+	Structure _used;
+	KSP _ksp;
+	PetscTruth _configured;
+
+	Mat _M;
+	Mat _C;
+	Mat _K;
+
+	// the problem iterated on, (M, C, K) or (P(sigma), C + 2 sigma M, M)
+	PetscScalar _sigma;
+	PetscTruth _shifted;
+	Mat _Ms;
+	Mat _Cs;
+	Mat _Ks;
+	Vec _x1;
+	Vec _x2;
+	Vec _y;
+	Vec _r;
+	PetscInt _n;
+	PetscInt _ncv;
+	PetscInt _ld;
+	PetscInt _l;
+
+	std::vector< PetscScalar > _Q;
+	std::vector< PetscScalar > _U1;
+	std::vector< PetscScalar > _U2;
+	std::vector< PetscScalar > _H;
+	std::vector< PetscReal > _omega;
+	std::vector< PetscScalar > _MQ;
+	std::vector< PetscScalar > _XQ;
+
+	std::vector< PetscScalar > _eigr;
+	std::vector< PetscScalar > _eigi;
+	std::vector< PetscScalar > _X;
+	PetscInt _nconv;
+	PetscInt _iterations;
+	PetscInt _vectors;
+	PetscLogDouble _orthogonalization;
+	PetscTruth _lost;
+    };
+}
+
+#endif // !_slepc_cxx_CompactQEP_h
@@ -0,0 +1,280 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+
+#include "ConditionNumber.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// deterministic, independent of the number of ranks, not orthogonal to any singular vector in practice
+	void startVector( Vec v )
+	{
+	    PetscInt first, last, i;
+	    PetscScalar* p;
+	    PetscReal norm;
+
+	    VecGetOwnershipRange( v, &first, &last );
+	    VecGetArray( v, &p );
+	    for ( i = first; i < last; ++i )
+		{
+		    unsigned int h = (unsigned int)( i + 1 ) * 2654435761U;
+		    p[i-first] = 1.0 + ( h >> 16 ) / 65536.0;
+		}
+	    VecRestoreArray( v, &p );
+	    VecNormalize( v, &norm );
+	}
+
+	// classical Gram-Schmidt against the basis, repeated once the norm drops below 1/sqrt(2) of its value
+	PetscReal orthogonalize( Vec w, const std::vector< Vec >& basis, std::vector< PetscScalar >& h )
+	{
+	    PetscReal before, after;
+	    PetscInt n = basis.size(), k, pass;
+
+	    VecNorm( w, NORM_2, &after );
+	    for ( pass = 0; pass < 2 && n > 0; ++pass )
+		{
+		    before = after;
+		    VecMDot( w, n, &basis[0], &h[0] );
+		    for ( k = 0; k < n; ++k ) { h[k] = -h[k]; }
+		    VecMAXPY( w, n, &h[0], &basis[0] );
+		    VecNorm( w, NORM_2, &after );
+		    if ( after > 0.7071 * before ) { break; }
+		}
+	    return after;
+	}
+
+	/*
+	 * The Golub-Kahan form of the k x k upper bidiagonal B is the 2k x 2k
+	 * tridiagonal with zero diagonal and off-diagonal e = (a1, b1, a2, b2, ..., ak),
+	 * its eigenvalues are +/- the singular values of B.
+	 */
+
+	// number of eigenvalues lower than x (Sturm count)
+	PetscInt countBelow( const std::vector< PetscReal >& e, PetscReal x, PetscReal pivmin )
+	{
+	    PetscInt n = e.size() + 1, count = 0, i;
+	    PetscReal d = -x;
+
+	    for ( i = 0; i < n; ++i )
+		{
+		    if ( i > 0 ) { d = -x - e[i-1] * e[i-1] / d; }
+		    if ( PetscAbsReal( d ) < pivmin ) { d = -pivmin; }
+		    if ( d < 0 ) { ++count; }
+		}
+	    return count;
+	}
+
+	// eigenvalue number index in increasing order, within [lo, hi]
+	PetscReal bisect( const std::vector< PetscReal >& e, PetscInt index, PetscReal lo, PetscReal hi, PetscReal pivmin )
+	{
+	    for ( PetscInt it = 0; it < 200 && hi - lo > 2 * PETSC_MACHINE_EPSILON * PetscMax( PetscAbsReal( lo ), PetscAbsReal( hi ) ) + pivmin; ++it )
+		{
+		    PetscReal mid = 0.5 * ( lo + hi );
+		    if ( countBelow( e, mid, pivmin ) > index ) { hi = mid; }
+		    else { lo = mid; }
+		}
+	    return 0.5 * ( lo + hi );
+	}
+
+	// two steps of inverse iteration, Gaussian elimination with partial pivoting as in LAPACK gtsv
+	void eigenvector( const std::vector< PetscReal >& e, PetscReal s, PetscReal pivmin, std::vector< PetscReal >& z )
+	{
+	    PetscInt n = e.size() + 1, i, pass;
+	    z.assign( n, 1.0 );
+
+	    for ( pass = 0; pass < 2; ++pass )
+		{
+		    std::vector< PetscReal > d( n, -s ), du( e ), dl( e );
+		    PetscReal fact, temp, norm = 0;
+
+		    for ( i = 0; i < n - 1; ++i )
+			{
+			    if ( PetscAbsReal( d[i] ) >= PetscAbsReal( dl[i] ) )
+				{
+				    if ( PetscAbsReal( d[i] ) < pivmin ) { d[i] = pivmin; }
+				    fact = dl[i] / d[i];
+				    d[i+1] -= fact * du[i];
+				    z[i+1] -= fact * z[i];
+				    dl[i] = 0;
+				}
+			    else
+				{
+				    fact = d[i] / dl[i];
+				    d[i] = dl[i];
+				    temp = d[i+1];
+				    d[i+1] = du[i] - fact * temp;
+				    if ( i < n - 2 )
+					{
+					    dl[i] = du[i+1];
+					    du[i+1] = -fact * dl[i];
+					}
+				    du[i] = temp;
+				    temp = z[i];
+				    z[i] = z[i+1];
+				    z[i+1] = temp - fact * z[i+1];
+				}
+			}
+		    if ( PetscAbsReal( d[n-1] ) < pivmin ) { d[n-1] = pivmin; }
+
+		    z[n-1] /= d[n-1];
+		    if ( n > 1 ) { z[n-2] = ( z[n-2] - du[n-2] * z[n-1] ) / d[n-2]; }
+		    for ( i = n - 3; i >= 0; --i ) { z[i] = ( z[i] - du[i] * z[i+1] - dl[i] * z[i+2] ) / d[i]; }
+
+		    for ( i = 0; i < n; ++i ) { norm += z[i] * z[i]; }
+		    norm = std::sqrt( norm );
+		    for ( i = 0; i < n; ++i ) { z[i] /= norm; }
+		}
+	}
+
+	// ||A^T u - sigma v|| = beta |x_k|, x being the odd entries of the Golub-Kahan eigenvector
+	PetscReal residual( const std::vector< PetscReal >& e, PetscReal sigma, PetscReal beta, PetscReal pivmin )
+	{
+	    std::vector< PetscReal > z;
+	    PetscReal norm = 0;
+	    PetscInt n = e.size() + 1, i;
+
+	    eigenvector( e, sigma, pivmin, z );
+	    for ( i = 1; i < n; i += 2 ) { norm += z[i] * z[i]; }
+	    return norm > 0 ? beta * PetscAbsReal( z[n-1] ) / std::sqrt( norm ) : beta;
+	}
+    }
+
+    ConditionNumber::ConditionNumber( PetscReal tol /*= 1e-2*/, PetscInt maxSteps /*= 200*/ )
+	: _tol(tol), _maxSteps(maxSteps),
+	  _largest(0), _smallest(0), _largestResidual(0), _smallestResidual(0), _steps(0), _converged(PETSC_FALSE)
+    {}
+
+    PetscReal ConditionNumber::operator()( Mat A )
+    {
+	PetscInt M, N, k;
+	PetscTruth transposed;
+	PetscReal alpha, beta = 0;
+	Vec v, u, w;
+
+	// v lives on the side of the smaller dimension
+	MatGetSize( A, &M, &N );
+	transposed = M < N ? PETSC_TRUE : PETSC_FALSE;
+	if ( transposed ) { MatGetVecs( A, &w, &v ); }
+	else { MatGetVecs( A, &v, &w ); }
+
+	std::vector< Vec > V( 1, v ), U;
+	std::vector< PetscScalar > h( _maxSteps + 1 );
+
+	_alpha.clear();
+	_beta.clear();
+	_steps = 0;
+	_converged = PETSC_FALSE;
+	_largest = _smallest = 0;
+
+	startVector( v );
+
+	for ( k = 0; k < _maxSteps && k < PetscMin( M, N ); ++k )
+	    {
+		// u_k = A v_k - beta_k-1 u_k-1
+		VecDuplicate( w, &u );
+		if ( transposed ) { MatMultTranspose( A, V[k], u ); }
+		else { MatMult( A, V[k], u ); }
+		if ( k > 0 ) { VecAXPY( u, -beta, U[k-1] ); }
+		alpha = orthogonalize( u, U, h );
+		U.push_back( u );
+		_alpha.push_back( alpha );
+		++_steps;
+
+		// A v_k in the span of the previous u: A V_k is rank deficient
+		if ( alpha <= PETSC_MACHINE_EPSILON * _largest )
+		    {
+			_alpha.back() = 0;
+			extremes( 0 );
+			_converged = PETSC_TRUE;
+			break;
+		    }
+		VecScale( u, 1.0 / alpha );
+
+		// v_k+1 = A^T u_k - alpha_k v_k
+		VecDuplicate( V[0], &v );
+		if ( transposed ) { MatMult( A, u, v ); }
+		else { MatMultTranspose( A, u, v ); }
+		VecAXPY( v, -alpha, V[k] );
+		beta = orthogonalize( v, V, h );
+		V.push_back( v );
+
+		extremes( beta );
+
+		// invariant subspace, the Ritz values are exact
+		if ( beta <= PETSC_MACHINE_EPSILON * _largest )
+		    {
+			_converged = PETSC_TRUE;
+			break;
+		    }
+		if ( _largestResidual <= _tol * _largest && _smallestResidual <= _tol * _smallest )
+		    {
+			_converged = PETSC_TRUE;
+			break;
+		    }
+
+		_beta.push_back( beta );
+		VecScale( v, 1.0 / beta );
+	    }
+
+	for ( k = 0; k < (PetscInt)V.size(); ++k ) { VecDestroy( V[k] ); }
+	for ( k = 0; k < (PetscInt)U.size(); ++k ) { VecDestroy( U[k] ); }
+	VecDestroy( w );
+
+	return _smallest > 0 ? _largest / _smallest : PETSC_MAX;
+    }
+
+    void ConditionNumber::extremes( PetscReal beta )
+    {
+	PetscInt k = _alpha.size(), i;
+	std::vector< PetscReal > e( 2 * k - 1 );
+	PetscReal bound = 0, pivmin;
+
+	for ( i = 0; i < k; ++i )
+	    {
+		e[2*i] = _alpha[i];
+		if ( i < k - 1 ) { e[2*i+1] = _beta[i]; }
+	    }
+
+	// Gershgorin
+	for ( i = 0; i < 2 * k - 1; ++i )
+	    {
+		bound = PetscMax( bound, PetscAbsReal( e[i] ) + ( i > 0 ? PetscAbsReal( e[i-1] ) : 0 ) );
+	    }
+	bound = PetscMax( bound, PetscAbsReal( e[2*k-2] ) );
+	pivmin = PETSC_MACHINE_EPSILON * PETSC_MACHINE_EPSILON * PetscMax( bound, 1.0 );
+
+	// the k largest eigenvalues of the Golub-Kahan form are the singular values
+	_largest = bisect( e, 2 * k - 1, 0, bound * ( 1 + PETSC_MACHINE_EPSILON ), pivmin );
+	_smallest = bisect( e, k, 0, _largest * ( 1 + PETSC_MACHINE_EPSILON ) + pivmin, pivmin );
+
+	_largestResidual = residual( e, _largest, beta, pivmin );
+	_smallestResidual = residual( e, _smallest, beta, pivmin );
+    }
+
+    void ConditionNumber::printOn(std::ostream&) const
+    {
+	PetscPrintf(PETSC_COMM_WORLD," Condition number: %g (%s after %d bidiagonalization steps)\n",
+		    _smallest > 0 ? _largest / _smallest : PETSC_MAX,_converged ? "converged" : "not converged",_steps);
+	PetscPrintf(PETSC_COMM_WORLD," sigma_max=%g (residual %g), sigma_min=%g (residual %g)\n\n",
+		    _largest,_largestResidual,_smallest,_smallestResidual);
+    }
+}
@@ -0,0 +1,96 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_ConditionNumber_h
+#define _slepc_cxx_ConditionNumber_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * 2-norm condition number sigma_max / sigma_min of a matrix from a single
+     * Golub-Kahan-Lanczos bidiagonalization A V_k = U_k B_k.
+     *
+     * Both ends of the spectrum are read from the same bidiagonal B_k, so the
+     * products spent for the largest singular value also serve the smallest
+     * one. The singular values of B_k are those of A V_k: the largest grows
+     * and the smallest decreases towards their limits. Both bases are
+     * reorthogonalised (classical Gram-Schmidt, repeated when cancellation
+     * occurs), which the smallest singular value needs.
+     *
+     * The extremal singular values of B_k are found by bisection on its
+     * Golub-Kahan tridiagonal form, to relative accuracy, and their residual
+     * ||A^T u - sigma v|| = beta_k |x_k| by inverse iteration. The run stops
+     * when both residuals are below tol * sigma: the tolerance trades accuracy
+     * of the estimate for matrix-vector products, 1e-2 already gives the
+     * order of magnitude in a few dozen steps on most operators.
+     *
+     * A wide matrix is handled through its transpose, so that sigma_min is
+     * the smallest of the min(M,N) singular values.
+     */
+    class ConditionNumber : public core_library::Printable
+    {
+    public:
+	ConditionNumber( PetscReal tol = 1e-2, PetscInt maxSteps = 200 );
+
+	// collective, sigma_max / sigma_min, PETSC_MAX when sigma_min is zero
+	PetscReal operator()( Mat A );
+
+	void setTolerance( PetscReal tol ) { _tol = tol; }
+	void setMaxSteps( PetscInt maxSteps ) { _maxSteps = maxSteps; }
+
+	PetscReal largest() const { return _largest; }
+	PetscReal smallest() const { return _smallest; }
+	PetscInt steps() const { return _steps; }
+	PetscTruth converged() const { return _converged; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	// extremal singular values of the current B_k and their residual norms
+	void extremes( PetscReal beta );
+
+    private:
+	PetscReal _tol;
+	PetscInt _maxSteps;
+
+	std::vector< PetscReal > _alpha;
+	std::vector< PetscReal > _beta;
+
+	PetscReal _largest;
+	PetscReal _smallest;
+	PetscReal _largestResidual;
+	PetscReal _smallestResidual;
+	PetscInt _steps;
+	PetscTruth _converged;
+    };
+
+    // collective, one-shot estimate
+    inline PetscReal conditionNumber( Mat A, PetscReal tol = 1e-2 )
+    {
+	return ConditionNumber( tol )( A );
+    }
+}
+
+#endif // !_slepc_cxx_ConditionNumber_h
@@ -0,0 +1,286 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include <petscblaslapack.h>
+
+#include "DenseEigensolver.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// the key of a unit, a lone eigenvalue or a conjugate pair, smaller first
+	class Before
+	{
+	public:
+	    Before( const std::vector< PetscReal >& key ) : _key(key) {}
+
+	    bool operator()( PetscInt a, PetscInt b ) const { return _key[a] < _key[b]; }
+
+	private:
+	    const std::vector< PetscReal >& _key;
+	};
+
+	PetscReal key( EPSWhich which, PetscReal re, PetscReal im, PetscReal tr, PetscReal ti )
+	{
+	    switch ( which )
+		{
+		case EPS_SMALLEST_MAGNITUDE: return std::sqrt( re * re + im * im );
+		case EPS_LARGEST_REAL: return -re;
+		case EPS_SMALLEST_REAL: return re;
+		case EPS_LARGEST_IMAGINARY: return -PetscAbsReal( im );
+		case EPS_SMALLEST_IMAGINARY: return PetscAbsReal( im );
+		case EPS_TARGET_MAGNITUDE: return std::sqrt( ( re - tr ) * ( re - tr ) + ( im - ti ) * ( im - ti ) );
+		case EPS_TARGET_REAL: return PetscAbsReal( re - tr );
+		case EPS_TARGET_IMAGINARY: return PetscAbsReal( im - ti );
+		default: return -std::sqrt( re * re + im * im );
+		}
+	}
+    }
+
+    DenseEigensolver::DenseEigensolver( MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _A(PETSC_NULL), _N(0), _hermitian(PETSC_TRUE), _gather(0), _lapack(0)
+    {}
+
+    void DenseEigensolver::solve( Mat A, PetscTruth hermitian /*= PETSC_TRUE*/, EPSWhich which /*= EPS_LARGEST_MAGNITUDE*/, PetscScalar target /*= 0.0*/ )
+    {
+	PetscMPIInt rank;
+	PetscBLASInt info = 0;
+	PetscLogDouble t0, t1, t2;
+	std::vector< PetscScalar > D;
+
+	MatGetSize( A, &_N, PETSC_NULL );
+	_A = A;
+	_hermitian = hermitian;
+	MPI_Comm_rank( _comm, &rank );
+
+	PetscGetTime( &t0 );
+	gather( D );
+	PetscGetTime( &t1 );
+
+	_kr.assign( _N, 0.0 );
+	_ki.assign( _N, 0.0 );
+	_X.assign( _N * _N, 0.0 );
+	if ( !rank )
+	    {
+		PetscBLASInt n = _N, one = 1, lwork = 34 * _N, i;
+		std::vector< PetscScalar > work( lwork );
+		std::vector< PetscReal > rwork( 3 * _N ), w( _N );
+		PetscScalar dummy;
+
+		if ( hermitian )
+		    {
+#ifndef PETSC_USE_COMPLEX
+			LAPACKsyev_( "V", "U", &n, &D[0], &n, &w[0], &work[0], &lwork, &info );
+#else
+			LAPACKsyev_( "V", "U", &n, &D[0], &n, &w[0], &work[0], &lwork, &rwork[0], &info );
+#endif
+			for ( i = 0; i < n; ++i ) { _kr[i] = w[i]; }
+			_X.swap( D );
+		    }
+		else
+		    {
+#ifndef PETSC_USE_COMPLEX
+			LAPACKgeev_( "N", "V", &n, &D[0], &n, &_kr[0], &_ki[0], &dummy, &one, &_X[0], &n, &work[0], &lwork, &info );
+#else
+			LAPACKgeev_( "N", "V", &n, &D[0], &n, &_kr[0], &dummy, &one, &_X[0], &n, &work[0], &lwork, &rwork[0], &info );
+#endif
+		    }
+	    }
+	MPI_Bcast( &info, 1, MPI_INT, 0, _comm );
+	if ( info ) { throw std::runtime_error( hermitian ? "DenseEigensolver: xSYEV failed" : "DenseEigensolver: xGEEV failed" ); }
+	MPI_Bcast( &_kr[0], _N, MPIU_SCALAR, 0, _comm );
+	MPI_Bcast( &_ki[0], _N, MPIU_SCALAR, 0, _comm );
+	MPI_Bcast( &_X[0], _N * _N, MPIU_SCALAR, 0, _comm );
+	PetscGetTime( &t2 );
+
+	_gather = t1 - t0;
+	_lapack = t2 - t1;
+	sort( which, target );
+    }
+
+    PetscTruth DenseEigensolver::suited( Mat A, PetscInt maxSize )
+    {
+	PetscInt M, N;
+	PetscTruth shell;
+
+	MatGetSize( A, &M, &N );
+	PetscTypeCompare( (PetscObject)A, MATSHELL, &shell );
+	return M == N && N <= maxSize && !shell ? PETSC_TRUE : PETSC_FALSE;
+    }
+
+    void DenseEigensolver::getEigenpair( PetscInt i, PetscScalar* kr, PetscScalar* ki, Vec xr /*= PETSC_NULL*/, Vec xi /*= PETSC_NULL*/ ) const
+    {
+	PetscInt k = _order[i], first, last, j;
+	PetscScalar *pr, *pi;
+
+	*kr = _kr[k];
+	*ki = _ki[k];
+	if ( !xr && !xi ) { return; }
+
+	// a real pair is stored as the columns re, im of its first eigenvalue
+	PetscInt re = k, im = -1;
+	PetscReal sign = 1.0;
+#ifndef PETSC_USE_COMPLEX
+	if ( _ki[k] > 0 ) { im = k + 1; }
+	else if ( _ki[k] < 0 ) { re = k - 1; im = k; sign = -1.0; }
+#endif
+
+	if ( xr )
+	    {
+		VecGetOwnershipRange( xr, &first, &last );
+		VecGetArray( xr, &pr );
+		for ( j = first; j < last; ++j ) { pr[j-first] = _X[j+re*_N]; }
+		VecRestoreArray( xr, &pr );
+	    }
+	if ( xi )
+	    {
+		VecGetOwnershipRange( xi, &first, &last );
+		VecGetArray( xi, &pi );
+		for ( j = first; j < last; ++j ) { pi[j-first] = im < 0 ? 0.0 : sign * _X[j+im*_N]; }
+		VecRestoreArray( xi, &pi );
+	    }
+    }
+
+    PetscReal DenseEigensolver::getRelativeError( PetscInt i ) const
+    {
+	PetscScalar kr, ki;
+	PetscReal nr, ni, nxr, nxi = 0, norm, error;
+	Vec xr, xi, yr, yi;
+
+	MatGetVecs( _A, &xr, &yr );
+	VecDuplicate( xr, &xi );
+	VecDuplicate( yr, &yi );
+	getEigenpair( i, &kr, &ki, xr, xi );
+
+	// (A - k)(xr + i xi) in real arithmetic, the imaginary part only for a real pair
+	MatMult( _A, xr, yr );
+	VecAXPY( yr, -kr, xr );
+	VecNorm( xr, NORM_2, &nxr );
+	if ( ki != 0.0 )
+	    {
+		VecAXPY( yr, ki, xi );
+		MatMult( _A, xi, yi );
+		VecAXPY( yi, -kr, xi );
+		VecAXPY( yi, -ki, xr );
+		VecNorm( yi, NORM_2, &ni );
+		VecNorm( xi, NORM_2, &nxi );
+	    }
+	else { ni = 0; }
+	VecNorm( yr, NORM_2, &nr );
+
+	norm = std::sqrt( nxr * nxr + nxi * nxi );
+	error = std::sqrt( nr * nr + ni * ni );
+	if ( PetscAbsScalar( kr ) > 0 || PetscAbsScalar( ki ) > 0 )
+	    {
+		norm *= std::sqrt( PetscAbsScalar( kr ) * PetscAbsScalar( kr ) + PetscAbsScalar( ki ) * PetscAbsScalar( ki ) );
+	    }
+
+	VecDestroy( xr );
+	VecDestroy( xi );
+	VecDestroy( yr );
+	VecDestroy( yi );
+	return error / norm;
+    }
+
+    void DenseEigensolver::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Dense LAPACK eigensolver: %d rows, %s, gather %.3g s, solve %.3g s\n\n",
+		    _N,_hermitian ? "xSYEV" : "xGEEV",_gather,_lapack);
+    }
+
+    void DenseEigensolver::gather( std::vector< PetscScalar >& A ) const
+    {
+	PetscMPIInt rank, size, p;
+	PetscInt first, last, row, j, ncols, N = _N;
+	const PetscInt* cols;
+	const PetscScalar* vals;
+
+	MPI_Comm_rank( _comm, &rank );
+	MPI_Comm_size( _comm, &size );
+	MatGetOwnershipRange( _A, &first, &last );
+
+	// the local rows, row-major
+	std::vector< PetscScalar > local( ( last - first ) * N + 1, 0.0 ), rows;
+	for ( row = first; row < last; ++row )
+	    {
+		MatGetRow( _A, row, &ncols, &cols, &vals );
+		for ( j = 0; j < ncols; ++j ) { local[(row-first)*N+cols[j]] = vals[j]; }
+		MatRestoreRow( _A, row, &ncols, &cols, &vals );
+	    }
+
+	PetscMPIInt count = ( last - first ) * N;
+	std::vector< PetscMPIInt > counts( size ), displs( size, 0 );
+	MPI_Gather( &count, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, _comm );
+	for ( p = 1; p < size; ++p ) { displs[p] = displs[p-1] + counts[p-1]; }
+
+	if ( !rank ) { rows.resize( N * N + 1 ); }
+	MPI_Gatherv( &local[0], count, MPIU_SCALAR, rank ? PETSC_NULL : &rows[0], &counts[0], &displs[0], MPIU_SCALAR, 0, _comm );
+
+	A.clear();
+	if ( rank ) { return; }
+
+	// column-major for LAPACK
+	A.resize( N * N );
+	for ( row = 0; row < N; ++row )
+	    {
+		for ( j = 0; j < N; ++j ) { A[row+j*N] = rows[row*N+j]; }
+	    }
+    }
+
+    void DenseEigensolver::sort( EPSWhich which, PetscScalar target )
+    {
+	PetscInt i;
+	PetscReal re, im;
+	std::vector< PetscInt > units;
+	std::vector< PetscReal > keys( _N );
+
+	for ( i = 0; i < _N; ++i )
+	    {
+#ifdef PETSC_USE_COMPLEX
+		re = PetscRealPart( _kr[i] );
+		im = PetscImaginaryPart( _kr[i] );
+#else
+		re = _kr[i];
+		im = _ki[i];
+#endif
+		keys[i] = key( which, re, im, PetscRealPart( target ), PetscImaginaryPart( target ) );
+		units.push_back( i );
+#ifndef PETSC_USE_COMPLEX
+		// the conjugate follows, keyed as the eigenvalue with positive imaginary part
+		if ( im > 0 && i + 1 < _N ) { ++i; }
+#endif
+	    }
+
+	std::stable_sort( units.begin(), units.end(), Before( keys ) );
+
+	_order.clear();
+	for ( i = 0; i < (PetscInt)units.size(); ++i )
+	    {
+		_order.push_back( units[i] );
+#ifndef PETSC_USE_COMPLEX
+		if ( _ki[units[i]] > 0 ) { _order.push_back( units[i] + 1 ); }
+#endif
+	    }
+    }
+}
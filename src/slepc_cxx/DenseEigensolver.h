@@ -0,0 +1,93 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_DenseEigensolver_h
+#define _slepc_cxx_DenseEigensolver_h
+
+#include <vector>
+
+#include <slepceps.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * All the eigenpairs of a small assembled matrix by LAPACK: the rows are
+     * gathered on rank 0 as one dense N x N array, xSYEV (xHEEV) or xGEEV
+     * runs there and the eigenvalues and eigenvectors are broadcast. Below a
+     * few hundred rows this costs less than the restarts, the
+     * orthogonalisations and the reductions of a Krylov method; the
+     * crossover is measured by t-dense-fallback.
+     *
+     * The eigenpairs are ordered as SLEPc would for an EPSWhich, a conjugate
+     * pair staying together with the positive imaginary part first.
+     */
+    class DenseEigensolver : public core_library::Printable
+    {
+    public:
+	DenseEigensolver( MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// collective, A must outlive getRelativeError()
+	void solve( Mat A, PetscTruth hermitian = PETSC_TRUE, EPSWhich which = EPS_LARGEST_MAGNITUDE, PetscScalar target = 0.0 );
+
+	// square, assembled and with at most maxSize rows
+	static PetscTruth suited( Mat A, PetscInt maxSize );
+
+	// all N of them
+	PetscInt getConverged() const { return _N; }
+
+	// as EPSGetEigenpair; xr and xi may be PETSC_NULL
+	void getEigenpair( PetscInt i, PetscScalar* kr, PetscScalar* ki, Vec xr = PETSC_NULL, Vec xi = PETSC_NULL ) const;
+
+	// collective, ||Ax-kx|| / ||kx|| as EPSComputeRelativeError
+	PetscReal getRelativeError( PetscInt i ) const;
+
+	// wall time of the gather, of LAPACK and of the broadcast
+	PetscLogDouble gatherTime() const { return _gather; }
+	PetscLogDouble lapackTime() const { return _lapack; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	DenseEigensolver( const DenseEigensolver& );
+	DenseEigensolver& operator=( const DenseEigensolver& );
+
+	// the whole A, column-major, on rank 0 only
+	void gather( std::vector< PetscScalar >& A ) const;
+
+	// the eigenvalues in the order of which, pairs kept together
+	void sort( EPSWhich which, PetscScalar target );
+
+    private:
+	MPI_Comm _comm;
+	Mat _A;
+	PetscInt _N;
+	PetscTruth _hermitian;
+
+	std::vector< PetscScalar > _kr;
+	std::vector< PetscScalar > _ki;
+	std::vector< PetscScalar > _X;
+	std::vector< PetscInt > _order;
+	PetscLogDouble _gather;
+	PetscLogDouble _lapack;
+    };
+}
+
+#endif // !_slepc_cxx_DenseEigensolver_h
@@ -20,6 +20,10 @@
 #ifndef _slepc_cxx_EPSolver_h
 #define _slepc_cxx_EPSolver_h
 
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
 #include <slepceps.h>
 
 #include <core_library/Printable.h>
@@ -28,61 +32,253 @@
 #include <petsc_cxx/Matrix.h>
 #include <petsc_cxx/Vector.h>
 
+#include "EigenvalueComparison.h"
+#include "ExplicitTranspose.h"
+#include "SlicedEllpack.h"
+#include "Reordering.h"
+#include "SpectralTransform.h"
+#include "InexactShiftInvert.h"
+#include "DenseEigensolver.h"
+
 namespace slepc_cxx
 {
-    template < typename Atom >
+    /*
+     * With a comparator other than NoComparison, SLEPc orders the eigenvalues
+     * through a typed callback that inlines it, and getEigenpair(i) returns
+     * the i-th of that order. The solver keeps a pointer to the comparator,
+     * so an EPSolver cannot be copied.
+     *
+     * After setDense(), an assembled operator of at most that many rows is
+     * solved by LAPACK on one rank instead, see DenseEigensolver; the
+     * eigenpairs come back through the same interface, nev of them in the
+     * order of EPSGetWhichEigenpairs. It is off by default: run
+     * t-dense-fallback to find the size up to which it pays on a machine.
+     * Spectral transformations, inexact solves, two-sided runs and solvers
+     * given a deflation or an initial space always go to SLEPc. Those spaces
+     * must be set through setDeflationSpace() and setInitialSpace(), which
+     * record them, rather than on the EPS object.
+     *
+     * With setSliced(), the products run on a SELL-C-sigma copy of the
+     * operator, see SlicedEllpack.
+     *
+     * With setReordering(), SLEPc solves P A P^T, see Reordering, and the
+     * eigenvectors are permuted back: getEigenpair() returns them in the
+     * ordering of A. The permutation is kept across solves of the same A.
+     */
+    template < typename Atom, typename Compare = NoComparison >
     class EPSolver : public core_library::UF< const petsc_cxx::Matrix< Atom >&, void >, public core_library::Printable
     {
     public:
 	EPSolver( EPSType type = EPSARNOLDI, MPI_Comm comm = PETSC_COMM_WORLD )
+	    : _xr(PETSC_NULL), _xi(PETSC_NULL), _st(NULL), _inexactAttached(PETSC_FALSE), _twoSided(PETSC_FALSE), _explicitTranspose(PETSC_FALSE),
+	      _denseSize(0), _dense(PETSC_FALSE), _denseSolver(comm), _sliced(PETSC_FALSE), _reordered(PETSC_FALSE),
+	      _deflation(0), _initial(0), _initialLeft(0)
 	{
 	    EPSCreate( comm, &_solver );
 	    EPSSetProblemType(_solver, EPS_HEP);
 	    EPSSetFromOptions(_solver);
 	    EPSSetType(_solver, type);
+	    attachComparison( _compare );
+	}
+
+	~EPSolver()
+	{
+	    destroyVecs();
+	    EPSDestroy( _solver );
 	}
 
-	~EPSolver() { EPSDestroy( _solver ); }
+	virtual void operator()( const petsc_cxx::Matrix< Atom >& A ) { solve( A ); }
 
-	virtual void operator()( const petsc_cxx::Matrix< Atom >& A )
+	void solve( Mat A )
 	{
+	    destroyVecs();
 	    MatGetVecs(A,PETSC_NULL,&_xr);
 	    MatGetVecs(A,PETSC_NULL,&_xi);
-	    EPSSetOperators(_solver, A, PETSC_NULL);
+	    _dense = _denseSize > 0 && !_st && !_twoSided && !_inexact.enabled() && !userSpaces() ? DenseEigensolver::suited( A, _denseSize ) : PETSC_FALSE;
+	    if ( _dense )
+		{
+		    solveDense( A );
+		    return;
+		}
+	    _reordered = _reordering.method() != Reordering::None ? PETSC_TRUE : PETSC_FALSE;
+	    if ( _reordered && userSpaces() )
+		{
+		    throw std::runtime_error( "EPSolver: deflation and initial spaces are in the ordering of A, they cannot be used with setReordering()" );
+		}
+	    Mat op = _reordered ? _reordering( A ) : A;
+	    if ( _twoSided ) { EPSSetOperators(_solver, _explicitTranspose ? _transpose( op ) : op, PETSC_NULL); }
+	    else { EPSSetOperators(_solver, _sliced ? _sell( op ) : op, PETSC_NULL); }
+	    if ( _st ) { _st->setUp( op ); }
+	    if ( _inexact.enabled() ) { _inexact.start( _solver, ksp() ); }
 	    EPSSolve(_solver);
+	    _inexact.finish();
+	    sortConverged();
+	}
+
+	// the solver keeps using this instance
+	void setComparison( const Compare& compare ) { _compare = compare; }
+	const Compare& comparison() const { return _compare; }
+
+	PetscInt getConverged() const { return _order.size(); }
+
+	void getEigenpair( PetscInt i, PetscScalar* kr, PetscScalar* ki, Vec xr = PETSC_NULL, Vec xi = PETSC_NULL ) const
+	{
+	    if ( _dense ) { _denseSolver.getEigenpair( _order[i], kr, ki, xr, xi ); }
+	    else if ( _reordered )
+		{
+		    EPSGetEigenpair( _solver, _order[i], kr, ki, xr ? _reordering.permuted(0) : PETSC_NULL, xi ? _reordering.permuted(1) : PETSC_NULL );
+		    if ( xr ) { _reordering.toOriginal( _reordering.permuted(0), xr ); }
+		    if ( xi ) { _reordering.toOriginal( _reordering.permuted(1), xi ); }
+		}
+	    else { EPSGetEigenpair( _solver, _order[i], kr, ki, xr, xi ); }
+	}
+
+	PetscReal getRelativeError( PetscInt i ) const
+	{
+	    PetscReal error;
+	    if ( _dense ) { return _denseSolver.getRelativeError( _order[i] ); }
+	    EPSComputeRelativeError( _solver, _order[i], &error );
+	    return error;
+	}
+
+	// two-sided only
+	void getEigenvectorLeft( PetscInt i, Vec yr, Vec yi = PETSC_NULL ) const
+	{
+	    if ( _reordered )
+		{
+		    EPSGetEigenvectorLeft( _solver, _order[i], _reordering.permuted(0), yi ? _reordering.permuted(1) : PETSC_NULL );
+		    _reordering.toOriginal( _reordering.permuted(0), yr );
+		    if ( yi ) { _reordering.toOriginal( _reordering.permuted(1), yi ); }
+		}
+	    else { EPSGetEigenvectorLeft( _solver, _order[i], yr, yi ); }
+	}
+
+	PetscReal getRelativeErrorLeft( PetscInt i ) const
+	{
+	    PetscReal error;
+	    EPSComputeRelativeErrorLeft( _solver, _order[i], &error );
+	    return error;
+	}
+
+	// the transformation must outlive the solver, it is not owned
+	void setSpectralTransform( SpectralTransformBase& st )
+	{
+	    _st = &st;
+	    _st->attach( _solver );
+	}
+
+	// relaxes the inner KSP tolerance according to the outer residuals
+	void setInexact( PetscTruth flag = PETSC_TRUE )
+	{
+	    if ( flag && !_inexactAttached )
+		{
+		    _inexact.attach( _solver );
+		    _inexactAttached = PETSC_TRUE;
+		}
+	    _inexact.setEnabled( flag );
+	}
+
+	InexactShiftInvert& inexact() { return _inexact; }
+
+	/*
+	 * Computes left eigenvectors too. By default the operator is wrapped so
+	 * that the transpose products run on an explicit A^T built once per
+	 * operator state, which rules out spectral transformations that factor it.
+	 */
+	void setTwoSided( PetscTruth flag = PETSC_TRUE, PetscTruth explicitTranspose = PETSC_TRUE )
+	{
+	    _twoSided = flag;
+	    _explicitTranspose = explicitTranspose;
+	    EPSSetLeftVectorsWanted( _solver, flag );
+	}
+
+	ExplicitTranspose& explicitTranspose() { return _transpose; }
+
+	// products on a SELL-C-sigma copy of A, one-sided only
+	void setSliced( PetscTruth flag = PETSC_TRUE ) { _sliced = flag; }
+
+	SlicedEllpack& slicedEllpack() { return _sell; }
+
+	// EPSSetDeflationSpace, EPSSetInitialSpace and EPSSetInitialSpaceLeft, the vectors being in the layout and the ordering of A
+	void setDeflationSpace( PetscInt n, Vec* V ) { EPSSetDeflationSpace( _solver, n, V ); _deflation = n; }
+	void setInitialSpace( PetscInt n, Vec* V ) { EPSSetInitialSpace( _solver, n, V ); _initial = n; }
+	void setInitialSpaceLeft( PetscInt n, Vec* V ) { EPSSetInitialSpaceLeft( _solver, n, V ); _initialLeft = n; }
+
+	// solves on P A P^T from the next solve on, Reordering::None disables it; no deflation or initial space then
+	void setReordering( Reordering::Method method ) { _reordering.setMethod( method ); }
+
+	Reordering& reordering() { return _reordering; }
+	const Reordering& reordering() const { return _reordering; }
+
+	// operators of at most maxSize rows are solved densely, 0 (the default) disables it
+	void setDense( PetscInt maxSize ) { _denseSize = maxSize; }
+
+	// whether the last solve went to LAPACK
+	PetscTruth dense() const { return _dense; }
+	const DenseEigensolver& denseSolver() const { return _denseSolver; }
+
+	// KSP of the spectral transformation, shell or built-in
+	KSP ksp() const
+	{
+	    if ( _st ) { return _st->ksp(); }
+
+	    ST st;
+	    KSP ksp;
+	    EPSGetST( _solver, &st );
+	    STGetKSP( st, &ksp );
+	    return ksp;
 	}
 
 	operator EPS() const { return _solver; }
 
-	void printOn(std::ostream&) const
+	void printOn(std::ostream& os) const
 	{
 	    const EPSType type;
 	    PetscReal error, tol, re, im;
 	    PetscScalar kr, ki;
 	    PetscInt i, nev, maxit, its, nconv;
 
-	    EPSGetIterationNumber(_solver,&its);
-	    PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);
-	    EPSGetType(_solver,&type);
-	    PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);
-	    EPSGetDimensions(_solver,&nev,PETSC_NULL,PETSC_NULL);
-	    PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);
-	    EPSGetTolerances(_solver,&tol,&maxit);
-	    PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);
+	    if ( _dense )
+		{
+		    _denseSolver.printOn( os );
+		    EPSGetDimensions(_solver,&nev,PETSC_NULL,PETSC_NULL);
+		    PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);
+		}
+	    else
+		{
+		    if ( _reordered ) { _reordering.printOn( os ); }
+		    EPSGetIterationNumber(_solver,&its);
+		    PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);
+		    EPSGetType(_solver,&type);
+		    PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);
+		    EPSGetDimensions(_solver,&nev,PETSC_NULL,PETSC_NULL);
+		    PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);
+		    EPSGetTolerances(_solver,&tol,&maxit);
+		    PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);
+		}
 
-	    EPSGetConverged(_solver,&nconv);
+	    nconv = getConverged();
 	    PetscPrintf(PETSC_COMM_WORLD," Number of converged eigenpairs: %d\n\n",nconv);
 
 	    if (nconv>0)
 		{
-		    PetscPrintf(PETSC_COMM_WORLD,
-				"           k          ||Ax-kx||/||kx||\n"
-				"   ----------------- ------------------\n" );
+		    if (_twoSided)
+			{
+			    PetscPrintf(PETSC_COMM_WORLD,
+					"           k          ||Ax-kx||/||kx|| ||y'A-ky'||/||ky||\n"
+					"   ----------------- ------------------ ------------------\n" );
+			}
+		    else
+			{
+			    PetscPrintf(PETSC_COMM_WORLD,
+					"           k          ||Ax-kx||/||kx||\n"
+					"   ----------------- ------------------\n" );
+			}
 
 		    for( i=0; i<nconv; i++ )
 			{
-			    EPSGetEigenpair(_solver,i,&kr,&ki,_xr,_xi);
-			    EPSComputeRelativeError(_solver,i,&error);
+			    getEigenpair(i,&kr,&ki,_xr,_xi);
+			    error = getRelativeError(i);
 
 #ifdef PETSC_USE_COMPLEX
 			    re = PetscRealPart(kr);
@@ -93,21 +289,141 @@ namespace slepc_cxx
 #endif
 			    if (im!=0.0)
 				{
-				    PetscPrintf(PETSC_COMM_WORLD," %9f%+9f j %12g\n",re,im,error);
+				    PetscPrintf(PETSC_COMM_WORLD," %9f%+9f j %12g",re,im,error);
 				}
 			    else
 				{
-				    PetscPrintf(PETSC_COMM_WORLD,"   %12f       %12g\n",re,error);
+				    PetscPrintf(PETSC_COMM_WORLD,"   %12f       %12g",re,error);
+				}
+			    if (_twoSided)
+				{
+				    PetscPrintf(PETSC_COMM_WORLD,"       %12g",getRelativeErrorLeft(i));
 				}
+			    PetscPrintf(PETSC_COMM_WORLD,"\n");
 			}
 		    PetscPrintf(PETSC_COMM_WORLD,"\n" );
 		}
 	}
 
+    private:
+	EPSolver( const EPSolver& );
+	EPSolver& operator=( const EPSolver& );
+
+	// preferred first for the comparator, a precedes b
+	class Precedes
+	{
+	public:
+	    Precedes( const std::vector< PetscScalar >& kr, const std::vector< PetscScalar >& ki, const Compare& compare )
+		: _kr(kr), _ki(ki), _compare(compare) {}
+
+	    bool operator()( PetscInt a, PetscInt b ) const { return _compare( _kr[a], _ki[a], _kr[b], _ki[b] ); }
+
+	private:
+	    const std::vector< PetscScalar >& _kr;
+	    const std::vector< PetscScalar >& _ki;
+	    const Compare& _compare;
+	};
+
+	// one call per comparison: the sort only asks whether a goes first, ties come back as 1
+	static PetscErrorCode compare( EPS, PetscScalar ar, PetscScalar ai, PetscScalar br, PetscScalar bi, PetscInt* r, void* ctx )
+	{
+	    const Compare& precedes = *static_cast< const Compare* >( ctx );
+
+	    PetscFunctionBegin;
+	    *r = precedes( ar, ai, br, bi ) ? -1 : 1;
+	    PetscFunctionReturn(0);
+	}
+
+	void attachComparison( NoComparison& ) {}
+
+	template < typename C >
+	void attachComparison( C& compare )
+	{
+	    EPSSetEigenvalueComparison( _solver, &EPSolver::compare, &compare );
+	}
+
+	// SLEPc already sorted them with the comparator
+	void sortConverged()
+	{
+	    PetscInt nconv, i;
+
+	    EPSGetConverged( _solver, &nconv );
+	    _order.resize( nconv );
+	    for ( i = 0; i < nconv; ++i ) { _order[i] = i; }
+	}
+
+	// all the eigenpairs by LAPACK, then the first nev of them without splitting a conjugate pair
+	void solveDense( Mat A )
+	{
+	    EPSProblemType type;
+	    EPSWhich which;
+	    PetscScalar target;
+	    PetscInt nconv, nev, i;
+
+	    EPSGetProblemType( _solver, &type );
+	    EPSGetWhichEigenpairs( _solver, &which );
+	    EPSGetTarget( _solver, &target );
+	    EPSGetDimensions( _solver, &nev, PETSC_NULL, PETSC_NULL );
+	    _denseSolver.solve( A, type == EPS_HEP ? PETSC_TRUE : PETSC_FALSE, which, target );
+
+	    // SLEPc does not see these, they are ordered here with the same comparator
+	    nconv = _denseSolver.getConverged();
+	    _order.resize( nconv );
+	    _kr.resize( nconv );
+	    _ki.resize( nconv );
+	    for ( i = 0; i < nconv; ++i )
+		{
+		    _order[i] = i;
+		    _denseSolver.getEigenpair( i, &_kr[i], &_ki[i] );
+		}
+	    sortOrder( _compare );
+
+	    nev = PetscMin( nev, nconv );
+	    if ( nev > 0 && nev < nconv && PetscRealPart( _ki[_order[nev-1]] ) > 0 ) { ++nev; }
+	    _order.resize( nev );
+	}
+
+	void sortOrder( NoComparison& ) {}
+
+	template < typename C >
+	void sortOrder( C& compare )
+	{
+	    std::stable_sort( _order.begin(), _order.end(), Precedes( _kr, _ki, compare ) );
+	}
+
+	// whether vectors in the ordering of A were given to SLEPc
+	PetscTruth userSpaces() const { return _deflation > 0 || _initial > 0 || _initialLeft > 0 ? PETSC_TRUE : PETSC_FALSE; }
+
+	void destroyVecs()
+	{
+	    if ( _xr ) { VecDestroy( _xr ); _xr = PETSC_NULL; }
+	    if ( _xi ) { VecDestroy( _xi ); _xi = PETSC_NULL; }
+	}
+
     private:
 	EPS _solver;
 	Vec _xr;
 	Vec _xi;
+	SpectralTransformBase* _st;
+	InexactShiftInvert _inexact;
+	PetscTruth _inexactAttached;
+	PetscTruth _twoSided;
+	PetscTruth _explicitTranspose;
+	ExplicitTranspose _transpose;
+	Compare _compare;
+	std::vector< PetscInt > _order;
+	std::vector< PetscScalar > _kr;
+	std::vector< PetscScalar > _ki;
+	PetscInt _denseSize;
+	PetscTruth _dense;
+	DenseEigensolver _denseSolver;
+	PetscTruth _sliced;
+	SlicedEllpack _sell;
+	Reordering _reordering;
+	PetscTruth _reordered;
+	PetscInt _deflation;
+	PetscInt _initial;
+	PetscInt _initialLeft;
     };
 }
 
@@ -0,0 +1,66 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_EigenvalueComparison_h
+#define _slepc_cxx_EigenvalueComparison_h
+
+#include <slepceps.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Eigenvalue comparators for EPSolver. A comparator is a copyable function
+     * object whose
+     *
+     *	bool operator()( PetscScalar ar, PetscScalar ai, PetscScalar br, PetscScalar bi ) const
+     *
+     * returns true when ar + i ai is preferred to br + i bi. EPSolver hands
+     * it to SLEPc through EPSSetEigenvalueComparison, so the eigenpairs come
+     * back in that order from EPSSolve; only the dense path sorts them on the
+     * C++ side, with the same comparator.
+     *
+     * The comparator is called once per comparison, so SLEPc only learns
+     * whether a goes first: a tie, operator() false both ways, is reported
+     * as b first, and equal values come back in no particular order. The
+     * dense path uses a stable sort, which keeps their LAPACK order.
+     */
+
+    // keeps the ordering selected with EPSSetWhichEigenpairs
+    struct NoComparison {};
+
+    // closest to the target on its right side first, then closest on its left
+    class RightOfTarget
+    {
+    public:
+	RightOfTarget( PetscScalar target = 0.0 ) : _target(target) {}
+
+	bool operator()( PetscScalar ar, PetscScalar ai, PetscScalar br, PetscScalar bi ) const
+	{
+	    bool aright = PetscRealPart(_target) < PetscRealPart(ar);
+	    bool bright = PetscRealPart(_target) < PetscRealPart(br);
+	    if ( aright != bright ) { return aright; }
+	    return SlepcAbsEigenvalue( ar - _target, ai ) < SlepcAbsEigenvalue( br - _target, bi );
+	}
+
+    private:
+	PetscScalar _target;
+    };
+}
+
+#endif // !_slepc_cxx_EigenvalueComparison_h
@@ -0,0 +1,108 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include "ExplicitTranspose.h"
+
+namespace slepc_cxx
+{
+    ExplicitTranspose::ExplicitTranspose()
+	: _source(PETSC_NULL), _transpose(PETSC_NULL), _shell(PETSC_NULL), _state(-1),
+	  _builds(0), _products(0), _transposeProducts(0)
+    {}
+
+    ExplicitTranspose::~ExplicitTranspose()
+    {
+	if ( _transpose ) { MatDestroy( _transpose ); }
+	if ( _shell ) { MatDestroy( _shell ); }
+	if ( _source ) { MatDestroy( _source ); }
+    }
+
+    Mat ExplicitTranspose::operator()( Mat A )
+    {
+	PetscInt state, M, N, m, n;
+	MPI_Comm comm;
+
+	PetscObjectStateQuery( (PetscObject)A, &state );
+	if ( A == _source && state == _state ) { return _shell; }
+
+	if ( _transpose ) { MatDestroy( _transpose ); }
+	MatTranspose( A, MAT_INITIAL_MATRIX, &_transpose );
+	++_builds;
+
+	if ( A != _source )
+	    {
+		// the shell products read A, it is held until it is replaced
+		PetscObjectReference( (PetscObject)A );
+		if ( _source ) { MatDestroy( _source ); }
+		_source = A;
+		if ( _shell ) { MatDestroy( _shell ); }
+		PetscObjectGetComm( (PetscObject)A, &comm );
+		MatGetSize( A, &M, &N );
+		MatGetLocalSize( A, &m, &n );
+		MatCreateShell( comm, m, n, M, N, this, &_shell );
+		MatShellSetOperation( _shell, MATOP_MULT, (void(*)(void))mult );
+		MatShellSetOperation( _shell, MATOP_MULT_TRANSPOSE, (void(*)(void))multTranspose );
+		MatShellSetOperation( _shell, MATOP_GET_DIAGONAL, (void(*)(void))getDiagonal );
+	    }
+
+	_state = state;
+	return _shell;
+    }
+
+    void ExplicitTranspose::printOn(std::ostream&) const
+    {
+	PetscPrintf(PETSC_COMM_WORLD," Explicit transposes built: %d, products: %d, transpose products: %d\n\n",
+		    _builds,_products,_transposeProducts);
+    }
+
+    PetscErrorCode ExplicitTranspose::mult( Mat shell, Vec x, Vec y )
+    {
+	ExplicitTranspose* self;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = MatMult( self->_source, x, y );CHKERRQ(ierr);
+	++self->_products;
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode ExplicitTranspose::multTranspose( Mat shell, Vec x, Vec y )
+    {
+	ExplicitTranspose* self;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = MatMult( self->_transpose, x, y );CHKERRQ(ierr);
+	++self->_transposeProducts;
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode ExplicitTranspose::getDiagonal( Mat shell, Vec d )
+    {
+	ExplicitTranspose* self;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = MatGetDiagonal( self->_source, d );CHKERRQ(ierr);
+	PetscFunctionReturn(0);
+    }
+}
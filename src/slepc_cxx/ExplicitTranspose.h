@@ -0,0 +1,73 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_ExplicitTranspose_h
+#define _slepc_cxx_ExplicitTranspose_h
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Shell operator behaving as A whose transpose products run as MatMult
+     * on an explicit copy of A^T. A parallel MatMultTranspose on AIJ scatters
+     * partial results in reverse, the copy makes them plain row-oriented
+     * products at the cost of the memory of A once more.
+     *
+     * The copy is made on the first use and kept until the state of A
+     * changes. A is referenced while it is held, so the shell never reads a
+     * destroyed matrix and another matrix cannot take its address. The shell only provides products and the diagonal, so it
+     * fits spectral transformations that do not factor the operator.
+     */
+    class ExplicitTranspose : public core_library::Printable
+    {
+    public:
+	ExplicitTranspose();
+	~ExplicitTranspose();
+
+	// collective, the shell stays valid while A lives and until the next call
+	Mat operator()( Mat A );
+
+	Mat transpose() const { return _transpose; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	ExplicitTranspose( const ExplicitTranspose& );
+	ExplicitTranspose& operator=( const ExplicitTranspose& );
+
+	static PetscErrorCode mult( Mat shell, Vec x, Vec y );
+	static PetscErrorCode multTranspose( Mat shell, Vec x, Vec y );
+	static PetscErrorCode getDiagonal( Mat shell, Vec d );
+
+    private:
+	Mat _source;
+	Mat _transpose;
+	Mat _shell;
+	PetscInt _state;
+
+	PetscInt _builds;
+	PetscInt _products;
+	PetscInt _transposeProducts;
+    };
+}
+
+#endif // !_slepc_cxx_ExplicitTranspose_h
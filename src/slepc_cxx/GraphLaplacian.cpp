@@ -0,0 +1,339 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "GraphLaplacian.h"
+#include "MappedFile.h"
+#include "RowPartition.h"
+#include "TextParsing.h"
+
+namespace slepc_cxx
+{
+    using namespace text;
+
+    namespace
+    {
+	PetscInt find( std::vector< PetscInt >& parent, PetscInt k )
+	{
+	    while ( parent[k] != k ) { k = parent[k] = parent[ parent[k] ]; }
+	    return k;
+	}
+
+	// the root of a set is its smallest element
+	void unite( std::vector< PetscInt >& parent, PetscInt a, PetscInt b )
+	{
+	    a = find( parent, a );
+	    b = find( parent, b );
+	    if ( a < b ) { parent[b] = a; }
+	    else { parent[a] = b; }
+	}
+
+	// returns the number of edges with a vertex out of [0, n)
+	long long parseEdges( const char* data, size_t begin, size_t end, PetscInt n, GraphLaplacian& graph )
+	{
+	    const char* p = data + begin;
+	    const char* last = data + end;
+	    long long i, j, bad = 0;
+	    PetscReal w;
+
+	    while ( p < last )
+		{
+		    p = skipBlanks( p, last );
+		    if ( p < last && *p != '#' && *p != '%' && *p != '\n' && parseInteger( p, last, i ) && parseInteger( p, last, j ) )
+			{
+			    if ( !parseReal( p, last, w ) ) { w = 1.0; }
+			    if ( i < 0 || i >= n || j < 0 || j >= n ) { ++bad; }
+			    else { graph.addEdge( i, j, w ); }
+			}
+		    while ( p < last && *p != '\n' ) { ++p; }
+		    ++p;
+		}
+	    return bad;
+	}
+    }
+
+    GraphLaplacian::GraphLaplacian( PetscInt n, Type type /*= Combinatorial*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _n(n), _type(type), _builder(comm), _maxComponents(100), _edges(0), _imbalance(1.0)
+    {}
+
+    GraphLaplacian::~GraphLaplacian() { destroyNullspace(); }
+
+    void GraphLaplacian::load( const std::string& path )
+    {
+	MappedFile file( path );
+	PetscMPIInt size, rank;
+	long long bad = 0, total;
+	size_t begin, end;
+
+	MPI_Comm_size( _comm, &size );
+	MPI_Comm_rank( _comm, &rank );
+
+	const char* data = file.data();
+	slice( data, 0, file.size(), rank, size, &begin, &end );
+	file.willNeed( begin, end );
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:bad)
+#endif
+	{
+#ifdef _OPENMP
+	    size_t threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+	    size_t threads = 1, thread = 0;
+#endif
+	    size_t b, e;
+	    slice( data, begin, end, thread, threads, &b, &e );
+	    _builder.prepare();
+	    bad += parseEdges( data, b, e, _n, *this );
+	}
+
+	MPI_Allreduce( &bad, &total, 1, MPI_LONG_LONG_INT, MPI_SUM, _comm );
+	if ( total ) { throw std::runtime_error( "GraphLaplacian: vertex out of range in " + path ); }
+    }
+
+    void GraphLaplacian::assemble( Mat* L )
+    {
+	PetscInt rstart, rend, m, i, k;
+	PetscScalar *pd, *ps, *pe;
+	Vec d, s, e;
+	MatInfo info;
+	Mat W;
+
+	// adjacency on the uniform split, the diagonal is kept in the pattern for D
+	MatCreate( _comm, &W );
+	MatSetSizes( W, PETSC_DECIDE, PETSC_DECIDE, _n, _n );
+	_builder.ownershipRange( W, &rstart, &rend );
+	for ( i = rstart; i < rend; ++i ) { _builder.add( i, i, 0.0 ); }
+	_builder.assemble( W );
+
+	// rows moved to about the same number of nonzeros per rank
+	RowPartition::redistribute( W, L );
+	MatDestroy( W );
+	MatGetLocalSize( *L, &m, PETSC_NULL );
+
+	MatGetVecs( *L, PETSC_NULL, &d );
+	MatGetRowSum( *L, d );
+
+	VecDuplicate( d, &s );
+	VecDuplicate( d, &e );
+	VecGetArray( d, &pd );
+	VecGetArray( s, &ps );
+	VecGetArray( e, &pe );
+	for ( k = 0; k < m; ++k )
+	    {
+		PetscReal dk = PetscRealPart( pd[k] );
+		ps[k] = dk > 0 ? 1.0 / PetscSqrtScalar( pd[k] ) : 0.0;
+		pe[k] = dk > 0 ? 1.0 : 0.0;
+	    }
+	VecRestoreArray( d, &pd );
+	VecRestoreArray( s, &ps );
+	VecRestoreArray( e, &pe );
+
+	if ( _type == Normalized ) { MatDiagonalScale( *L, s, s ); }
+	MatScale( *L, -1.0 );
+	MatDiagonalSet( *L, _type == Normalized ? e : d, INSERT_VALUES );
+	VecDestroy( s );
+	VecDestroy( e );
+
+	std::vector< PetscInt > labels;
+	findComponents( *L, labels );
+	try
+	    {
+		buildNullspace( *L, labels, d );
+	    }
+	catch ( ... )
+	    {
+		VecDestroy( d );
+		MatDestroy( *L );
+		throw;
+	    }
+	VecDestroy( d );
+
+	_imbalance = RowPartition::imbalance( *L );
+	MatGetInfo( *L, MAT_GLOBAL_SUM, &info );
+	_edges = ( (long long)info.nz_used - _n ) / 2;
+    }
+
+    void GraphLaplacian::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Graph Laplacian (%s): %d vertices, %lld edges, %d connected components\n",
+		    _type == Normalized ? "normalized" : "combinatorial",_n,_edges,components());
+	PetscPrintf(_comm," Nonzero imbalance: %.3f\n\n",_imbalance);
+    }
+
+    /*
+     * Every rank first merges its rows along the local edges, then the pieces
+     * take the smallest label seen across the edges leaving the rank until no
+     * label changes. The number of exchanges grows with the number of ranks a
+     * component spans rather than with its diameter.
+     */
+    void GraphLaplacian::findComponents( Mat L, std::vector< PetscInt >& labels ) const
+    {
+	PetscInt rstart, rend, m, i, k, c, ncols;
+	const PetscInt* cols;
+	PetscScalar *px, *pg;
+	int local, changed = 1;
+	Vec x, g;
+	IS is;
+	VecScatter scatter;
+
+	MatGetOwnershipRange( L, &rstart, &rend );
+	m = rend - rstart;
+
+	std::vector< PetscInt > parent( m ), root( m ), ghostPtr( m + 1, 0 ), ghostCols;
+	for ( k = 0; k < m; ++k ) { parent[k] = k; }
+	for ( i = rstart; i < rend; ++i )
+	    {
+		MatGetRow( L, i, &ncols, &cols, PETSC_NULL );
+		for ( c = 0; c < ncols; ++c )
+		    {
+			if ( cols[c] >= rstart && cols[c] < rend ) { unite( parent, i - rstart, cols[c] - rstart ); }
+			else { ghostCols.push_back( cols[c] ); }
+		    }
+		ghostPtr[i-rstart+1] = ghostCols.size();
+		MatRestoreRow( L, i, &ncols, &cols, PETSC_NULL );
+	    }
+
+	labels.resize( m );
+	for ( k = 0; k < m; ++k )
+	    {
+		root[k] = find( parent, k );
+		labels[k] = rstart + root[k];
+	    }
+
+	std::vector< PetscInt > ghosts( ghostCols );
+	std::sort( ghosts.begin(), ghosts.end() );
+	ghosts.erase( std::unique( ghosts.begin(), ghosts.end() ), ghosts.end() );
+	for ( size_t t = 0; t < ghostCols.size(); ++t )
+	    {
+		ghostCols[t] = std::lower_bound( ghosts.begin(), ghosts.end(), ghostCols[t] ) - ghosts.begin();
+	    }
+
+	MatGetVecs( L, &x, PETSC_NULL );
+	VecCreateSeq( PETSC_COMM_SELF, ghosts.size(), &g );
+	ISCreateGeneral( PETSC_COMM_SELF, ghosts.size(), ghosts.empty() ? PETSC_NULL : &ghosts[0], &is );
+	VecScatterCreate( x, is, g, PETSC_NULL, &scatter );
+
+	while ( changed )
+	    {
+		VecGetArray( x, &px );
+		for ( k = 0; k < m; ++k ) { px[k] = labels[k]; }
+		VecRestoreArray( x, &px );
+
+		VecScatterBegin( scatter, x, g, INSERT_VALUES, SCATTER_FORWARD );
+		VecScatterEnd( scatter, x, g, INSERT_VALUES, SCATTER_FORWARD );
+
+		// the labels are uniform on a local piece, best is indexed by its root
+		std::vector< PetscInt > best( labels );
+		VecGetArray( g, &pg );
+		for ( k = 0; k < m; ++k )
+		    {
+			for ( c = ghostPtr[k]; c < ghostPtr[k+1]; ++c )
+			    {
+				PetscInt l = (PetscInt)PetscRealPart( pg[ ghostCols[c] ] );
+				if ( l < best[ root[k] ] ) { best[ root[k] ] = l; }
+			    }
+		    }
+		VecRestoreArray( g, &pg );
+
+		local = 0;
+		for ( k = 0; k < m; ++k )
+		    {
+			if ( best[ root[k] ] < labels[k] ) { labels[k] = best[ root[k] ]; local = 1; }
+		    }
+		MPI_Allreduce( &local, &changed, 1, MPI_INT, MPI_MAX, _comm );
+	    }
+
+	VecScatterDestroy( scatter );
+	ISDestroy( is );
+	VecDestroy( g );
+	VecDestroy( x );
+    }
+
+    // a component is named after its smallest vertex, the rank owning it holds the root
+    void GraphLaplacian::buildNullspace( Mat L, const std::vector< PetscInt >& labels, Vec degrees )
+    {
+	PetscMPIInt size, p;
+	PetscInt rstart, rend, m, k, c;
+	PetscScalar* pd;
+
+	destroyNullspace();
+
+	MPI_Comm_size( _comm, &size );
+	MatGetOwnershipRange( L, &rstart, &rend );
+	m = rend - rstart;
+
+	std::vector< PetscInt > roots;
+	for ( k = 0; k < m; ++k )
+	    {
+		if ( labels[k] == rstart + k ) { roots.push_back( labels[k] ); }
+	    }
+
+	PetscMPIInt count = roots.size();
+	std::vector< PetscMPIInt > counts( size ), displs( size + 1, 0 );
+	MPI_Allgather( &count, 1, MPI_INT, &counts[0], 1, MPI_INT, _comm );
+	for ( p = 0; p < size; ++p ) { displs[p+1] = displs[p] + counts[p]; }
+
+	// one Vec of n entries per component, every rank sees the same count
+	if ( displs[size] > _maxComponents )
+	    {
+		throw std::runtime_error( "GraphLaplacian: more connected components than setMaxComponents() allows, each one takes a Vec of n entries" );
+	    }
+
+	// ranks hold increasing rows, the gathered roots are sorted
+	std::vector< PetscInt > all( displs[size] );
+	MPI_Allgatherv( roots.empty() ? PETSC_NULL : &roots[0], count, MPIU_INT,
+			all.empty() ? PETSC_NULL : &all[0], &counts[0], &displs[0], MPIU_INT, _comm );
+
+	_nullspace.resize( all.size() );
+	std::vector< PetscScalar* > arrays( all.size() );
+	for ( c = 0; c < (PetscInt)all.size(); ++c )
+	    {
+		VecDuplicate( degrees, &_nullspace[c] );
+		VecSet( _nullspace[c], 0.0 );
+		VecGetArray( _nullspace[c], &arrays[c] );
+	    }
+
+	VecGetArray( degrees, &pd );
+	for ( k = 0; k < m; ++k )
+	    {
+		c = std::lower_bound( all.begin(), all.end(), labels[k] ) - all.begin();
+		arrays[c][k] = ( _type == Normalized && PetscRealPart( pd[k] ) > 0 ) ? PetscSqrtScalar( pd[k] ) : 1.0;
+	    }
+	VecRestoreArray( degrees, &pd );
+
+	for ( c = 0; c < (PetscInt)all.size(); ++c )
+	    {
+		VecRestoreArray( _nullspace[c], &arrays[c] );
+		VecNormalize( _nullspace[c], PETSC_NULL );
+	    }
+    }
+
+    void GraphLaplacian::destroyNullspace()
+    {
+	for ( size_t c = 0; c < _nullspace.size(); ++c ) { VecDestroy( _nullspace[c] ); }
+	_nullspace.clear();
+    }
+}
@@ -0,0 +1,108 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_GraphLaplacian_h
+#define _slepc_cxx_GraphLaplacian_h
+
+#include <string>
+#include <vector>
+
+#include <slepceps.h>
+
+#include <core_library/Printable.h>
+
+#include "MatrixBuilder.h"
+
+namespace slepc_cxx
+{
+    /*
+     * Laplacian of an undirected weighted graph, L = D - W or, normalised,
+     * L = I - D^-1/2 W D^-1/2.
+     *
+     * Edges can be added from any rank and any OpenMP thread, or read in
+     * parallel from an edge list. assemble() redistributes the rows so that
+     * every rank holds about the same number of nonzeros, then finds the
+     * connected components: their indicator vectors (scaled by D^1/2 in the
+     * normalised case) span the nullspace of L and are handed to the
+     * eigensolver as deflation space by deflate(). Each of them is a full
+     * distributed Vec, so assemble() throws on every rank when the graph has
+     * more components than setMaxComponents() allows.
+     */
+    class GraphLaplacian : public core_library::Printable
+    {
+    public:
+	enum Type { Combinatorial, Normalized };
+
+	GraphLaplacian( PetscInt n, Type type = Combinatorial, MPI_Comm comm = PETSC_COMM_WORLD );
+	~GraphLaplacian();
+
+	// undirected, repeated edges add up and self loops are ignored
+	void addEdge( PetscInt i, PetscInt j, PetscScalar w = 1.0 )
+	{
+	    if ( i == j ) { return; }
+	    _builder.add( i, j, w );
+	    _builder.add( j, i, w );
+	}
+
+	// collective, one "i j [w]" edge per line with 0-based vertices, '#' and '%' start comments
+	void load( const std::string& path );
+
+	// collective, creates L and its nullspace, the edges are released
+	void assemble( Mat* L );
+
+	// 100 by default, assemble() refuses graphs with more components
+	void setMaxComponents( PetscInt maxComponents ) { _maxComponents = maxComponents; }
+
+	// collective, attaches the nullspace of the last assembled L to an EPSolver
+	template < typename Solver >
+	void deflate( Solver& eps ) const
+	{
+	    if ( _nullspace.empty() ) { return; }
+	    eps.setDeflationSpace( _nullspace.size(), const_cast< Vec* >( &_nullspace[0] ) );
+	}
+
+	PetscInt components() const { return _nullspace.size(); }
+	const std::vector< Vec >& nullspace() const { return _nullspace; }
+
+	// largest number of local nonzeros over the average one
+	PetscReal imbalance() const { return _imbalance; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	GraphLaplacian( const GraphLaplacian& );
+	GraphLaplacian& operator=( const GraphLaplacian& );
+
+	void findComponents( Mat L, std::vector< PetscInt >& labels ) const;
+	void buildNullspace( Mat L, const std::vector< PetscInt >& labels, Vec degrees );
+	void destroyNullspace();
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _n;
+	Type _type;
+	MatrixBuilder _builder;
+	PetscInt _maxComponents;
+	std::vector< Vec > _nullspace;
+	long long _edges;
+	PetscReal _imbalance;
+    };
+}
+
+#endif // !_slepc_cxx_GraphLaplacian_h
@@ -0,0 +1,296 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+
+#include "ImplicitSVD.h"
+#include "SVDResidual.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	void destroy( Vec& v ) { if ( v ) { VecDestroy( v ); v = PETSC_NULL; } }
+
+	// squared norms of the two halves of a cyclic eigenvector
+	void halves( Vec x, PetscInt m, PetscReal* u, PetscReal* v )
+	{
+	    PetscScalar* p;
+	    PetscReal local[2] = { 0, 0 }, global[2];
+	    PetscInt n, k;
+	    MPI_Comm comm;
+
+	    VecGetLocalSize( x, &n );
+	    VecGetArray( x, &p );
+	    for ( k = 0; k < n; ++k ) { local[k < m ? 0 : 1] += PetscRealPart( PetscConj( p[k] ) * p[k] ); }
+	    VecRestoreArray( x, &p );
+	    PetscObjectGetComm( (PetscObject)x, &comm );
+	    MPI_Allreduce( local, global, 2, MPIU_REAL, MPI_SUM, comm );
+	    *u = global[0];
+	    *v = global[1];
+	}
+    }
+
+    ImplicitSVD::ImplicitSVD( Formulation formulation /*= Automatic*/, PetscReal aspectRatio /*= 1.5*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _formulation(formulation), _aspectRatio(aspectRatio), _target(-1), _shift(0), _used(Cross), _right(PETSC_TRUE),
+	  _A(PETSC_NULL), _shell(PETSC_NULL), _work(PETSC_NULL),
+	  _xu(PETSC_NULL), _xv(PETSC_NULL), _yu(PETSC_NULL), _yv(PETSC_NULL), _x(PETSC_NULL),
+	  _m(0), _n(0), _products(0)
+    {
+	EPSCreate( comm, &_eps );
+	EPSSetOptionsPrefix( _eps, "implicit_" );
+	EPSSetProblemType( _eps, EPS_HEP );
+    }
+
+    ImplicitSVD::~ImplicitSVD()
+    {
+	destroyShell();
+	EPSDestroy( _eps );
+    }
+
+    void ImplicitSVD::solve( Mat A, PetscInt nsv /*= 1*/, PetscTruth smallest /*= PETSC_FALSE*/ )
+    {
+	PetscInt M, N, nconv, i;
+	PetscReal ratio, u, v, norm, tol;
+	PetscScalar kr;
+	ST st;
+	KSP ksp;
+	PC pc;
+
+	MatGetSize( A, &M, &N );
+	MatGetLocalSize( A, &_m, &_n );
+	ratio = (PetscReal)PetscMax( M, N ) / PetscMin( M, N );
+
+	_used = _formulation;
+	if ( _used == Automatic ) { _used = smallest && ratio < _aspectRatio ? Cyclic : Cross; }
+	_right = N <= M ? PETSC_TRUE : PETSC_FALSE;
+	_products = 0;
+
+	createShell( A );
+	EPSSetOperators( _eps, _shell, PETSC_NULL );
+	EPSSetDimensions( _eps, nsv, PETSC_DECIDE, PETSC_DECIDE );
+	EPSGetST( _eps, &st );
+	if ( _used == Cyclic && smallest )
+	    {
+		// shift-and-invert near zero, which is itself an eigenvalue when M != N
+		MatNorm( A, NORM_FROBENIUS, &norm );
+		_shift = _target >= 0 ? _target : 100 * PETSC_MACHINE_EPSILON * norm;
+		STSetType( st, STSINVERT );
+		STSetMatMode( st, ST_MATMODE_SHELL );
+		STSetShift( st, _shift );
+		EPSSetTarget( _eps, _shift );
+		EPSSetEigenvalueComparison( _eps, &ImplicitSVD::precedes, this );
+
+		// C - tau I is indefinite and only known through its products
+		EPSGetTolerances( _eps, &tol, PETSC_NULL );
+		STGetKSP( st, &ksp );
+		KSPSetType( ksp, KSPMINRES );
+		KSPGetPC( ksp, &pc );
+		PCSetType( pc, PCNONE );
+		KSPSetTolerances( ksp, 0.1 * tol, PETSC_DEFAULT, PETSC_DEFAULT, PETSC_DEFAULT );
+	    }
+	else
+	    {
+		STSetType( st, STSHIFT );
+		STSetShift( st, 0.0 );
+		EPSSetWhichEigenpairs( _eps, smallest ? EPS_SMALLEST_REAL : EPS_LARGEST_REAL );
+	    }
+	EPSSetFromOptions( _eps );
+	EPSSolve( _eps );
+
+	_index.clear();
+	_sigma.clear();
+	EPSGetConverged( _eps, &nconv );
+	for ( i = 0; i < nconv && (PetscInt)_sigma.size() < nsv; ++i )
+	    {
+		EPSGetEigenpair( _eps, i, &kr, PETSC_NULL, _x, PETSC_NULL );
+		if ( _used == Cross )
+		    {
+			_index.push_back( i );
+			_sigma.push_back( std::sqrt( PetscMax( PetscRealPart( kr ), 0 ) ) );
+			continue;
+		    }
+		if ( PetscRealPart( kr ) <= 0 ) { continue; }
+		halves( _x, _m, &u, &v );
+		if ( PetscAbsReal( u - v ) > 0.5 * ( u + v ) ) { continue; }
+		_index.push_back( i );
+		_sigma.push_back( PetscRealPart( kr ) );
+	    }
+    }
+
+    void ImplicitSVD::getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u /*= PETSC_NULL*/, Vec v /*= PETSC_NULL*/ ) const
+    {
+	PetscScalar kr, *p;
+	PetscReal norm;
+
+	*sigma = _sigma[i];
+	if ( !u && !v ) { return; }
+
+	EPSGetEigenpair( _eps, _index[i], &kr, PETSC_NULL, _x, PETSC_NULL );
+
+	if ( _used == Cyclic )
+	    {
+		VecGetArray( _x, &p );
+		VecPlaceArray( _xu, p );
+		VecPlaceArray( _xv, p + _m );
+		if ( u ) { VecCopy( _xu, u ); VecNormalize( u, &norm ); }
+		if ( v ) { VecCopy( _xv, v ); VecNormalize( v, &norm ); }
+		VecResetArray( _xu );
+		VecResetArray( _xv );
+		VecRestoreArray( _x, &p );
+		return;
+	    }
+
+	// the other vector is A v / sigma or A^H u / sigma
+	if ( _right )
+	    {
+		if ( v ) { VecCopy( _x, v ); }
+		if ( u ) { MatMult( _A, _x, u ); VecNormalize( u, &norm ); }
+	    }
+	else
+	    {
+		if ( u ) { VecCopy( _x, u ); }
+		if ( v ) { multHermitianTranspose( _A, _x, v ); VecNormalize( v, &norm ); }
+	    }
+    }
+
+    PetscReal ImplicitSVD::getRelativeError( PetscInt i ) const
+    {
+	PetscReal sigma, error;
+	Vec u, v;
+
+	MatGetVecs( _A, &v, &u );
+	getSingularTriplet( i, &sigma, u, v );
+	error = relativeError( _A, sigma, u, v );
+	VecDestroy( u );
+	VecDestroy( v );
+	return error;
+    }
+
+    void ImplicitSVD::printOn(std::ostream&) const
+    {
+	PetscInt its;
+
+	EPSGetIterationNumber( _eps, &its );
+	PetscPrintf(_comm," Implicit %s SVD: %d iterations, %d shell products, %d converged singular triplets\n\n",
+		    _used == Cyclic ? "cyclic" : ( _right ? "cross-product A^H A" : "cross-product A A^H" ),its,_products,getConverged());
+    }
+
+    void ImplicitSVD::createShell( Mat A )
+    {
+	PetscInt M, N;
+
+	destroyShell();
+	_A = A;
+	MatGetSize( A, &M, &N );
+
+	if ( _used == Cross )
+	    {
+		PetscInt m = _right ? _n : _m, S = _right ? N : M;
+		MatCreateShell( _comm, m, m, S, S, this, &_shell );
+		MatShellSetOperation( _shell, MATOP_MULT, (void(*)(void))multCross );
+		// holds the intermediate product
+		if ( _right ) { MatGetVecs( A, PETSC_NULL, &_work ); }
+		else { MatGetVecs( A, &_work, PETSC_NULL ); }
+	    }
+	else
+	    {
+		MatCreateShell( _comm, _m + _n, _m + _n, M + N, M + N, this, &_shell );
+		MatShellSetOperation( _shell, MATOP_MULT, (void(*)(void))multCyclic );
+		VecCreateMPIWithArray( _comm, _m, M, PETSC_NULL, &_xu );
+		VecCreateMPIWithArray( _comm, _n, N, PETSC_NULL, &_xv );
+		VecCreateMPIWithArray( _comm, _m, M, PETSC_NULL, &_yu );
+		VecCreateMPIWithArray( _comm, _n, N, PETSC_NULL, &_yv );
+	    }
+	MatGetVecs( _shell, &_x, PETSC_NULL );
+    }
+
+    void ImplicitSVD::destroyShell()
+    {
+	if ( _shell ) { MatDestroy( _shell ); _shell = PETSC_NULL; }
+	destroy( _work );
+	destroy( _xu );
+	destroy( _xv );
+	destroy( _yu );
+	destroy( _yv );
+	destroy( _x );
+    }
+
+    // the positive eigenvalues nearest to the shift go first, -sigma and the spurious zeros last
+    PetscErrorCode ImplicitSVD::precedes( EPS, PetscScalar ar, PetscScalar /*ai*/, PetscScalar br, PetscScalar /*bi*/, PetscInt* r, void* ctx )
+    {
+	ImplicitSVD* self = static_cast< ImplicitSVD* >( ctx );
+	PetscReal a = PetscRealPart( ar ), b = PetscRealPart( br ), half = 0.5 * self->_shift;
+
+	PetscFunctionBegin;
+	if ( ( a > half ) != ( b > half ) ) { *r = a > half ? -1 : 1; }
+	else { *r = PetscAbsReal( a - self->_shift ) < PetscAbsReal( b - self->_shift ) ? -1 : 1; }
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode ImplicitSVD::multCross( Mat shell, Vec x, Vec y )
+    {
+	ImplicitSVD* self;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	if ( self->_right )
+	    {
+		ierr = MatMult( self->_A, x, self->_work );CHKERRQ(ierr);
+		multHermitianTranspose( self->_A, self->_work, y );
+	    }
+	else
+	    {
+		multHermitianTranspose( self->_A, x, self->_work );
+		ierr = MatMult( self->_A, self->_work, y );CHKERRQ(ierr);
+	    }
+	++self->_products;
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode ImplicitSVD::multCyclic( Mat shell, Vec x, Vec y )
+    {
+	ImplicitSVD* self;
+	PetscScalar *px, *py;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = VecGetArray( x, &px );CHKERRQ(ierr);
+	ierr = VecGetArray( y, &py );CHKERRQ(ierr);
+	ierr = VecPlaceArray( self->_xu, px );CHKERRQ(ierr);
+	ierr = VecPlaceArray( self->_xv, px + self->_m );CHKERRQ(ierr);
+	ierr = VecPlaceArray( self->_yu, py );CHKERRQ(ierr);
+	ierr = VecPlaceArray( self->_yv, py + self->_m );CHKERRQ(ierr);
+
+	// [y_u; y_v] = [A x_v; A^H x_u]
+	ierr = MatMult( self->_A, self->_xv, self->_yu );CHKERRQ(ierr);
+	multHermitianTranspose( self->_A, self->_xu, self->_yv );
+
+	ierr = VecResetArray( self->_xu );CHKERRQ(ierr);
+	ierr = VecResetArray( self->_xv );CHKERRQ(ierr);
+	ierr = VecResetArray( self->_yu );CHKERRQ(ierr);
+	ierr = VecResetArray( self->_yv );CHKERRQ(ierr);
+	ierr = VecRestoreArray( x, &px );CHKERRQ(ierr);
+	ierr = VecRestoreArray( y, &py );CHKERRQ(ierr);
+	++self->_products;
+	PetscFunctionReturn(0);
+    }
+}
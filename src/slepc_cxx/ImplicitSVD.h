@@ -0,0 +1,124 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_ImplicitSVD_h
+#define _slepc_cxx_ImplicitSVD_h
+
+#include <vector>
+
+#include <slepceps.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Singular triplets from a Hermitian eigenproblem on a shell operator,
+     * A^H A and A A^H are never assembled.
+     *
+     * Cross: A^H (A x) on the smaller dimension, the intermediate A x goes
+     * to a work vector owned by the shell, so a product costs one MatMult and
+     * one transpose product and no matrix memory. It squares the singular
+     * values, the smallest ones lose their accuracy below sqrt(eps) ||A||.
+     *
+     * Cyclic: [0 A; A^H 0] on vectors [u; v] whose local block holds the
+     * local rows of u followed by those of v, both halves being reached
+     * through VecPlaceArray. The spectrum is +/- sigma without squaring, plus
+     * |M - N| spurious zeros, which are recognised by their unbalanced halves.
+     * The smallest ones are found by shift-and-invert with MINRES at a target
+     * tau just above the rounding level, 100 eps ||A||_F unless setTarget()
+     * gave one; the eigenvalues above tau / 2 go first, nearest to tau, so
+     * that -sigma and the spurious zeros are left out and nev = nsv.
+     *
+     * Automatic picks cyclic for the smallest singular values of a nearly
+     * square matrix (max(M,N) / min(M,N) below the aspect ratio) and cross
+     * otherwise. The eigensolver takes the options prefix "implicit_".
+     */
+    class ImplicitSVD : public core_library::Printable
+    {
+    public:
+	enum Formulation { Automatic, Cross, Cyclic };
+
+	ImplicitSVD( Formulation formulation = Automatic, PetscReal aspectRatio = 1.5, MPI_Comm comm = PETSC_COMM_WORLD );
+	~ImplicitSVD();
+
+	// collective, A must outlive the triplets
+	void solve( Mat A, PetscInt nsv = 1, PetscTruth smallest = PETSC_FALSE );
+
+	void setFormulation( Formulation formulation ) { _formulation = formulation; }
+	void setAspectRatio( PetscReal aspectRatio ) { _aspectRatio = aspectRatio; }
+
+	// shift of the cyclic smallest solve, a negative one picks the default
+	void setTarget( PetscReal target ) { _target = target; }
+	void setTolerances( PetscReal tol, PetscInt maxit ) { EPSSetTolerances( _eps, tol, maxit ); }
+
+	// the one used by the last solve
+	Formulation formulation() const { return _used; }
+
+	PetscInt getConverged() const { return _sigma.size(); }
+
+	// u and v may be PETSC_NULL
+	void getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u = PETSC_NULL, Vec v = PETSC_NULL ) const;
+
+	// collective, see relativeError()
+	PetscReal getRelativeError( PetscInt i ) const;
+
+	operator EPS() const { return _eps; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	ImplicitSVD( const ImplicitSVD& );
+	ImplicitSVD& operator=( const ImplicitSVD& );
+
+	void createShell( Mat A );
+	void destroyShell();
+
+	static PetscErrorCode precedes( EPS eps, PetscScalar ar, PetscScalar ai, PetscScalar br, PetscScalar bi, PetscInt* r, void* ctx );
+	static PetscErrorCode multCross( Mat shell, Vec x, Vec y );
+	static PetscErrorCode multCyclic( Mat shell, Vec x, Vec y );
+
+    private:
+	MPI_Comm _comm;
+	Formulation _formulation;
+	PetscReal _aspectRatio;
+	PetscReal _target;
+	PetscReal _shift;
+	EPS _eps;
+
+	Formulation _used;
+	PetscTruth _right;
+	Mat _A;
+	Mat _shell;
+	Vec _work;
+	Vec _xu;
+	Vec _xv;
+	Vec _yu;
+	Vec _yv;
+	Vec _x;
+	PetscInt _m;
+	PetscInt _n;
+
+	std::vector< PetscInt > _index;
+	std::vector< PetscReal > _sigma;
+	PetscInt _products;
+    };
+}
+
+#endif // !_slepc_cxx_ImplicitSVD_h
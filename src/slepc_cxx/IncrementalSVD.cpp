@@ -0,0 +1,174 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <petscblaslapack.h>
+
+#include "CholeskyQR.h"
+#include "IncrementalSVD.h"
+
+namespace slepc_cxx
+{
+    IncrementalSVD::IncrementalSVD( PetscInt rank /*= 10*/, PetscInt blockSize /*= 64*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _rank(rank), _blockSize(blockSize),
+	  _N(0), _n(0), _first(0), _rows(0), _batches(0), _shifted(0), _dropped(0)
+    {}
+
+    void IncrementalSVD::reset()
+    {
+	_N = _n = _first = _rows = _batches = _shifted = 0;
+	_V.clear();
+	_sigma.clear();
+	_dropped = 0;
+    }
+
+    void IncrementalSVD::update( Mat B )
+    {
+	PetscInt M, N, n, first, row, c, i, j, ncols;
+	const PetscInt* cols;
+	const PetscScalar* vals;
+	Mat BT;
+
+	MatGetSize( B, &M, &N );
+	MatGetLocalSize( B, PETSC_NULL, &n );
+	MatGetOwnershipRangeColumn( B, &first, PETSC_NULL );
+
+	if ( !_rows )
+	    {
+		_N = N;
+		_n = n;
+		_first = first;
+	    }
+	else if ( N != _N || n != _n || first != _first )
+	    {
+		throw std::runtime_error( "IncrementalSVD: the batch does not have the column layout of the previous ones" );
+	    }
+
+	// the local rows of B^T are the local entries of the columns of B^H, read
+	// block after block from a cursor since their column indices are sorted
+	MatTranspose( B, MAT_INITIAL_MATRIX, &BT );
+	std::vector< PetscInt > next( _n, 0 );
+
+	for ( row = 0; row < M; row += c )
+	    {
+		c = PetscMin( PetscMin( _blockSize, M - row ), PetscMax( _N - (PetscInt)_sigma.size(), 1 ) );
+
+		std::vector< PetscScalar > E( _n * c, 0.0 );
+		for ( i = 0; i < _n; ++i )
+		    {
+			MatGetRow( BT, _first + i, &ncols, &cols, &vals );
+			for ( j = next[i]; j < ncols && cols[j] < row + c; ++j ) { E[i+(cols[j]-row)*_n] = PetscConj( vals[j] ); }
+			next[i] = j;
+			MatRestoreRow( BT, _first + i, &ncols, &cols, &vals );
+		    }
+		fold( E, c );
+	    }
+
+	MatDestroy( BT );
+	_rows += M;
+	++_batches;
+    }
+
+    void IncrementalSVD::fold( std::vector< PetscScalar >& E, PetscInt c )
+    {
+	PetscInt r = _sigma.size(), p = c, i, j, pass;
+	PetscBLASInt bn = _n, br = r, bc = c, ld = PetscMax( _n, 1 );
+	PetscScalar one = 1.0, zero = 0.0, mone = -1.0;
+	std::vector< PetscScalar > C( r * c, 0.0 ), local( r * c ), D( r * c ), R;
+	PetscReal norms[2] = { 0, 0 }, sums[2];
+
+	for ( i = 0; i < _n * c; ++i ) { norms[0] += PetscRealPart( PetscConj( E[i] ) * E[i] ); }
+
+	// E = V C + P with P orthogonal to V, classical Gram-Schmidt run twice
+	for ( pass = 0; pass < 2 && r > 0; ++pass )
+	    {
+		std::fill( local.begin(), local.end(), 0.0 );
+		if ( _n > 0 ) { BLASgemm_( "C", "N", &br, &bc, &bn, &one, &_V[0], &ld, &E[0], &ld, &zero, &local[0], &br ); }
+		MPI_Allreduce( &local[0], &D[0], r * c, MPIU_SCALAR, MPIU_SUM, _comm );
+		if ( _n > 0 ) { BLASgemm_( "N", "N", &bn, &bc, &br, &mone, &_V[0], &ld, &D[0], &br, &one, &E[0], &ld ); }
+		for ( i = 0; i < r * c; ++i ) { C[i] += D[i]; }
+	    }
+
+	for ( i = 0; i < _n * c; ++i ) { norms[1] += PetscRealPart( PetscConj( E[i] ) * E[i] ); }
+	MPI_Allreduce( norms, sums, 2, MPIU_REAL, MPI_SUM, _comm );
+
+	// rows already in the span of V bring no new direction
+	if ( sums[1] <= PETSC_MACHINE_EPSILON * PETSC_MACHINE_EPSILON * sums[0] ) { p = 0; }
+	else { _shifted += choleskyQR( _comm, E, _n, c, R ); }
+
+	// K = [S 0; C^H R^H], (r + c) x (r + p)
+	PetscInt m = r + c, q = r + p, k = PetscMin( _rank, q );
+	std::vector< PetscScalar > K( m * q, 0.0 ), VT( q * q ), W( _n * q );
+	for ( j = 0; j < r; ++j ) { K[j+j*m] = _sigma[j]; }
+	for ( i = 0; i < c; ++i )
+	    {
+		for ( j = 0; j < r; ++j ) { K[r+i+j*m] = PetscConj( C[j+i*r] ); }
+		for ( j = 0; j < p; ++j ) { K[r+i+(r+j)*m] = PetscConj( R[j+i*c] ); }
+	    }
+
+	PetscBLASInt bm = m, bq = q, bk = k, ldu = 1, lwork = 5 * ( m + q ), info;
+	std::vector< PetscScalar > work( lwork );
+	std::vector< PetscReal > s( q ), rwork( 5 * q );
+	PetscScalar dummy;
+#ifndef PETSC_USE_COMPLEX
+	LAPACKgesvd_( "N", "S", &bm, &bq, &K[0], &bm, &s[0], &dummy, &ldu, &VT[0], &bq, &work[0], &lwork, &info );
+#else
+	LAPACKgesvd_( "N", "S", &bm, &bq, &K[0], &bm, &s[0], &dummy, &ldu, &VT[0], &bq, &work[0], &lwork, &rwork[0], &info );
+#endif
+	if ( info ) { throw std::runtime_error( "IncrementalSVD: xGESVD failed" ); }
+
+	// V = [V J] VT^H, leading k columns
+	std::copy( _V.begin(), _V.end(), W.begin() );
+	if ( p ) { std::copy( E.begin(), E.end(), W.begin() + _n * r ); }
+	_V.assign( _n * k, 0.0 );
+	if ( _n > 0 && k > 0 ) { BLASgemm_( "N", "C", &bn, &bk, &bq, &one, &W[0], &ld, &VT[0], &bq, &zero, &_V[0], &ld ); }
+
+	for ( j = k; j < q; ++j ) { _dropped += s[j] * s[j]; }
+	_sigma.assign( s.begin(), s.begin() + k );
+    }
+
+    void IncrementalSVD::getSingularTriplet( PetscInt i, PetscReal* sigma, Vec v /*= PETSC_NULL*/ ) const
+    {
+	PetscScalar* p;
+	PetscInt k;
+
+	*sigma = _sigma[i];
+	if ( v )
+	    {
+		VecGetArray( v, &p );
+		for ( k = 0; k < _n; ++k ) { p[k] = _V[k+i*_n]; }
+		VecRestoreArray( v, &p );
+	    }
+    }
+
+    PetscReal IncrementalSVD::truncationError() const
+    {
+	return std::sqrt( _dropped );
+    }
+
+    void IncrementalSVD::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Incremental SVD: rank %d, blocks of %d rows\n",_rank,_blockSize);
+	PetscPrintf(_comm," %d rows in %d batches, %d singular values, truncation error %g, %d shifted Cholesky QR\n\n",
+		    _rows,_batches,(PetscInt)_sigma.size(),truncationError(),_shifted);
+    }
+}
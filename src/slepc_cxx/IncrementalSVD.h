@@ -0,0 +1,99 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_IncrementalSVD_h
+#define _slepc_cxx_IncrementalSVD_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Rank-k truncated SVD A ~ U S V^H of a matrix that arrives as a stream
+     * of row batches, none of them being kept.
+     *
+     * Each batch B is folded in blocks of at most blockSize rows: the part of
+     * B^H outside the current right subspace is orthogonalised against V
+     * twice and factored as J R by Cholesky QR, so that
+     *
+     *   [U S V^H; B] = [U 0; 0 I] [S 0; C^H R^H] [V J]^H,  C = V^H B^H
+     *
+     * and the SVD of the small middle matrix rotates [V J] into the new right
+     * vectors, of which only the leading k are kept. The memory is that of V
+     * and of one block, n (k + blockSize) local entries whatever the number of
+     * rows; the left vectors are not stored since they grow with the stream.
+     * The singular values dropped by the truncations are accumulated in
+     * truncationError().
+     */
+    class IncrementalSVD : public core_library::Printable
+    {
+    public:
+	IncrementalSVD( PetscInt rank = 10, PetscInt blockSize = 64, MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// collective, B has the column layout of the previous batches
+	void update( Mat B );
+
+	// forgets the rows ingested so far
+	void reset();
+
+	void setRank( PetscInt rank ) { _rank = rank; }
+	void setBlockSize( PetscInt blockSize ) { _blockSize = blockSize; }
+
+	// global number of rows ingested
+	PetscInt rows() const { return _rows; }
+
+	PetscInt getConverged() const { return _sigma.size(); }
+
+	// in decreasing order, v with the column layout of the batches may be PETSC_NULL
+	void getSingularTriplet( PetscInt i, PetscReal* sigma, Vec v = PETSC_NULL ) const;
+
+	// Frobenius norm of the singular values dropped so far
+	PetscReal truncationError() const;
+
+	void printOn(std::ostream&) const;
+
+    private:
+	IncrementalSVD( const IncrementalSVD& );
+	IncrementalSVD& operator=( const IncrementalSVD& );
+
+	// folds the c rows whose conjugates are the columns of E
+	void fold( std::vector< PetscScalar >& E, PetscInt c );
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _rank;
+	PetscInt _blockSize;
+
+	PetscInt _N;
+	PetscInt _n;
+	PetscInt _first;
+	PetscInt _rows;
+	PetscInt _batches;
+	PetscInt _shifted;
+	std::vector< PetscScalar > _V;
+	std::vector< PetscReal > _sigma;
+	PetscReal _dropped;
+    };
+}
+
+#endif // !_slepc_cxx_IncrementalSVD_h
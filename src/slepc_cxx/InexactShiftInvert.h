@@ -0,0 +1,145 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_InexactShiftInvert_h
+#define _slepc_cxx_InexactShiftInvert_h
+
+#include <slepceps.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    // minTolerance of InexactShiftInvert taken as a tenth of the outer tolerance
+    const PetscReal InexactOuterTolerance = -1.0;
+
+    /*
+     * Adaptive inner tolerance for KSP based spectral transformations.
+     *
+     * The outer solver reports the residual estimates of its Ritz pairs at
+     * every restart; the inner KSP relative tolerance is then set to
+     * factor * (smallest unconverged residual), clamped to [min, max]. Early
+     * restarts are therefore solved loosely and the inner solves tighten as
+     * the Ritz pairs converge. The tolerance never increases during a solve,
+     * and the lower bound defaults to a tenth of the outer tolerance so the
+     * final accuracy is the one of the exact shift-and-invert; it is never
+     * below the machine epsilon. The relative tolerance the KSP had before
+     * start() is given back by finish().
+     */
+    class InexactShiftInvert : public core_library::Printable
+    {
+    public:
+	InexactShiftInvert( PetscReal factor = 1e-2, PetscReal maxTolerance = 1e-2, PetscReal minTolerance = InexactOuterTolerance )
+	    : _factor(factor), _maxTolerance(maxTolerance), _minTolerance(minTolerance), _lowerBound(minTolerance),
+	      _ksp(PETSC_NULL), _saved(0), _tolerance(maxTolerance), _enabled(PETSC_FALSE), _updates(0)
+	{}
+
+	// registers the residual monitor, to be called once per EPS
+	void attach( EPS eps )
+	{
+	    EPSMonitorSet( eps, &InexactShiftInvert::monitor, this, PETSC_NULL );
+	}
+
+	// called by EPSolver before each solve with the KSP of the transformation
+	void start( EPS eps, KSP ksp )
+	{
+	    PetscReal tol;
+
+	    _ksp = ksp;
+	    _updates = 0;
+	    _tolerance = _maxTolerance;
+
+	    EPSGetTolerances( eps, &tol, PETSC_NULL );
+	    _lowerBound = ( _minTolerance < 0 ) ? 0.1 * tol : _minTolerance;
+	    _lowerBound = PetscMax( _lowerBound, PETSC_MACHINE_EPSILON );
+
+	    KSPGetTolerances( _ksp, &_saved, PETSC_NULL, PETSC_NULL, PETSC_NULL );
+	    KSPSetTolerances( _ksp, _tolerance, PETSC_DEFAULT, PETSC_DEFAULT, PETSC_DEFAULT );
+	}
+
+	// called by EPSolver after each solve, the KSP is left with the tolerance it had
+	void finish()
+	{
+	    if ( !_ksp ) { return; }
+	    KSPSetTolerances( _ksp, _saved, PETSC_DEFAULT, PETSC_DEFAULT, PETSC_DEFAULT );
+	    _ksp = PETSC_NULL;
+	}
+
+	void setEnabled( PetscTruth enabled ) { _enabled = enabled; }
+	PetscTruth enabled() const { return _enabled; }
+
+	void setFactor( PetscReal factor ) { _factor = factor; }
+	void setTolerances( PetscReal minTolerance, PetscReal maxTolerance )
+	{
+	    _minTolerance = minTolerance;
+	    _maxTolerance = maxTolerance;
+	}
+
+	PetscReal tolerance() const { return _tolerance; }
+	PetscInt updates() const { return _updates; }
+
+	void printOn(std::ostream&) const
+	{
+	    PetscPrintf(PETSC_COMM_WORLD," Inexact inner solves: %s, factor=%g, current rtol=%g after %d updates\n\n",
+			_enabled ? "on" : "off",_factor,_tolerance,_updates);
+	}
+
+    private:
+	static PetscErrorCode monitor( EPS /*eps*/, PetscInt /*its*/, PetscInt nconv, PetscScalar* /*eigr*/, PetscScalar* /*eigi*/,
+				       PetscReal* errest, PetscInt nest, void* ctx )
+	{
+	    InexactShiftInvert* self = static_cast< InexactShiftInvert* >( ctx );
+	    PetscErrorCode ierr;
+	    PetscReal residual = self->_maxTolerance / self->_factor, tolerance;
+	    PetscInt i;
+
+	    PetscFunctionBegin;
+	    if ( !self->_enabled || !self->_ksp || nconv >= nest ) { PetscFunctionReturn(0); }
+
+	    for ( i = nconv; i < nest; ++i )
+		{
+		    residual = PetscMin( residual, errest[i] );
+		}
+
+	    tolerance = PetscMax( self->_lowerBound, PetscMin( self->_maxTolerance, self->_factor * residual ) );
+
+	    if ( tolerance < self->_tolerance )
+		{
+		    self->_tolerance = tolerance;
+		    ++self->_updates;
+		    ierr = KSPSetTolerances( self->_ksp, tolerance, PETSC_DEFAULT, PETSC_DEFAULT, PETSC_DEFAULT );CHKERRQ(ierr);
+		}
+	    PetscFunctionReturn(0);
+	}
+
+    private:
+	PetscReal _factor;
+	PetscReal _maxTolerance;
+	PetscReal _minTolerance;
+	PetscReal _lowerBound;
+
+	KSP _ksp;
+	PetscReal _saved;
+	PetscReal _tolerance;
+	PetscTruth _enabled;
+	PetscInt _updates;
+    };
+}
+
+#endif // !_slepc_cxx_InexactShiftInvert_h
@@ -0,0 +1,157 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <stdexcept>
+
+#include "KroneckerSum.h"
+
+namespace slepc_cxx
+{
+    KroneckerSum::KroneckerSum( PetscInt n1, PetscInt lower1, PetscInt upper1, PetscInt n2, PetscInt lower2, PetscInt upper2, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _n1(n1), _lower1(lower1), _upper1(upper1), _n2(n2), _lower2(lower2), _upper2(upper2),
+	  _first1(0), _m1(PETSC_DECIDE), _shell(PETSC_NULL), _products(0)
+    {
+	PetscInt last, room, fewest;
+
+	PetscSplitOwnership( _comm, &_m1, &_n1 );
+
+	// the exchange of mult only reaches the neighbour ranks
+	room = _m1 - PetscMax( _lower1, _upper1 );
+	MPI_Allreduce( &room, &fewest, 1, MPIU_INT, MPI_MIN, _comm );
+	if ( fewest < 0 ) { throw std::runtime_error( "KroneckerSum: a rank owns fewer columns than the bandwidth of T1" ); }
+
+	MPI_Scan( &_m1, &last, 1, MPIU_INT, MPI_SUM, _comm );
+	_first1 = last - _m1;
+	_T1.assign( ( _lower1 + _upper1 + 1 ) * _n1, 0.0 );
+	_T2.assign( ( _lower2 + _upper2 + 1 ) * _n2, 0.0 );
+	_halo.assign( ( _lower1 + _m1 + _upper1 ) * _n2, 0.0 );
+
+	MatCreateShell( _comm, _m1 * _n2, _m1 * _n2, _n1 * _n2, _n1 * _n2, this, &_shell );
+	MatShellSetOperation( _shell, MATOP_MULT, (void(*)(void))mult );
+	MatShellSetOperation( _shell, MATOP_GET_DIAGONAL, (void(*)(void))getDiagonal );
+    }
+
+    KroneckerSum::~KroneckerSum()
+    {
+	if ( _shell ) { MatDestroy( _shell ); }
+    }
+
+    void KroneckerSum::setValue( PetscInt factor, PetscInt i, PetscInt j, PetscScalar value )
+    {
+	PetscInt n = factor ? _n2 : _n1, lower = factor ? _lower2 : _lower1, upper = factor ? _upper2 : _upper1, d = j - i;
+
+	if ( i < 0 || i >= n || j < 0 || j >= n || d < -lower || d > upper )
+	    {
+		throw std::runtime_error( "KroneckerSum: entry outside the band of the factor" );
+	    }
+	( factor ? _T2 : _T1 )[(d+lower)*n+i] = value;
+    }
+
+    void KroneckerSum::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Kronecker sum: %d x %d grid, factor bands %d+%d and %d+%d, %d scalars stored, products: %d\n\n",
+		    _n1,_n2,_lower1,_upper1,_lower2,_upper2,storage(),_products);
+    }
+
+    PetscErrorCode KroneckerSum::mult( Mat shell, Vec x, Vec y )
+    {
+	KroneckerSum* self;
+	PetscScalar *px, *py;
+	PetscMPIInt rank, size, prev, next;
+	MPI_Status status;
+	PetscInt c, r, d, rlo, rhi, j;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+
+	const PetscInt n1 = self->_n1, n2 = self->_n2, m1 = self->_m1;
+	const PetscInt lower1 = self->_lower1, upper1 = self->_upper1, lower2 = self->_lower2, upper2 = self->_upper2;
+	PetscScalar* h = &self->_halo[0];
+
+	ierr = VecGetArray( x, &px );CHKERRQ(ierr);
+	for ( r = 0; r < m1 * n2; ++r ) { h[lower1*n2+r] = px[r]; }
+	ierr = VecRestoreArray( x, &px );CHKERRQ(ierr);
+
+	// the halo columns outside 0..n1-1 are never received and stay zero
+	MPI_Comm_rank( self->_comm, &rank );
+	MPI_Comm_size( self->_comm, &size );
+	prev = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+	next = rank < size - 1 ? rank + 1 : MPI_PROC_NULL;
+	if ( upper1 ) { MPI_Sendrecv( h + lower1 * n2, upper1 * n2, MPIU_SCALAR, prev, 0, h + ( lower1 + m1 ) * n2, upper1 * n2, MPIU_SCALAR, next, 0, self->_comm, &status ); }
+	if ( lower1 ) { MPI_Sendrecv( h + m1 * n2, lower1 * n2, MPIU_SCALAR, next, 1, h, lower1 * n2, MPIU_SCALAR, prev, 1, self->_comm, &status ); }
+
+	ierr = VecGetArray( y, &py );CHKERRQ(ierr);
+	for ( c = 0; c < m1; ++c )
+	    {
+		PetscScalar* yc = py + c * n2;
+		const PetscScalar* xc = h + ( lower1 + c ) * n2;
+
+		// column c of T2 X, diagonal by diagonal
+		for ( r = 0; r < n2; ++r ) { yc[r] = 0.0; }
+		for ( d = -lower2; d <= upper2; ++d )
+		    {
+			const PetscScalar* a = &self->_T2[(d+lower2)*n2];
+			rlo = PetscMax( 0, -d );
+			rhi = PetscMin( n2, n2 - d );
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+			for ( r = rlo; r < rhi; ++r ) { yc[r] += a[r] * xc[r+d]; }
+		    }
+
+		// column c of X T1^T, the neighbour columns of X scaled by row j of T1
+		j = self->_first1 + c;
+		for ( d = -lower1; d <= upper1; ++d )
+		    {
+			const PetscScalar t = self->_T1[(d+lower1)*n1+j];
+			const PetscScalar* xd = xc + d * n2;
+			if ( t == 0.0 ) { continue; }
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+			for ( r = 0; r < n2; ++r ) { yc[r] += t * xd[r]; }
+		    }
+	    }
+	ierr = VecRestoreArray( y, &py );CHKERRQ(ierr);
+	++self->_products;
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode KroneckerSum::getDiagonal( Mat shell, Vec d )
+    {
+	KroneckerSum* self;
+	PetscScalar* p;
+	PetscInt c, r;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = VecGetArray( d, &p );CHKERRQ(ierr);
+	for ( c = 0; c < self->_m1; ++c )
+	    {
+		for ( r = 0; r < self->_n2; ++r )
+		    {
+			p[c*self->_n2+r] = self->_T1[self->_lower1*self->_n1+self->_first1+c] + self->_T2[self->_lower2*self->_n2+r];
+		    }
+	    }
+	ierr = VecRestoreArray( d, &p );CHKERRQ(ierr);
+	PetscFunctionReturn(0);
+    }
+}
@@ -0,0 +1,98 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_KroneckerSum_h
+#define _slepc_cxx_KroneckerSum_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Shell operator A = T1 (x) I + I (x) T2 of order n1 n2, from two banded
+     * factors T1 of order n1 and T2 of order n2, as the 2-D Laplacian is the
+     * Kronecker sum of two 1-D ones. Only the factors are stored, O(n1 + n2)
+     * scalars on every rank instead of O(n1 n2) for the assembled matrix.
+     *
+     * Row i1 n2 + i2 of A is the grid point (i1, i2): with x reshaped as the
+     * n2 x n1 column-major X, A x is T2 X + X T1^T. The ranks own whole
+     * columns of X, T2 X is then a banded product over each local column and
+     * X T1^T adds neighbour columns scaled by the entries of T1, both with
+     * unit stride; only the lower1 and upper1 columns next to a rank boundary
+     * are exchanged. Every rank needs at least max(lower1, upper1) columns.
+     *
+     * The shell provides the product and the diagonal.
+     */
+    class KroneckerSum : public core_library::Printable
+    {
+    public:
+	// collective, both factors zero, columns of X spread as PetscSplitOwnership
+	KroneckerSum( PetscInt n1, PetscInt lower1, PetscInt upper1, PetscInt n2, PetscInt lower2, PetscInt upper2, MPI_Comm comm = PETSC_COMM_WORLD );
+
+	~KroneckerSum();
+
+	// every rank sets the whole factor, 0 for T1 and 1 for T2, j within its band
+	void setValue( PetscInt factor, PetscInt i, PetscInt j, PetscScalar value );
+
+	PetscInt size() const { return _n1 * _n2; }
+
+	// scalars stored for the operator on each rank
+	PetscInt storage() const { return _T1.size() + _T2.size(); }
+
+	operator Mat() const { return _shell; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	KroneckerSum( const KroneckerSum& );
+	KroneckerSum& operator=( const KroneckerSum& );
+
+	static PetscErrorCode mult( Mat shell, Vec x, Vec y );
+	static PetscErrorCode getDiagonal( Mat shell, Vec d );
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _n1;
+	PetscInt _lower1;
+	PetscInt _upper1;
+	PetscInt _n2;
+	PetscInt _lower2;
+	PetscInt _upper2;
+
+	// the local columns of X, first1 to first1 + m1 - 1
+	PetscInt _first1;
+	PetscInt _m1;
+
+	// entry (i, i + d) at T[(d + lower) * n + i], as BandedMatrix
+	std::vector< PetscScalar > _T1;
+	std::vector< PetscScalar > _T2;
+
+	// the local columns of X, widened by lower1 columns before and upper1 after
+	mutable std::vector< PetscScalar > _halo;
+
+	Mat _shell;
+	PetscInt _products;
+    };
+}
+
+#endif // !_slepc_cxx_KroneckerSum_h
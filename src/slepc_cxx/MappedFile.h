@@ -0,0 +1,86 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_MappedFile_h
+#define _slepc_cxx_MappedFile_h
+
+#include <string>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Read-only mapping of a whole file, pages are only faulted in when touched.
+     */
+    class MappedFile
+    {
+    public:
+	MappedFile( const std::string& path ) : _data(NULL), _size(0), _modified(0)
+	{
+	    struct stat st;
+	    int fd = open( path.c_str(), O_RDONLY );
+	    if ( fd < 0 ) { throw std::runtime_error( "MappedFile: cannot open " + path ); }
+	    if ( fstat( fd, &st ) < 0 ) { close( fd ); throw std::runtime_error( "MappedFile: cannot stat " + path ); }
+	    _size = st.st_size;
+	    _modified = st.st_mtime;
+	    if ( _size == 0 ) { close( fd ); return; }
+	    void* data = mmap( NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	    close( fd );
+	    if ( data == MAP_FAILED ) { throw std::runtime_error( "MappedFile: cannot map " + path ); }
+	    _data = static_cast< const char* >( data );
+	}
+
+	~MappedFile() { if ( _data ) { munmap( (void*)_data, _size ); } }
+
+	static bool exists( const std::string& path )
+	{
+	    struct stat st;
+	    return stat( path.c_str(), &st ) == 0;
+	}
+
+	// hints the kernel to read ahead [begin, end)
+	void willNeed( size_t begin, size_t end ) const
+	{
+	    size_t page = sysconf( _SC_PAGESIZE );
+	    begin -= begin % page;
+	    if ( _data && end > begin ) { madvise( (void*)( _data + begin ), end - begin, MADV_WILLNEED ); }
+	}
+
+	const char* data() const { return _data; }
+	size_t size() const { return _size; }
+
+	// last modification, in seconds since the epoch
+	long long modified() const { return _modified; }
+
+    private:
+	MappedFile( const MappedFile& );
+	MappedFile& operator=( const MappedFile& );
+
+	const char* _data;
+	size_t _size;
+	long long _modified;
+    };
+}
+
+#endif // !_slepc_cxx_MappedFile_h
@@ -0,0 +1,176 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <vector>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "MarkovModel.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	/*
+	 * Grid points (i, j), 1 <= i <= m and 1 <= j <= m - i + 1, are numbered
+	 * along j first. Walks the rows of a contiguous range in that order.
+	 */
+	class GridWalker
+	{
+	public:
+	    GridWalker( PetscInt m, long long row ) : _m(m), _cst( 0.5 / (PetscReal)( m - 1 ) )
+	    {
+		PetscInt lo = 1, hi = m;
+
+		// last i whose first row is not after row
+		while ( lo < hi )
+		    {
+			PetscInt mid = ( lo + hi + 1 ) / 2;
+			if ( first( mid ) <= row ) { lo = mid; }
+			else { hi = mid - 1; }
+		    }
+		_i = lo;
+		_j = row - first( _i ) + 1;
+		_jmax = m - _i + 1;
+	    }
+
+	    void next()
+	    {
+		if ( ++_j > _jmax )
+		    {
+			++_i;
+			_j = 1;
+			_jmax = _m - _i + 1;
+		    }
+	    }
+
+	    PetscInt nonzeros() const { return ( _j != _jmax ? 2 : 0 ) + ( _j > 1 ) + ( _i > 1 ); }
+
+	    // writes the row k in increasing column order, returns the number of entries
+	    PetscInt fill( PetscInt k, PetscInt* cols, PetscScalar* vals ) const
+	    {
+		PetscReal pu = 0.5 - _cst * (PetscReal)( _i + _j - 3 );
+		PetscInt n = 0;
+
+		if ( _i > 1 ) { cols[n] = k - _jmax - 1; vals[n++] = pu; }	// west
+		if ( _j > 1 ) { cols[n] = k - 1; vals[n++] = pu; }		// south
+		if ( _j != _jmax )
+		    {
+			PetscReal pd = _cst * (PetscReal)( _i + _j - 1 );
+			cols[n] = k + 1; vals[n++] = _i == 1 ? 2 * pd : pd;		// north
+			cols[n] = k + _jmax; vals[n++] = _j == 1 ? 2 * pd : pd;	// east
+		    }
+		return n;
+	    }
+
+	private:
+	    // 0-based row of (i, 1)
+	    long long first( PetscInt i ) const { return (long long)( i - 1 ) * ( _m + 1 ) - (long long)( i - 1 ) * i / 2; }
+
+	    PetscInt _m;
+	    PetscReal _cst;
+	    PetscInt _i;
+	    PetscInt _j;
+	    PetscInt _jmax;
+	};
+
+	void threadRange( PetscInt m, PetscInt* begin, PetscInt* end )
+	{
+#ifdef _OPENMP
+	    PetscInt threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+	    PetscInt threads = 1, thread = 0;
+#endif
+	    *begin = ( (long long)m * thread ) / threads;
+	    *end = ( (long long)m * ( thread + 1 ) ) / threads;
+	}
+    }
+
+    MarkovModel::MarkovModel( PetscInt m, MPI_Comm comm /*= PETSC_COMM_WORLD*/ ) : _comm(comm), _m(m) {}
+
+    PetscInt MarkovModel::size() const
+    {
+	long long n = (long long)_m * ( _m + 1 ) / 2;
+	if ( n > PETSC_MAX_INT ) { throw std::runtime_error( "MarkovModel: m (m + 1) / 2 states do not fit in PetscInt" ); }
+	return (PetscInt)n;
+    }
+
+    void MarkovModel::assemble( Mat A ) const
+    {
+	PetscInt M, N, m, n, rstart, rend, k;
+	const MatType type;
+
+	MatGetSize( A, &M, &N );
+	MatGetLocalSize( A, &m, &n );
+	if ( m < 0 ) { m = PETSC_DECIDE; PetscSplitOwnership( _comm, &m, &M ); }
+	MPI_Scan( &m, &rend, 1, MPIU_INT, MPI_SUM, _comm );
+	rstart = rend - m;
+
+	std::vector< PetscInt > ia( m + 1, 0 );
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+	    PetscInt begin, end, r;
+	    threadRange( m, &begin, &end );
+	    if ( begin < end )
+		{
+		    GridWalker walker( _m, rstart + begin );
+		    for ( r = begin; r < end; ++r, walker.next() ) { ia[r+1] = walker.nonzeros(); }
+		}
+	}
+
+	for ( k = 0; k < m; ++k ) { ia[k+1] += ia[k]; }
+
+	std::vector< PetscInt > ja( ia[m] + 1 );
+	std::vector< PetscScalar > a( ia[m] + 1 );
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+	    PetscInt begin, end, r;
+	    threadRange( m, &begin, &end );
+	    if ( begin < end )
+		{
+		    GridWalker walker( _m, rstart + begin );
+		    for ( r = begin; r < end; ++r, walker.next() ) { walker.fill( rstart + r, &ja[ ia[r] ], &a[ ia[r] ] ); }
+		}
+	}
+
+	MatGetType( A, &type );
+	if ( !type ) { MatSetType( A, MATAIJ ); }
+
+	// only the call matching the actual type has an effect, both assemble A
+	MatSeqAIJSetPreallocationCSR( A, &ia[0], &ja[0], &a[0] );
+	MatMPIAIJSetPreallocationCSR( A, &ia[0], &ja[0], &a[0] );
+    }
+
+    void MarkovModel::create( Mat* A ) const
+    {
+	MatCreate( _comm, A );
+	MatSetSizes( *A, PETSC_DECIDE, PETSC_DECIDE, size(), size() );
+	MatSetFromOptions( *A );
+	assemble( *A );
+    }
+}
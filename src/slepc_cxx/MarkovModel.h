@@ -0,0 +1,57 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_MarkovModel_h
+#define _slepc_cxx_MarkovModel_h
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Markov model of a random walk on a triangular grid with m subdivisions
+     * in each dimension (G. W. Stewart, TR-514, University of Maryland, 1978),
+     * as generated by MatMarkovModel in the SLEPc examples: the operator is the
+     * transpose of the transition matrix, its rightmost eigenvalue is 1.
+     *
+     * Each rank maps its first row back to its grid point and only walks its
+     * own rows, the local CSR arrays are filled by the OpenMP threads and
+     * handed to PETSc in one call with exact preallocation.
+     */
+    class MarkovModel
+    {
+    public:
+	MarkovModel( PetscInt m, MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// m (m + 1) / 2, throws when it does not fit in PetscInt
+	PetscInt size() const;
+
+	// A must be sized (see size()) but neither preallocated nor filled
+	void assemble( Mat A ) const;
+
+	// collective, creates and fills a matrix of the default layout
+	void create( Mat* A ) const;
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _m;
+    };
+}
+
+#endif // !_slepc_cxx_MarkovModel_h
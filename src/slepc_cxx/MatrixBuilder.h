@@ -0,0 +1,317 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_MatrixBuilder_h
+#define _slepc_cxx_MatrixBuilder_h
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <climits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Coordinate (i, j, v) assembly with exact preallocation.
+     *
+     * Each OpenMP thread appends to its own buffer, so add() can be called from
+     * a parallel region without locking once prepare() has sized the buffers to
+     * its team; a thread without a buffer appends to a shared one in a critical
+     * section. assemble() sends every triplet to the rank owning its row, sorts
+     * them by (row, column), sums duplicates, counts the diagonal and
+     * off-diagonal nonzeros of each local row, preallocates the matrix with
+     * these exact counts and inserts one sorted row at a time.
+     */
+    class MatrixBuilder
+    {
+    public:
+	struct Triplet
+	{
+	    Triplet() {}
+	    Triplet( PetscInt i_, PetscInt j_, PetscScalar v_ ) : i(i_), j(j_), v(v_) {}
+
+	    bool operator<( const Triplet& t ) const { return i < t.i || ( i == t.i && j < t.j ); }
+
+	    PetscInt i;
+	    PetscInt j;
+	    PetscScalar v;
+	};
+
+	// buffer 0 is the shared one, thread t appends to buffer t + 1
+	MatrixBuilder( MPI_Comm comm = PETSC_COMM_WORLD ) : _comm(comm), _buffers( 2 ) {}
+
+	/*
+	 * Called by every thread of a parallel region before its first add(),
+	 * it makes room for the team of the region. It is a worksharing construct
+	 * and ends with a barrier.
+	 */
+	void prepare()
+	{
+#ifdef _OPENMP
+#pragma omp single
+	    if ( _buffers.size() < (size_t)omp_get_num_threads() + 1 ) { _buffers.resize( omp_get_num_threads() + 1 ); }
+#endif
+	}
+
+	void add( PetscInt i, PetscInt j, PetscScalar v )
+	{
+	    size_t t = thread() + 1;
+	    if ( t < _buffers.size() )
+		{
+		    _buffers[t].push_back( Triplet( i, j, v ) );
+		    return;
+		}
+#ifdef _OPENMP
+#pragma omp critical(slepc_cxx_MatrixBuilder)
+#endif
+	    _buffers[0].push_back( Triplet( i, j, v ) );
+	}
+
+	// reserves room for n triplets in the buffer of every thread
+	void reserve( size_t n )
+	{
+	    for ( size_t t = 0; t < _buffers.size(); ++t ) { _buffers[t].reserve( n ); }
+	}
+
+	size_t size() const
+	{
+	    size_t n = 0;
+	    for ( size_t t = 0; t < _buffers.size(); ++t ) { n += _buffers[t].size(); }
+	    return n;
+	}
+
+	void clear()
+	{
+	    for ( size_t t = 0; t < _buffers.size(); ++t ) { std::vector< Triplet >().swap( _buffers[t] ); }
+	}
+
+	/*
+	 * A must be sized but neither preallocated nor filled. Duplicated entries
+	 * are summed. The buffers are released once the values are inserted.
+	 */
+	void assemble( Mat A )
+	{
+	    PetscMPIInt size, rank;
+	    PetscInt M, N, m, n, rstart, cstart, cend, k;
+	    const MatType type;
+
+	    MPI_Comm_size( _comm, &size );
+	    MPI_Comm_rank( _comm, &rank );
+
+	    localSizes( A, &M, &N, &m, &n );
+
+	    std::vector< PetscInt > rows( size + 1, 0 );
+	    std::vector< PetscInt > cols( size + 1, 0 );
+	    MPI_Allgather( &m, 1, MPIU_INT, &rows[1], 1, MPIU_INT, _comm );
+	    MPI_Allgather( &n, 1, MPIU_INT, &cols[1], 1, MPIU_INT, _comm );
+	    for ( k = 0; k < size; ++k )
+		{
+		    rows[k+1] += rows[k];
+		    cols[k+1] += cols[k];
+		}
+	    rstart = rows[rank];
+	    cstart = cols[rank];
+	    cend = cols[rank+1];
+
+	    std::vector< Triplet > local;
+	    exchange( rows, local );
+	    std::sort( local.begin(), local.end() );
+	    merge( local );
+
+	    std::vector< PetscInt > dnnz( m, 0 );
+	    std::vector< PetscInt > onnz( m, 0 );
+	    for ( size_t t = 0; t < local.size(); ++t )
+		{
+		    if ( local[t].j >= cstart && local[t].j < cend ) { ++dnnz[ local[t].i - rstart ]; }
+		    else { ++onnz[ local[t].i - rstart ]; }
+		}
+
+	    MatGetType( A, &type );
+	    if ( !type ) { MatSetType( A, MATAIJ ); }
+
+	    // only the call matching the actual type has an effect
+	    MatSeqAIJSetPreallocation( A, 0, m ? &dnnz[0] : PETSC_NULL );
+	    MatMPIAIJSetPreallocation( A, 0, m ? &dnnz[0] : PETSC_NULL, 0, m ? &onnz[0] : PETSC_NULL );
+
+	    std::vector< PetscInt > j;
+	    std::vector< PetscScalar > v;
+	    size_t begin = 0;
+	    while ( begin < local.size() )
+		{
+		    size_t end = begin;
+		    PetscInt i = local[begin].i;
+		    j.clear();
+		    v.clear();
+		    while ( end < local.size() && local[end].i == i )
+			{
+			    j.push_back( local[end].j );
+			    v.push_back( local[end].v );
+			    ++end;
+			}
+		    MatSetValues( A, 1, &i, (PetscInt)j.size(), &j[0], &v[0], INSERT_VALUES );
+		    begin = end;
+		}
+
+	    MatAssemblyBegin( A, MAT_FINAL_ASSEMBLY );
+	    MatAssemblyEnd( A, MAT_FINAL_ASSEMBLY );
+	}
+
+	/*
+	 * Rows owned by this rank once A is preallocated. Unlike
+	 * MatGetOwnershipRange it does not trigger the default preallocation.
+	 */
+	void ownershipRange( Mat A, PetscInt* rstart, PetscInt* rend ) const
+	{
+	    PetscInt M, N, m, n;
+
+	    localSizes( A, &M, &N, &m, &n );
+	    MPI_Scan( &m, rend, 1, MPIU_INT, MPI_SUM, _comm );
+	    *rstart = *rend - m;
+	}
+
+    private:
+	void localSizes( Mat A, PetscInt* M, PetscInt* N, PetscInt* m, PetscInt* n ) const
+	{
+	    MatGetSize( A, M, N );
+	    MatGetLocalSize( A, m, n );
+	    if ( *m < 0 ) { *m = PETSC_DECIDE; PetscSplitOwnership( _comm, m, M ); }
+	    if ( *n < 0 ) { *n = PETSC_DECIDE; PetscSplitOwnership( _comm, n, N ); }
+	}
+
+	/*
+	 * Sends every buffered triplet to the owner of its row and empties the
+	 * buffers. The rows and the int counts and displacements of
+	 * MPI_Alltoallv are checked on every rank before anything is sent.
+	 */
+	void exchange( const std::vector< PetscInt >& rows, std::vector< Triplet >& local )
+	{
+	    PetscMPIInt size = rows.size() - 1, p;
+	    std::vector< PetscMPIInt > scounts( size, 0 ), rcounts( size ), sdispls( size + 1, 0 ), rdispls( size + 1, 0 );
+	    long long bad = 0, total = 0, failed;
+
+	    for ( size_t t = 0; t < _buffers.size(); ++t )
+		{
+		    for ( size_t e = 0; e < _buffers[t].size(); ++e )
+			{
+			    if ( _buffers[t][e].i < 0 || _buffers[t][e].i >= rows[size] ) { ++bad; }
+			}
+		    total += _buffers[t].size();
+		}
+	    MPI_Allreduce( &bad, &failed, 1, MPI_LONG_LONG_INT, MPI_SUM, _comm );
+	    if ( failed ) { throw std::runtime_error( "MatrixBuilder: row index out of range" ); }
+	    agree( total > INT_MAX );
+
+	    for ( size_t t = 0; t < _buffers.size(); ++t )
+		{
+		    for ( size_t e = 0; e < _buffers[t].size(); ++e ) { ++scounts[ owner( rows, _buffers[t][e].i ) ]; }
+		}
+	    MPI_Alltoall( &scounts[0], 1, MPI_INT, &rcounts[0], 1, MPI_INT, _comm );
+
+	    total = 0;
+	    for ( p = 0; p < size; ++p ) { total += rcounts[p]; }
+	    agree( total > INT_MAX );
+
+	    for ( p = 0; p < size; ++p )
+		{
+		    sdispls[p+1] = sdispls[p] + scounts[p];
+		    rdispls[p+1] = rdispls[p] + rcounts[p];
+		}
+
+	    std::vector< PetscInt > si( sdispls[size] ), sj( sdispls[size] ), ri( rdispls[size] ), rj( rdispls[size] );
+	    std::vector< PetscScalar > sv( sdispls[size] ), rv( rdispls[size] );
+	    std::vector< PetscMPIInt > offset( sdispls.begin(), sdispls.end() - 1 );
+
+	    for ( size_t t = 0; t < _buffers.size(); ++t )
+		{
+		    for ( size_t e = 0; e < _buffers[t].size(); ++e )
+			{
+			    const Triplet& x = _buffers[t][e];
+			    PetscMPIInt o = offset[ owner( rows, x.i ) ]++;
+			    si[o] = x.i;
+			    sj[o] = x.j;
+			    sv[o] = x.v;
+			}
+		}
+	    clear();
+
+	    PetscInt* psi = si.empty() ? PETSC_NULL : &si[0];
+	    PetscInt* psj = sj.empty() ? PETSC_NULL : &sj[0];
+	    PetscScalar* psv = sv.empty() ? PETSC_NULL : &sv[0];
+	    PetscInt* pri = ri.empty() ? PETSC_NULL : &ri[0];
+	    PetscInt* prj = rj.empty() ? PETSC_NULL : &rj[0];
+	    PetscScalar* prv = rv.empty() ? PETSC_NULL : &rv[0];
+
+	    MPI_Alltoallv( psi, &scounts[0], &sdispls[0], MPIU_INT, pri, &rcounts[0], &rdispls[0], MPIU_INT, _comm );
+	    MPI_Alltoallv( psj, &scounts[0], &sdispls[0], MPIU_INT, prj, &rcounts[0], &rdispls[0], MPIU_INT, _comm );
+	    MPI_Alltoallv( psv, &scounts[0], &sdispls[0], MPIU_SCALAR, prv, &rcounts[0], &rdispls[0], MPIU_SCALAR, _comm );
+
+	    local.resize( ri.size() );
+	    for ( size_t e = 0; e < ri.size(); ++e ) { local[e] = Triplet( ri[e], rj[e], rv[e] ); }
+	}
+
+	// sums consecutive duplicates of a sorted vector
+	static void merge( std::vector< Triplet >& local )
+	{
+	    if ( local.empty() ) { return; }
+
+	    size_t last = 0;
+	    for ( size_t e = 1; e < local.size(); ++e )
+		{
+		    if ( local[e].i == local[last].i && local[e].j == local[last].j ) { local[last].v += local[e].v; }
+		    else { local[++last] = local[e]; }
+		}
+	    local.resize( last + 1 );
+	}
+
+	// throws on every rank when one of them has too many triplets for an int count
+	void agree( bool overflow ) const
+	{
+	    int local = overflow ? 1 : 0, any;
+	    MPI_Allreduce( &local, &any, 1, MPI_INT, MPI_MAX, _comm );
+	    if ( any ) { throw std::runtime_error( "MatrixBuilder: more than INT_MAX triplets for one rank, MPI_Alltoallv counts are int" ); }
+	}
+
+	static PetscMPIInt owner( const std::vector< PetscInt >& rows, PetscInt i )
+	{
+	    if ( i < 0 || i >= rows.back() ) { throw std::runtime_error( "MatrixBuilder: row index out of range" ); }
+	    return std::upper_bound( rows.begin(), rows.end(), i ) - rows.begin() - 1;
+	}
+
+	static int thread()
+	{
+#ifdef _OPENMP
+	    return omp_get_thread_num();
+#else
+	    return 0;
+#endif
+	}
+
+    private:
+	MPI_Comm _comm;
+	std::vector< std::vector< Triplet > > _buffers;
+    };
+}
+
+#endif // !_slepc_cxx_MatrixBuilder_h
@@ -0,0 +1,209 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MatrixLoader.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	const PetscInt IndexCookie = 0x534c4959;
+
+	// PETSc binary files are big-endian
+	bool littleEndian()
+	{
+	    int one = 1;
+	    return *(char*)&one == 1;
+	}
+
+	template < typename T >
+	T readBigEndian( const char* p )
+	{
+	    T value;
+	    char* q = (char*)&value;
+	    if ( littleEndian() )
+		{
+		    for ( size_t k = 0; k < sizeof(T); ++k ) { q[k] = p[sizeof(T)-1-k]; }
+		}
+	    else
+		{
+		    memcpy( q, p, sizeof(T) );
+		}
+	    return value;
+	}
+
+	PetscScalar readScalar( const char* p )
+	{
+#ifdef PETSC_USE_COMPLEX
+	    return PetscScalar( readBigEndian< PetscReal >( p ), readBigEndian< PetscReal >( p + sizeof(PetscReal) ) );
+#else
+	    return readBigEndian< PetscReal >( p );
+#endif
+	}
+
+	struct Header
+	{
+	    Header( const MappedFile& file )
+	    {
+		if ( file.size() < 4 * sizeof(PetscInt) ) { throw std::runtime_error( "MatrixLoader: truncated header" ); }
+		PetscInt cookie = readBigEndian< PetscInt >( file.data() );
+		if ( cookie != MAT_FILE_COOKIE ) { throw std::runtime_error( "MatrixLoader: not a PETSc binary matrix" ); }
+		M = readBigEndian< PetscInt >( file.data() + sizeof(PetscInt) );
+		N = readBigEndian< PetscInt >( file.data() + 2 * sizeof(PetscInt) );
+		nz = readBigEndian< PetscInt >( file.data() + 3 * sizeof(PetscInt) );
+		if ( file.size() < offsetValues( nz ) ) { throw std::runtime_error( "MatrixLoader: truncated file" ); }
+	    }
+
+	    size_t offsetRowLengths( PetscInt i ) const { return ( 4 + i ) * sizeof(PetscInt); }
+	    size_t offsetColumns( long long k ) const { return ( 4 + M + k ) * sizeof(PetscInt); }
+	    size_t offsetValues( long long k ) const { return offsetColumns( nz ) + k * sizeof(PetscScalar); }
+
+	    PetscInt M, N, nz;
+	};
+
+	// nonzero offset of row i, O(stride) with an index, O(i) without
+	long long rowOffset( const MappedFile& file, const Header& header, const std::string& path, PetscInt i )
+	{
+	    long long offset = 0;
+	    PetscInt first = 0, r;
+
+	    std::ifstream index( MatrixLoader::indexPath( path ).c_str(), std::ios::binary );
+	    if ( index )
+		{
+		    PetscInt cookie, M, stride;
+		    long long size, modified, nz;
+		    index.read( (char*)&cookie, sizeof(PetscInt) );
+		    index.read( (char*)&M, sizeof(PetscInt) );
+		    index.read( (char*)&stride, sizeof(PetscInt) );
+		    index.read( (char*)&size, sizeof(long long) );
+		    index.read( (char*)&modified, sizeof(long long) );
+		    index.read( (char*)&nz, sizeof(long long) );
+		    // an index written for another version of the file is ignored
+		    if ( index && cookie == IndexCookie && M == header.M && size == (long long)file.size()
+			 && modified == file.modified() && nz == header.nz && stride > 0 )
+			{
+			    index.seekg( ( i / stride ) * sizeof(long long), std::ios::cur );
+			    index.read( (char*)&offset, sizeof(long long) );
+			    if ( index ) { first = ( i / stride ) * stride; }
+			    else { offset = 0; }
+			}
+		}
+
+	    for ( r = first; r < i; ++r )
+		{
+		    offset += readBigEndian< PetscInt >( file.data() + header.offsetRowLengths( r ) );
+		}
+	    return offset;
+	}
+    }
+
+    MatrixLoader::MatrixLoader( MPI_Comm comm /*= PETSC_COMM_WORLD*/ ) : _comm(comm) {}
+
+    void MatrixLoader::load( const std::string& path, Mat* A, PetscInt m /*= PETSC_DECIDE*/, PetscInt n /*= PETSC_DECIDE*/ ) const
+    {
+	std::auto_ptr< MappedFile > file;
+	std::auto_ptr< Header > header;
+	std::string error;
+	PetscInt rend, rstart, i, length;
+	long long k, begin;
+
+	// every rank maps the file itself, they agree on the outcome before any collective call
+	try
+	    {
+		file.reset( new MappedFile( path ) );
+		header.reset( new Header( *file ) );
+	    }
+	catch ( std::runtime_error& e ) { error = e.what(); }
+	agree( error, path );
+
+	PetscSplitOwnership( _comm, &m, &header->M );
+	PetscSplitOwnership( _comm, &n, &header->N );
+	MPI_Scan( &m, &rend, 1, MPIU_INT, MPI_SUM, _comm );
+	rstart = rend - m;
+
+	std::vector< PetscInt > ia( m + 1, 0 );
+	for ( i = 0; i < m && error.empty(); ++i )
+	    {
+		length = readBigEndian< PetscInt >( file->data() + header->offsetRowLengths( rstart + i ) );
+		if ( length < 0 || length > header->N ) { error = "MatrixLoader: invalid row length in " + path; }
+		else { ia[i+1] = ia[i] + length; }
+	    }
+
+	begin = error.empty() ? rowOffset( *file, *header, path, rstart ) : 0;
+	if ( error.empty() && ( begin < 0 || begin + ia[m] > header->nz ) ) { error = "MatrixLoader: row lengths exceed the number of nonzeros in " + path; }
+	if ( !error.empty() ) { ia.assign( m + 1, 0 ); }
+
+	file->willNeed( header->offsetColumns( begin ), header->offsetColumns( begin + ia[m] ) );
+	file->willNeed( header->offsetValues( begin ), header->offsetValues( begin + ia[m] ) );
+
+	std::vector< PetscInt > ja( ia[m] );
+	std::vector< PetscScalar > a( ia[m] );
+	for ( k = 0; k < ia[m]; ++k )
+	    {
+		ja[k] = readBigEndian< PetscInt >( file->data() + header->offsetColumns( begin + k ) );
+		a[k] = readScalar( file->data() + header->offsetValues( begin + k ) );
+		if ( ja[k] < 0 || ja[k] >= header->N ) { error = "MatrixLoader: column out of range in " + path; }
+	    }
+	agree( error, path );
+
+	MatCreateMPIAIJWithArrays( _comm, m, n, header->M, header->N, &ia[0],
+				   ja.empty() ? PETSC_NULL : &ja[0], a.empty() ? PETSC_NULL : &a[0], A );
+    }
+
+    void MatrixLoader::agree( const std::string& error, const std::string& path ) const
+    {
+	int failed = error.empty() ? 0 : 1, any;
+
+	MPI_Allreduce( &failed, &any, 1, MPI_INT, MPI_MAX, _comm );
+	if ( failed ) { throw std::runtime_error( error ); }
+	if ( any ) { throw std::runtime_error( "MatrixLoader: " + path + " could not be read on another rank" ); }
+    }
+
+    void MatrixLoader::writeIndex( const std::string& path, PetscInt stride /*= 4096*/ )
+    {
+	MappedFile file( path );
+	Header header( file );
+	long long offset = 0, size = file.size(), modified = file.modified(), nz = header.nz;
+	PetscInt i;
+
+	std::ofstream index( indexPath( path ).c_str(), std::ios::binary );
+	if ( !index ) { throw std::runtime_error( "MatrixLoader: cannot write " + indexPath( path ) ); }
+
+	index.write( (const char*)&IndexCookie, sizeof(PetscInt) );
+	index.write( (const char*)&header.M, sizeof(PetscInt) );
+	index.write( (const char*)&stride, sizeof(PetscInt) );
+	index.write( (const char*)&size, sizeof(long long) );
+	index.write( (const char*)&modified, sizeof(long long) );
+	index.write( (const char*)&nz, sizeof(long long) );
+
+	for ( i = 0; i < header.M; ++i )
+	    {
+		if ( i % stride == 0 ) { index.write( (const char*)&offset, sizeof(long long) ); }
+		offset += readBigEndian< PetscInt >( file.data() + header.offsetRowLengths( i ) );
+	    }
+	index.write( (const char*)&offset, sizeof(long long) );
+    }
+}
@@ -0,0 +1,65 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_MatrixLoader_h
+#define _slepc_cxx_MatrixLoader_h
+
+#include <string>
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Parallel loader of PETSc binary AIJ files.
+     *
+     * Instead of MatLoad, which reads everything on rank 0 and scatters it,
+     * every rank memory-maps the file and copies only the row lengths, column
+     * indices and values of its own row block, so the I/O is spread over all
+     * the ranks. The position of a row block inside the file is the prefix sum
+     * of the row lengths: it is read from the "<file>.index" companion when it
+     * exists and matches the size, the modification time and the number of
+     * nonzeros of the file (see writeIndex), otherwise the row lengths before
+     * the block are summed.
+     *
+     * A file that cannot be read on some rank makes every rank throw.
+     */
+    class MatrixLoader
+    {
+    public:
+	MatrixLoader( MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// collective, the local sizes follow PETSC_DECIDE unless given
+	void load( const std::string& path, Mat* A, PetscInt m = PETSC_DECIDE, PetscInt n = PETSC_DECIDE ) const;
+
+	// writes the nonzero offset of every stride-th row next to the file
+	static void writeIndex( const std::string& path, PetscInt stride = 4096 );
+
+	static std::string indexPath( const std::string& path ) { return path + ".index"; }
+
+    private:
+	// collective, throws on every rank when error is set on any of them
+	void agree( const std::string& error, const std::string& path ) const;
+
+    private:
+	MPI_Comm _comm;
+    };
+}
+
+#endif // !_slepc_cxx_MatrixLoader_h
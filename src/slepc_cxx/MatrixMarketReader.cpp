@@ -0,0 +1,259 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cstdio>
+#include <cctype>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "MappedFile.h"
+#include "MatrixBuilder.h"
+#include "MatrixLoader.h"
+#include "MatrixMarketReader.h"
+#include "TextParsing.h"
+
+namespace slepc_cxx
+{
+    using namespace text;
+
+    namespace
+    {
+	// the hash only depends on the content, not on the number of ranks or threads
+	const size_t HashChunk = 1 << 24;
+
+	unsigned long long fnv1a( const char* p, size_t n, unsigned long long h = 14695981039346656037ULL )
+	{
+	    for ( size_t k = 0; k < n; ++k )
+		{
+		    h ^= (unsigned char)p[k];
+		    h *= 1099511628211ULL;
+		}
+	    return h;
+	}
+
+	struct Banner
+	{
+	    Banner() : pattern(false), complex(false), symmetric(false), hermitian(false), skew(false), M(0), N(0), data(0) {}
+
+	    bool pattern;
+	    bool complex;
+	    bool symmetric;
+	    bool hermitian;
+	    bool skew;
+	    PetscInt M;
+	    PetscInt N;
+	    size_t data;
+	};
+
+	Banner readBanner( const MappedFile& file )
+	{
+	    const char* p = file.data();
+	    size_t end = file.size(), k = nextLine( p, 0, end );
+	    Banner banner;
+
+	    std::string line( p, k );
+	    for ( size_t c = 0; c < line.size(); ++c ) { line[c] = tolower( line[c] ); }
+	    if ( line.compare( 0, 14, "%%matrixmarket" ) != 0 || line.find( "coordinate" ) == std::string::npos )
+		{
+		    throw std::runtime_error( "MatrixMarketReader: only coordinate Matrix Market files are supported" );
+		}
+	    banner.pattern = line.find( "pattern" ) != std::string::npos;
+	    banner.complex = line.find( "complex" ) != std::string::npos;
+	    banner.skew = line.find( "skew-symmetric" ) != std::string::npos;
+	    banner.hermitian = line.find( "hermitian" ) != std::string::npos;
+	    banner.symmetric = banner.skew || banner.hermitian || line.find( "symmetric" ) != std::string::npos;
+
+#ifndef PETSC_USE_COMPLEX
+	    if ( banner.complex ) { throw std::runtime_error( "MatrixMarketReader: complex entries need a complex PETSc build" ); }
+#endif
+
+	    // comments, then the size line
+	    while ( k < end && ( p[k] == '%' || p[k] == '\n' || p[k] == '\r' ) ) { k = nextLine( p, k, end ); }
+
+	    const char* q = p + k;
+	    long long M, N, nz;
+	    if ( !parseInteger( q, p + end, M ) || !parseInteger( q, p + end, N ) || !parseInteger( q, p + end, nz ) )
+		{
+		    throw std::runtime_error( "MatrixMarketReader: invalid size line" );
+		}
+	    banner.M = M;
+	    banner.N = N;
+	    banner.data = nextLine( p, q - p, end );
+	    return banner;
+	}
+
+	// the number of entries that could not be read or lie outside the matrix, which are left out
+	long long parseLines( const char* data, size_t begin, size_t end, const Banner& banner, MatrixBuilder& builder )
+	{
+	    const char* p = data + begin;
+	    const char* last = data + end;
+	    long long i, j, bad = 0;
+	    PetscReal re, im;
+
+	    while ( p < last )
+		{
+		    p = skipBlanks( p, last );
+		    if ( p < last && *p != '%' && *p != '\n' )
+			{
+			    re = 1.0;
+			    im = 0.0;
+			    if ( !parseInteger( p, last, i ) || !parseInteger( p, last, j )
+				 || ( !banner.pattern && !parseReal( p, last, re ) )
+				 || ( banner.complex && !parseReal( p, last, im ) )
+				 || i < 1 || i > banner.M || j < 1 || j > banner.N )
+				{
+				    ++bad;
+				}
+			    else
+				{
+#ifdef PETSC_USE_COMPLEX
+				    PetscScalar v = PetscScalar( re, im );
+#else
+				    PetscScalar v = re;
+#endif
+				    builder.add( i - 1, j - 1, v );
+				    if ( banner.symmetric && i != j ) { builder.add( j - 1, i - 1, banner.skew ? -v : ( banner.hermitian ? PetscConj( v ) : v ) ); }
+				}
+			}
+		    while ( p < last && *p != '\n' ) { ++p; }
+		    ++p;
+		}
+	    return bad;
+	}
+    }
+
+    MatrixMarketReader::MatrixMarketReader( MPI_Comm comm /*= PETSC_COMM_WORLD*/ ) : _comm(comm) {}
+
+    void MatrixMarketReader::load( const std::string& path, Mat* A, PetscTruth cache /*= PETSC_TRUE*/ ) const
+    {
+	if ( !cache )
+	    {
+		parse( path, A );
+		return;
+	    }
+
+	std::string binary = cachePath( path );
+	PetscMPIInt rank;
+	int found = 0;
+
+	MPI_Comm_rank( _comm, &rank );
+	if ( !rank ) { found = MappedFile::exists( binary ); }
+	MPI_Bcast( &found, 1, MPI_INT, 0, _comm );
+
+	if ( found )
+	    {
+		MatrixLoader( _comm ).load( binary, A );
+		return;
+	    }
+
+	parse( path, A );
+
+	// written under a temporary name so that an interrupted run leaves no partial cache
+	std::string tmp = binary + ".tmp";
+	PetscViewer viewer;
+	PetscViewerBinaryOpen( _comm, tmp.c_str(), FILE_MODE_WRITE, &viewer );
+	MatView( *A, viewer );
+	PetscViewerDestroy( viewer );
+
+	if ( !rank )
+	    {
+		MatrixLoader::writeIndex( tmp );
+		rename( MatrixLoader::indexPath( tmp ).c_str(), MatrixLoader::indexPath( binary ).c_str() );
+		rename( tmp.c_str(), binary.c_str() );
+		remove( ( tmp + ".info" ).c_str() );
+	    }
+	MPI_Barrier( _comm );
+    }
+
+    void MatrixMarketReader::parse( const std::string& path, Mat* A ) const
+    {
+	MappedFile file( path );
+	Banner banner = readBanner( file );
+	MatrixBuilder builder( _comm );
+	PetscMPIInt size, rank;
+
+	MPI_Comm_size( _comm, &size );
+	MPI_Comm_rank( _comm, &rank );
+
+	const char* data = file.data();
+	size_t begin, end;
+	slice( data, banner.data, file.size(), rank, size, &begin, &end );
+
+	file.willNeed( begin, end );
+
+	long long bad = 0, total;
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:bad)
+#endif
+	{
+#ifdef _OPENMP
+	    size_t threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+	    size_t threads = 1, thread = 0;
+#endif
+	    size_t b, e;
+	    slice( data, begin, end, thread, threads, &b, &e );
+	    builder.prepare();
+	    bad += parseLines( data, b, e, banner, builder );
+	}
+
+	// agreed on by all the ranks before they enter the assembly
+	MPI_Allreduce( &bad, &total, 1, MPI_LONG_LONG_INT, MPI_SUM, _comm );
+	if ( total ) { throw std::runtime_error( "MatrixMarketReader: unreadable or out of range entries in " + path ); }
+
+	MatCreate( _comm, A );
+	MatSetSizes( *A, PETSC_DECIDE, PETSC_DECIDE, banner.M, banner.N );
+	MatSetFromOptions( *A );
+	builder.assemble( *A );
+    }
+
+    std::string MatrixMarketReader::cachePath( const std::string& path ) const
+    {
+	MappedFile file( path );
+	PetscMPIInt size, rank;
+	long long chunks = ( file.size() + HashChunk - 1 ) / HashChunk, c;
+
+	MPI_Comm_size( _comm, &size );
+	MPI_Comm_rank( _comm, &rank );
+
+	// every rank hashes its share of the chunks, the chunk hashes are then hashed
+	std::vector< unsigned long long > local( chunks + 1, 0 ), hashes( chunks + 1, 0 );
+	long long cbegin = ( chunks * rank ) / size, cend = ( chunks * ( rank + 1 ) ) / size;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for ( c = cbegin; c < cend; ++c )
+	    {
+		size_t offset = c * HashChunk;
+		local[c] = fnv1a( file.data() + offset, PetscMin( HashChunk, file.size() - offset ) );
+	    }
+
+	MPI_Allreduce( &local[0], &hashes[0], chunks + 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, _comm );
+	hashes[chunks] = file.size();
+
+	char hex[17];
+	sprintf( hex, "%016llx", fnv1a( (const char*)&hashes[0], hashes.size() * sizeof(unsigned long long) ) );
+	return path + "." + hex + ".petsc";
+    }
+}
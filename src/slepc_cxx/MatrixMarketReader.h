@@ -0,0 +1,58 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_MatrixMarketReader_h
+#define _slepc_cxx_MatrixMarketReader_h
+
+#include <string>
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Reader of Matrix Market coordinate files (real, integer or pattern;
+     * general, symmetric or skew-symmetric).
+     *
+     * The text is memory-mapped and cut into byte ranges on line boundaries,
+     * one per rank and then one per OpenMP thread, each parsed independently
+     * into a MatrixBuilder. The first load() writes a PETSc binary copy named
+     * after a hash of the file content next to the input, later loads go
+     * through MatrixLoader on that copy.
+     */
+    class MatrixMarketReader
+    {
+    public:
+	MatrixMarketReader( MPI_Comm comm = PETSC_COMM_WORLD );
+
+	// collective, uses or writes the binary cache
+	void load( const std::string& path, Mat* A, PetscTruth cache = PETSC_TRUE ) const;
+
+	// collective, always parses the text
+	void parse( const std::string& path, Mat* A ) const;
+
+	// collective, "<path>.<content hash>.petsc"
+	std::string cachePath( const std::string& path ) const;
+
+    private:
+	MPI_Comm _comm;
+    };
+}
+
+#endif // !_slepc_cxx_MatrixMarketReader_h
@@ -0,0 +1,299 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+
+#include "MatrixBuilder.h"
+#include "MultilevelFiedler.h"
+
+namespace slepc_cxx
+{
+    MultilevelFiedler::MultilevelFiedler( PetscInt coarseSize /*= 1000*/, PetscInt smoothingSteps /*= 2*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _coarseSize(coarseSize), _smoothingSteps(smoothingSteps), _maxLevels(30), _time(0)
+    {}
+
+    MultilevelFiedler::~MultilevelFiedler() { destroyVectors(); }
+
+    void MultilevelFiedler::compute( Mat L, const std::vector< Vec >& nullspace, PetscInt nev /*= 1*/ )
+    {
+	PetscLogDouble t0, t1;
+	PetscInt N, Nc;
+	size_t l, t;
+
+	PetscGetTime(&t0);
+
+	destroyVectors();
+	_sizes.clear();
+	_coarseEigenvalues.clear();
+
+	// level l holds its operator and nullspace, prolongations[l] maps level l+1 to level l
+	std::vector< Mat > operators( 1, L ), prolongations;
+	std::vector< std::vector< Vec > > Z( 1, std::vector< Vec >( nullspace.size() ) );
+	for ( t = 0; t < nullspace.size(); ++t )
+	    {
+		VecDuplicate( nullspace[t], &Z[0][t] );
+		VecCopy( nullspace[t], Z[0][t] );
+	    }
+	orthonormalize( Z[0] );
+
+	MatGetSize( L, &N, PETSC_NULL );
+	_sizes.push_back( N );
+
+	while ( N > _coarseSize && (PetscInt)prolongations.size() < _maxLevels )
+	    {
+		Mat P, A;
+
+		prolongation( operators.back(), Z.back(), &P );
+		MatGetSize( P, PETSC_NULL, &Nc );
+
+		// the matching stalls once the ranks hold few connected rows
+		if ( Nc > 0.9 * N )
+		    {
+			MatDestroy( P );
+			break;
+		    }
+
+		MatPtAP( operators.back(), P, MAT_INITIAL_MATRIX, 1.0, &A );
+
+		std::vector< Vec > Zc( Z.back().size() );
+		for ( t = 0; t < Zc.size(); ++t )
+		    {
+			MatGetVecs( P, &Zc[t], PETSC_NULL );
+			MatMultTranspose( P, Z.back()[t], Zc[t] );
+		    }
+		orthonormalize( Zc );
+
+		prolongations.push_back( P );
+		operators.push_back( A );
+		Z.push_back( Zc );
+		N = Nc;
+		_sizes.push_back( N );
+	    }
+
+	solveCoarse( operators.back(), Z.back(), nev );
+
+	for ( l = prolongations.size(); l-- > 0; )
+	    {
+		for ( t = 0; t < _vectors.size(); ++t )
+		    {
+			Vec x;
+			MatGetVecs( prolongations[l], PETSC_NULL, &x );
+			MatMult( prolongations[l], _vectors[t], x );
+			VecDestroy( _vectors[t] );
+			_vectors[t] = x;
+			smooth( operators[l], Z[l], x );
+		    }
+		orthonormalize( _vectors );
+	    }
+
+	for ( l = 0; l < prolongations.size(); ++l )
+	    {
+		MatDestroy( prolongations[l] );
+		MatDestroy( operators[l+1] );
+	    }
+	for ( l = 0; l < Z.size(); ++l )
+	    {
+		for ( t = 0; t < Z[l].size(); ++t ) { VecDestroy( Z[l][t] ); }
+	    }
+
+	PetscGetTime(&t1);
+	_time = t1 - t0;
+    }
+
+    void MultilevelFiedler::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Multilevel initial space: %d levels, sizes",(PetscInt)_sizes.size());
+	for ( size_t l = 0; l < _sizes.size(); ++l ) { PetscPrintf(_comm," %d",_sizes[l]); }
+	PetscPrintf(_comm,"\n Coarse eigenvalues:");
+	for ( size_t t = 0; t < _coarseEigenvalues.size(); ++t ) { PetscPrintf(_comm," %g",_coarseEigenvalues[t]); }
+	PetscPrintf(_comm,"\n Setup time: %.3f s\n\n",_time);
+    }
+
+    // heavy-edge matching restricted to the local rows, no communication
+    void MultilevelFiedler::prolongation( Mat A, const std::vector< Vec >& Z, Mat* P ) const
+    {
+	PetscInt M, Nc, rstart, rend, cstart, cend, m, k, c, j, ncols, nc = 0;
+	const PetscInt* cols;
+	const PetscScalar* vals;
+	PetscScalar* z;
+	size_t t;
+
+	MatGetSize( A, &M, PETSC_NULL );
+	MatGetOwnershipRange( A, &rstart, &rend );
+	m = rend - rstart;
+
+	std::vector< PetscInt > aggregate( m, -1 ), sizes;
+	for ( k = 0; k < m; ++k )
+	    {
+		if ( aggregate[k] >= 0 ) { continue; }
+
+		PetscInt best = -1;
+		PetscReal heaviest = 0;
+		MatGetRow( A, rstart + k, &ncols, &cols, &vals );
+		for ( c = 0; c < ncols; ++c )
+		    {
+			j = cols[c] - rstart;
+			if ( j >= 0 && j < m && j != k && aggregate[j] < 0 && PetscAbsScalar( vals[c] ) > heaviest )
+			    {
+				heaviest = PetscAbsScalar( vals[c] );
+				best = j;
+			    }
+		    }
+		MatRestoreRow( A, rstart + k, &ncols, &cols, &vals );
+
+		aggregate[k] = nc;
+		if ( best >= 0 ) { aggregate[best] = nc; }
+		sizes.push_back( best >= 0 ? 2 : 1 );
+		++nc;
+	    }
+
+	// w = (sum_t |z_t|^2)^1/2, D^1/2 1 for a normalized Laplacian, and an aggregate that has no weight is constant
+	std::vector< PetscReal > w( m, 0.0 ), norms( nc, 0.0 );
+	for ( t = 0; t < Z.size(); ++t )
+	    {
+		VecGetArray( Z[t], &z );
+		for ( k = 0; k < m; ++k ) { w[k] += PetscRealPart( PetscConj( z[k] ) * z[k] ); }
+		VecRestoreArray( Z[t], &z );
+	    }
+	for ( k = 0; k < m; ++k )
+	    {
+		w[k] = std::sqrt( w[k] );
+		norms[ aggregate[k] ] += w[k] * w[k];
+	    }
+
+	MPI_Scan( &nc, &cend, 1, MPIU_INT, MPI_SUM, _comm );
+	MPI_Allreduce( &nc, &Nc, 1, MPIU_INT, MPI_SUM, _comm );
+	cstart = cend - nc;
+
+	MatCreate( _comm, P );
+	MatSetSizes( *P, m, nc, M, Nc );
+
+	MatrixBuilder builder( _comm );
+	for ( k = 0; k < m; ++k )
+	    {
+		PetscReal n = std::sqrt( norms[ aggregate[k] ] );
+		if ( n > 0 ) { builder.add( rstart + k, cstart + aggregate[k], w[k] / n ); }
+		else { builder.add( rstart + k, cstart + aggregate[k], 1.0 / std::sqrt( (PetscReal)sizes[ aggregate[k] ] ) ); }
+	    }
+	builder.assemble( *P );
+    }
+
+    void MultilevelFiedler::solveCoarse( Mat A, const std::vector< Vec >& Z, PetscInt nev )
+    {
+	PetscInt nconv, i;
+	PetscScalar kr, ki;
+	EPS eps;
+
+	EPSCreate( _comm, &eps );
+	EPSSetOptionsPrefix( eps, "coarse_" );
+	EPSSetOperators( eps, A, PETSC_NULL );
+	EPSSetProblemType( eps, EPS_HEP );
+	EPSSetType( eps, EPSKRYLOVSCHUR );
+	EPSSetWhichEigenpairs( eps, EPS_SMALLEST_REAL );
+	EPSSetDimensions( eps, nev, PETSC_DECIDE, PETSC_DECIDE );
+	if ( !Z.empty() ) { EPSSetDeflationSpace( eps, Z.size(), const_cast< Vec* >( &Z[0] ) ); }
+	EPSSetFromOptions( eps );
+	EPSSolve( eps );
+	EPSGetConverged( eps, &nconv );
+
+	for ( i = 0; i < PetscMin( nconv, nev ); ++i )
+	    {
+		Vec x;
+		MatGetVecs( A, PETSC_NULL, &x );
+		EPSGetEigenpair( eps, i, &kr, &ki, x, PETSC_NULL );
+		_vectors.push_back( x );
+		_coarseEigenvalues.push_back( PetscRealPart( kr ) );
+	    }
+
+	EPSDestroy( eps );
+    }
+
+    // damped Jacobi on (A - theta I) x = 0, theta being the Rayleigh quotient of x
+    void MultilevelFiedler::smooth( Mat A, const std::vector< Vec >& Z, Vec x ) const
+    {
+	const PetscReal omega = 2.0 / 3.0;
+	PetscScalar xAx, xx, c;
+	PetscScalar* p;
+	PetscInt s, i, n;
+	size_t t;
+	Vec d, y;
+
+	MatGetVecs( A, PETSC_NULL, &d );
+	VecDuplicate( x, &y );
+	MatGetDiagonal( A, d );
+
+	// an isolated vertex has a zero diagonal, its row of A is zero and the step leaves it unscaled
+	VecGetLocalSize( d, &n );
+	VecGetArray( d, &p );
+	for ( i = 0; i < n; ++i )
+	    {
+		if ( p[i] == 0.0 ) { p[i] = 1.0; }
+	    }
+	VecRestoreArray( d, &p );
+	VecReciprocal( d );
+
+	for ( s = 0; s < _smoothingSteps; ++s )
+	    {
+		MatMult( A, x, y );
+		VecDot( y, x, &xAx );
+		VecDot( x, x, &xx );
+		VecAXPY( y, -xAx / xx, x );
+		VecPointwiseMult( y, y, d );
+		VecAXPY( x, -omega, y );
+	    }
+
+	for ( t = 0; t < Z.size(); ++t )
+	    {
+		VecDot( x, Z[t], &c );
+		VecAXPY( x, -c, Z[t] );
+	    }
+	VecNormalize( x, PETSC_NULL );
+
+	VecDestroy( d );
+	VecDestroy( y );
+    }
+
+    void MultilevelFiedler::destroyVectors()
+    {
+	for ( size_t t = 0; t < _vectors.size(); ++t ) { VecDestroy( _vectors[t] ); }
+	_vectors.clear();
+    }
+
+    // modified Gram-Schmidt, the vectors that vanish are destroyed and dropped
+    void MultilevelFiedler::orthonormalize( std::vector< Vec >& V )
+    {
+	std::vector< Vec > kept;
+	PetscReal before, after;
+	PetscScalar c;
+
+	for ( size_t t = 0; t < V.size(); ++t )
+	    {
+		VecNorm( V[t], NORM_2, &before );
+		for ( size_t u = 0; u < kept.size(); ++u )
+		    {
+			VecDot( V[t], kept[u], &c );
+			VecAXPY( V[t], -c, kept[u] );
+		    }
+		VecNormalize( V[t], &after );
+		if ( after > 1e-10 * before ) { kept.push_back( V[t] ); }
+		else { VecDestroy( V[t] ); }
+	    }
+	V = kept;
+    }
+}
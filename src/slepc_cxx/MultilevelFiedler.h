@@ -0,0 +1,93 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_MultilevelFiedler_h
+#define _slepc_cxx_MultilevelFiedler_h
+
+#include <vector>
+
+#include <slepceps.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Initial space for the smallest nonzero eigenpairs of a graph Laplacian.
+     *
+     * Each level matches every local vertex with its heaviest unmatched local
+     * neighbour and maps the pairs through P, whose columns are the nullspace
+     * Z restricted to a pair and normalised (D^1/2 1 for a normalized
+     * Laplacian, constant for the combinatorial one). A pair never spans two
+     * connected components, so Z lies in the range of P: the coarse operator
+     * P^T L P is the Galerkin restriction of L and P^T Z its nullspace. Once
+     * the graph is small enough the coarse eigenvectors are computed (options
+     * prefix "coarse_"), then interpolated back level by level, each time
+     * followed by a few damped Jacobi steps on (L - theta I) x = 0 and an
+     * orthogonalisation against Z.
+     */
+    class MultilevelFiedler : public core_library::Printable
+    {
+    public:
+	MultilevelFiedler( PetscInt coarseSize = 1000, PetscInt smoothingSteps = 2, MPI_Comm comm = PETSC_COMM_WORLD );
+	~MultilevelFiedler();
+
+	// collective, nullspace may be empty, e.g. GraphLaplacian::nullspace()
+	void compute( Mat L, const std::vector< Vec >& nullspace, PetscInt nev = 1 );
+
+	// attaches the vectors of the last compute() as initial space of an EPSolver
+	template < typename Solver >
+	void initialize( Solver& eps ) const
+	{
+	    if ( _vectors.empty() ) { return; }
+	    eps.setInitialSpace( _vectors.size(), const_cast< Vec* >( &_vectors[0] ) );
+	}
+
+	const std::vector< Vec >& vectors() const { return _vectors; }
+
+	void setCoarseSize( PetscInt coarseSize ) { _coarseSize = coarseSize; }
+	void setSmoothingSteps( PetscInt smoothingSteps ) { _smoothingSteps = smoothingSteps; }
+	void setMaxLevels( PetscInt maxLevels ) { _maxLevels = maxLevels; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	MultilevelFiedler( const MultilevelFiedler& );
+	MultilevelFiedler& operator=( const MultilevelFiedler& );
+
+	void prolongation( Mat A, const std::vector< Vec >& Z, Mat* P ) const;
+	void solveCoarse( Mat A, const std::vector< Vec >& Z, PetscInt nev );
+	void smooth( Mat A, const std::vector< Vec >& Z, Vec x ) const;
+	void destroyVectors();
+
+	static void orthonormalize( std::vector< Vec >& V );
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _coarseSize;
+	PetscInt _smoothingSteps;
+	PetscInt _maxLevels;
+	std::vector< Vec > _vectors;
+	std::vector< PetscInt > _sizes;
+	std::vector< PetscReal > _coarseEigenvalues;
+	PetscLogDouble _time;
+    };
+}
+
+#endif // !_slepc_cxx_MultilevelFiedler_h
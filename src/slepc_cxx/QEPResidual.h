@@ -0,0 +1,79 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_QEPResidual_h
+#define _slepc_cxx_QEPResidual_h
+
+#include <cmath>
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    // collective, ||(k^2 M + k C + K) x|| / ||k x||, k = kr + i ki and x = xr + i xi in real arithmetic
+    inline PetscReal relativeError( Mat M, Mat C, Mat K, PetscScalar kr, PetscScalar ki, Vec xr, Vec xi )
+    {
+	PetscReal norm, nx, re, im = 0, xim = 0, ak = PetscAbsScalar( kr ), bk = PetscAbsScalar( ki );
+	Vec r, s;
+
+	VecDuplicate( xr, &r );
+	VecDuplicate( xr, &s );
+
+	// real part: K xr + C (kr xr - ki xi) + M (ar xr - ai xi), with k^2 = ar + i ai
+	MatMult( K, xr, r );
+	MatMult( C, xr, s );
+	VecAXPY( r, kr, s );
+	MatMult( M, xr, s );
+	VecAXPY( r, kr * kr - ki * ki, s );
+	if ( ki != 0.0 && xi )
+	    {
+		MatMult( C, xi, s );
+		VecAXPY( r, -ki, s );
+		MatMult( M, xi, s );
+		VecAXPY( r, -2.0 * kr * ki, s );
+	    }
+	VecNorm( r, NORM_2, &re );
+
+	// imaginary part: K xi + C (kr xi + ki xr) + M (ar xi + ai xr)
+	if ( ki != 0.0 && xi )
+	    {
+		MatMult( K, xi, r );
+		MatMult( C, xi, s );
+		VecAXPY( r, kr, s );
+		MatMult( C, xr, s );
+		VecAXPY( r, ki, s );
+		MatMult( M, xi, s );
+		VecAXPY( r, kr * kr - ki * ki, s );
+		MatMult( M, xr, s );
+		VecAXPY( r, 2.0 * kr * ki, s );
+		VecNorm( r, NORM_2, &im );
+		VecNorm( xi, NORM_2, &xim );
+	    }
+
+	VecNorm( xr, NORM_2, &nx );
+	norm = std::sqrt( ak * ak + bk * bk ) * std::sqrt( nx * nx + xim * xim );
+
+	VecDestroy( r );
+	VecDestroy( s );
+
+	return std::sqrt( re * re + im * im ) / ( norm > 0 ? norm : 1 );
+    }
+}
+
+#endif // !_slepc_cxx_QEPResidual_h
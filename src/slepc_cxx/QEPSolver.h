@@ -0,0 +1,211 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_QEPSolver_h
+#define _slepc_cxx_QEPSolver_h
+
+#include <string>
+
+#include <slepcqep.h>
+
+#include <core_library/Printable.h>
+
+#include "CompactQEP.h"
+
+namespace slepc_cxx
+{
+    /*
+     * Quadratic eigenpairs (l^2 M + l C + K) x = 0 from the SLEPc QEP object
+     * (set up with the -qep_ options), or from CompactQEP once setCompact()
+     * is called, with the dimensions and tolerances of the QEP object. The
+     * options are read at the first solve, after the caller's own settings.
+     * A problem type set with -qep_hermitian or -qep_gyroscopic selects the
+     * matching structure of CompactQEP for that solve only, the one given to
+     * compact().setStructure() is used again by the next one. After
+     * setTarget() the problem type is ignored by the compact mode.
+     */
+    template < typename Atom >
+    class QEPSolver : public core_library::Printable
+    {
+    public:
+	enum Mode { Krylov, Compact };
+
+	QEPSolver( QEPType type = QEPLINEAR, MPI_Comm comm = PETSC_COMM_WORLD )
+	    : _mode(Krylov), _compactQEP(CompactQEP::Automatic, comm), _configured(PETSC_FALSE)
+	{
+	    QEPCreate( comm, &_solver );
+	    QEPSetType( _solver, type );
+	}
+
+	~QEPSolver()
+	{
+	    QEPDestroy( _solver );
+	}
+
+	void solve( Mat M, Mat C, Mat K )
+	{
+	    PetscInt nev, ncv, maxit;
+	    PetscReal tol;
+	    QEPProblemType type;
+
+	    // here rather than in the constructor, so that -qep_hermitian overrides QEPSetProblemType
+	    if ( !_configured )
+		{
+		    QEPSetFromOptions( _solver );
+		    _configured = PETSC_TRUE;
+		}
+
+	    if ( _mode == Compact )
+		{
+		    CompactQEP::Structure requested = _compactQEP.requestedStructure();
+		    // the shifted problem (P(sigma), C + 2 sigma M, M) does not keep the problem type
+		    QEPGetProblemType( _solver, &type );
+		    if ( !_compactQEP.shifted() && type == QEP_HERMITIAN ) { _compactQEP.setStructure( CompactQEP::Symmetric ); }
+		    else if ( !_compactQEP.shifted() && type == QEP_GYROSCOPIC ) { _compactQEP.setStructure( CompactQEP::Gyroscopic ); }
+		    QEPGetDimensions( _solver, &nev, &ncv, PETSC_NULL );
+		    QEPGetTolerances( _solver, &tol, &maxit );
+		    try
+			{
+			    _compactQEP.solve( M, C, K, nev, ncv > 0 ? ncv : PETSC_DECIDE, tol > 0 ? tol : 1e-8, maxit > 0 ? maxit : 100 );
+			}
+		    catch ( ... )
+			{
+			    _compactQEP.setStructure( requested );
+			    throw;
+			}
+		    _compactQEP.setStructure( requested );
+		    return;
+		}
+	    QEPSetOperators( _solver, M, C, K );
+	    QEPSolve( _solver );
+	}
+
+	// Krylov-Schur on the companion linearization, never assembled, with a basis of n-vectors
+	void setCompact( PetscTruth flag = PETSC_TRUE ) { _mode = flag ? Compact : Krylov; }
+
+	Mode mode() const { return _mode; }
+
+	// eigenvalues nearest to sigma: QEPLINEAR assembles the 2n x 2n linearization for its
+	// shift-and-invert ST, the compact mode only assembles and factorises P(sigma) = sigma^2 M + sigma C + K
+	void setTarget( PetscScalar sigma )
+	{
+	    const QEPType type;
+	    EPS eps;
+	    ST st;
+
+	    _compactQEP.setShift( sigma );
+	    QEPGetType( _solver, &type );
+	    if ( std::string( type ) != QEPLINEAR ) { return; }
+	    QEPLinearSetExplicitMatrix( _solver, PETSC_TRUE );
+	    QEPLinearGetEPS( _solver, &eps );
+	    EPSGetST( eps, &st );
+	    STSetType( st, STSINVERT );
+	    STSetShift( st, sigma );
+	    EPSSetTarget( eps, sigma );
+	    EPSSetWhichEigenpairs( eps, EPS_TARGET_MAGNITUDE );
+	}
+
+	CompactQEP& compact() { return _compactQEP; }
+
+	PetscInt getConverged() const
+	{
+	    PetscInt nconv;
+	    if ( _mode == Compact ) { return _compactQEP.getConverged(); }
+	    QEPGetConverged( _solver, &nconv );
+	    return nconv;
+	}
+
+	void getEigenpair( PetscInt i, PetscScalar* kr, PetscScalar* ki, Vec xr = PETSC_NULL, Vec xi = PETSC_NULL ) const
+	{
+	    if ( _mode == Compact ) { _compactQEP.getEigenpair( i, kr, ki, xr, xi ); }
+	    else { QEPGetEigenpair( _solver, i, kr, ki, xr, xi ); }
+	}
+
+	PetscReal getRelativeError( PetscInt i ) const
+	{
+	    PetscReal error;
+	    if ( _mode == Compact ) { return _compactQEP.getRelativeError( i ); }
+	    QEPComputeRelativeError( _solver, i, &error );
+	    return error;
+	}
+
+	operator QEP() const { return _solver; }
+
+	void printOn(std::ostream& os) const
+	{
+	    const QEPType type;
+	    PetscReal error, tol, re, im;
+	    PetscScalar kr, ki;
+	    PetscInt i, nev, maxit, its, nconv;
+
+	    if ( _mode == Compact )
+		{
+		    _compactQEP.printOn( os );
+		}
+	    else
+		{
+		    QEPGetIterationNumber(_solver,&its);
+		    PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);
+		    QEPGetType(_solver,&type);
+		    PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);
+		    QEPGetTolerances(_solver,&tol,&maxit);
+		    PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);
+		}
+	    QEPGetDimensions(_solver,&nev,PETSC_NULL,PETSC_NULL);
+	    PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);
+
+	    nconv = getConverged();
+	    PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate eigenpairs: %d\n\n",nconv);
+
+	    if (nconv>0)
+		{
+		    PetscPrintf(PETSC_COMM_WORLD,
+				"           k          ||(k^2M+Ck+K)x||/||kx||\n"
+				"   ----------------- -------------------------\n" );
+		    for( i=0; i<nconv; i++ )
+			{
+			    getEigenpair(i,&kr,&ki);
+			    error = getRelativeError(i);
+#ifdef PETSC_USE_COMPLEX
+			    re = PetscRealPart(kr);
+			    im = PetscImaginaryPart(kr);
+#else
+			    re = kr;
+			    im = ki;
+#endif
+			    if (im!=0.0) { PetscPrintf(PETSC_COMM_WORLD," %9f%+9f j    %12g\n",re,im,error); }
+			    else { PetscPrintf(PETSC_COMM_WORLD,"   %12f       %12g\n",re,error); }
+			}
+		    PetscPrintf(PETSC_COMM_WORLD,"\n" );
+		}
+	}
+
+    private:
+	QEPSolver( const QEPSolver& );
+	QEPSolver& operator=( const QEPSolver& );
+
+    private:
+	QEP _solver;
+	Mode _mode;
+	CompactQEP _compactQEP;
+	PetscTruth _configured;
+    };
+}
+
+#endif // !_slepc_cxx_QEPSolver_h
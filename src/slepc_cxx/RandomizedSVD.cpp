@@ -0,0 +1,216 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include <petscblaslapack.h>
+
+#include "CholeskyQR.h"
+#include "RandomizedSVD.h"
+#include "SVDResidual.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	PetscScalar* data( std::vector< PetscScalar >& v ) { return v.empty() ? PETSC_NULL : &v[0]; }
+
+	// uniform in [-1,1), a function of the global row and the column so that it does not depend on the number of ranks
+	PetscScalar sample( PetscInt row, PetscInt col )
+	{
+	    unsigned long long h = ( (unsigned long long)row << 24 ) ^ (unsigned long long)col;
+	    h += 0x9E3779B97F4A7C15ULL;
+	    h = ( h ^ ( h >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	    h = ( h ^ ( h >> 27 ) ) * 0x94D049BB133111EBULL;
+	    h ^= h >> 31;
+	    return ( h >> 11 ) * ( 2.0 / 9007199254740992.0 ) - 1.0;
+	}
+    }
+
+    RandomizedSVD::RandomizedSVD( PetscInt rank /*= 10*/, PetscInt oversampling /*= 10*/, PetscInt powerIterations /*= 2*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _rank(rank), _oversampling(oversampling), _powerIterations(powerIterations),
+	  _A(PETSC_NULL), _AH(PETSC_NULL), _block(PETSC_FALSE), _m(0), _n(0), _matvecs(0), _shifted(0)
+    {}
+
+    RandomizedSVD::~RandomizedSVD()
+    {
+	if ( _AH ) { MatDestroy( _AH ); }
+    }
+
+    void RandomizedSVD::solve( Mat A )
+    {
+	PetscInt M, N, l, k, first, i, j, q;
+	PetscTruth mpi, seq;
+	std::vector< PetscScalar > Omega, Q, W, R;
+
+	_A = A;
+	_matvecs = 0;
+	_shifted = 0;
+	PetscTypeCompare( (PetscObject)A, MATMPIAIJ, &mpi );
+	PetscTypeCompare( (PetscObject)A, MATSEQAIJ, &seq );
+	_block = ( mpi || seq ) ? PETSC_TRUE : PETSC_FALSE;
+	if ( _AH ) { MatDestroy( _AH ); _AH = PETSC_NULL; }
+	if ( _block )
+	    {
+		MatTranspose( A, MAT_INITIAL_MATRIX, &_AH );
+#ifdef PETSC_USE_COMPLEX
+		MatConjugate( _AH );
+#endif
+	    }
+	MatGetSize( A, &M, &N );
+	MatGetLocalSize( A, &_m, &_n );
+	l = PetscMin( _rank + _oversampling, PetscMin( M, N ) );
+	k = PetscMin( _rank, l );
+
+	MatGetOwnershipRangeColumn( A, &first, PETSC_NULL );
+	Omega.resize( _n * l );
+	for ( j = 0; j < l; ++j )
+	    {
+		for ( i = 0; i < _n; ++i ) { Omega[i+j*_n] = sample( first + i, j ); }
+	    }
+
+	// range finder and power iterations
+	multiply( PETSC_FALSE, Omega, Q, l );
+	orthonormalize( Q, _m, l, R );
+	for ( q = 0; q < _powerIterations; ++q )
+	    {
+		multiply( PETSC_TRUE, Q, W, l );
+		orthonormalize( W, _n, l, R );
+		multiply( PETSC_FALSE, W, Q, l );
+		orthonormalize( Q, _m, l, R );
+	    }
+
+	// A ~ Q Q^H A = Q (A^H Q)^H = Q R^H W^H
+	multiply( PETSC_TRUE, Q, W, l );
+	if ( _AH ) { MatDestroy( _AH ); _AH = PETSC_NULL; }
+	orthonormalize( W, _n, l, R );
+
+	std::vector< PetscScalar > C( l * l ), Uc( l * l ), VT( l * l );
+	std::vector< PetscReal > s( l ), rwork( 5 * l );
+	PetscBLASInt bl = l, bk = k, bm = _m, bn = _n, ldm = PetscMax( _m, 1 ), ldn = PetscMax( _n, 1 ), lwork = 10 * l, info;
+	std::vector< PetscScalar > work( lwork );
+	PetscScalar one = 1.0, zero = 0.0;
+
+	for ( j = 0; j < l; ++j )
+	    {
+		for ( i = 0; i < l; ++i ) { C[i+j*l] = PetscConj( R[j+i*l] ); }
+	    }
+
+#ifndef PETSC_USE_COMPLEX
+	LAPACKgesvd_( "S", "S", &bl, &bl, &C[0], &bl, &s[0], &Uc[0], &bl, &VT[0], &bl, &work[0], &lwork, &info );
+#else
+	LAPACKgesvd_( "S", "S", &bl, &bl, &C[0], &bl, &s[0], &Uc[0], &bl, &VT[0], &bl, &work[0], &lwork, &rwork[0], &info );
+#endif
+	if ( info ) { throw std::runtime_error( "RandomizedSVD: xGESVD failed" ); }
+
+	// U = Q Uc, V = W VT^H, leading k columns
+	_U.assign( _m * k, 0.0 );
+	_V.assign( _n * k, 0.0 );
+	if ( _m > 0 ) { BLASgemm_( "N", "N", &bm, &bk, &bl, &one, &Q[0], &ldm, &Uc[0], &bl, &zero, &_U[0], &ldm ); }
+	if ( _n > 0 ) { BLASgemm_( "N", "C", &bn, &bk, &bl, &one, &W[0], &ldn, &VT[0], &bl, &zero, &_V[0], &ldn ); }
+	_sigma.assign( s.begin(), s.begin() + k );
+    }
+
+    void RandomizedSVD::getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u /*= PETSC_NULL*/, Vec v /*= PETSC_NULL*/ ) const
+    {
+	PetscScalar* p;
+	PetscInt k;
+
+	*sigma = _sigma[i];
+	if ( u )
+	    {
+		VecGetArray( u, &p );
+		for ( k = 0; k < _m; ++k ) { p[k] = _U[k+i*_m]; }
+		VecRestoreArray( u, &p );
+	    }
+	if ( v )
+	    {
+		VecGetArray( v, &p );
+		for ( k = 0; k < _n; ++k ) { p[k] = _V[k+i*_n]; }
+		VecRestoreArray( v, &p );
+	    }
+    }
+
+    PetscReal RandomizedSVD::getRelativeError( PetscInt i ) const
+    {
+	PetscReal sigma, error;
+	Vec u, v;
+
+	MatGetVecs( _A, &v, &u );
+	getSingularTriplet( i, &sigma, u, v );
+	error = relativeError( _A, sigma, u, v );
+	VecDestroy( u );
+	VecDestroy( v );
+	return error;
+    }
+
+    void RandomizedSVD::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Randomized SVD: rank %d, oversampling %d, %d power iterations\n",_rank,_oversampling,_powerIterations);
+	PetscPrintf(_comm," %d matrix-vector products, %d shifted Cholesky QR\n\n",_matvecs,_shifted);
+    }
+
+    void RandomizedSVD::multiply( PetscTruth transpose, std::vector< PetscScalar >& X, std::vector< PetscScalar >& Y, PetscInt l )
+    {
+	PetscInt nx = transpose ? _m : _n, ny = transpose ? _n : _m, Nx, j;
+	PetscScalar* p;
+	Mat Xd, Yd;
+	Vec x, y;
+
+	Y.resize( ny * l );
+	_matvecs += l;
+
+	if ( _block )
+	    {
+		// X and Y are the local rows of dense matrices, column-major with leading dimension nx and ny
+		if ( transpose ) { MatGetSize( _A, &Nx, PETSC_NULL ); }
+		else { MatGetSize( _A, PETSC_NULL, &Nx ); }
+		MatCreateMPIDense( _comm, nx, PETSC_DECIDE, Nx, l, data( X ), &Xd );
+		MatMatMult( transpose ? _AH : _A, Xd, MAT_INITIAL_MATRIX, PETSC_DEFAULT, &Yd );
+		MatGetArray( Yd, &p );
+		for ( j = 0; j < ny * l; ++j ) { Y[j] = p[j]; }
+		MatRestoreArray( Yd, &p );
+		MatDestroy( Xd );
+		MatDestroy( Yd );
+		return;
+	    }
+
+	if ( transpose ) { MatGetVecs( _A, &y, &x ); }
+	else { MatGetVecs( _A, &x, &y ); }
+
+	for ( j = 0; j < l; ++j )
+	    {
+		VecPlaceArray( x, data( X ) + j * nx );
+		VecPlaceArray( y, data( Y ) + j * ny );
+		if ( transpose ) { multHermitianTranspose( _A, x, y ); }
+		else { MatMult( _A, x, y ); }
+		VecResetArray( x );
+		VecResetArray( y );
+	    }
+
+	VecDestroy( x );
+	VecDestroy( y );
+    }
+
+    void RandomizedSVD::orthonormalize( std::vector< PetscScalar >& X, PetscInt m, PetscInt l, std::vector< PetscScalar >& R )
+    {
+	_shifted += choleskyQR( _comm, X, m, l, R );
+    }
+}
@@ -0,0 +1,104 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_RandomizedSVD_h
+#define _slepc_cxx_RandomizedSVD_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Truncated SVD A ~ U S V^T of rank k from a randomized range finder.
+     *
+     * A block of l = k + oversampling test vectors is multiplied by A, then
+     * q power iterations alternate products by A^T and A to sharpen the decay
+     * of the spectrum, each product block being orthonormalised. The final
+     * block Q spans the range, B^T = A^T Q is factored as W R and the SVD of
+     * the small l x l matrix R^T gives both sets of singular vectors.
+     *
+     * The blocks are stored as local column-major arrays, the layout of a
+     * dense matrix, so that on AIJ matrices each product is one MatMatMult
+     * by the whole block and the products by A^H run on an explicit copy
+     * made once per solve. Other matrix types fall back to MatMult on each
+     * column. The orthonormalisation is a BLAS-3 Gram matrix, one reduction
+     * and a triangular solve: Cholesky QR run twice, with a shifted first
+     * pass if the Gram matrix is not numerically positive definite. The cost
+     * is 2(q+1) l matrix-vector products and no restart, whatever the
+     * convergence of the spectrum.
+     */
+    class RandomizedSVD : public core_library::Printable
+    {
+    public:
+	RandomizedSVD( PetscInt rank = 10, PetscInt oversampling = 10, PetscInt powerIterations = 2, MPI_Comm comm = PETSC_COMM_WORLD );
+	~RandomizedSVD();
+
+	// collective, A must outlive getRelativeError()
+	void solve( Mat A );
+
+	void setRank( PetscInt rank ) { _rank = rank; }
+	void setOversampling( PetscInt oversampling ) { _oversampling = oversampling; }
+	void setPowerIterations( PetscInt powerIterations ) { _powerIterations = powerIterations; }
+
+	PetscInt getConverged() const { return _sigma.size(); }
+
+	// in decreasing order, u and v may be PETSC_NULL
+	void getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u = PETSC_NULL, Vec v = PETSC_NULL ) const;
+
+	// collective, ||[A v - sigma u; A^T u - sigma v]|| / sigma as SVDComputeRelativeError
+	PetscReal getRelativeError( PetscInt i ) const;
+
+	PetscInt matvecs() const { return _matvecs; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	RandomizedSVD( const RandomizedSVD& );
+	RandomizedSVD& operator=( const RandomizedSVD& );
+
+	// Y = op(A) X, by blocks on AIJ matrices and column by column otherwise
+	void multiply( PetscTruth transpose, std::vector< PetscScalar >& X, std::vector< PetscScalar >& Y, PetscInt l );
+
+	// X = Q R in place, R is l x l upper triangular
+	void orthonormalize( std::vector< PetscScalar >& X, PetscInt m, PetscInt l, std::vector< PetscScalar >& R );
+
+    private:
+	MPI_Comm _comm;
+	PetscInt _rank;
+	PetscInt _oversampling;
+	PetscInt _powerIterations;
+
+	Mat _A;
+	Mat _AH;
+	PetscTruth _block;
+	PetscInt _m;
+	PetscInt _n;
+	std::vector< PetscScalar > _U;
+	std::vector< PetscScalar > _V;
+	std::vector< PetscReal > _sigma;
+	PetscInt _matvecs;
+	PetscInt _shifted;
+    };
+}
+
+#endif // !_slepc_cxx_RandomizedSVD_h
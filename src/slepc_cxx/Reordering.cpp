@@ -0,0 +1,407 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Reordering.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// symmetric pattern without the diagonal, neighbours of v at adj[xadj[v]] to adj[xadj[v+1]-1]
+	struct Graph
+	{
+	    std::vector< PetscInt > xadj;
+	    std::vector< PetscInt > adj;
+
+	    PetscInt degree( PetscInt v ) const { return xadj[v+1] - xadj[v]; }
+	};
+
+	class ByDegree
+	{
+	public:
+	    ByDegree( const Graph& graph ) : _graph(graph) {}
+
+	    bool operator()( PetscInt a, PetscInt b ) const { return _graph.degree( a ) < _graph.degree( b ); }
+
+	private:
+	    const Graph& _graph;
+	};
+
+	// breadth-first levels from root, returns the depth and the vertices of the last level
+	PetscInt levels( const Graph& graph, PetscInt root, std::vector< PetscInt >& seen, PetscInt stamp, std::vector< PetscInt >& last )
+	{
+	    std::vector< PetscInt > level( 1, root ), next;
+	    PetscInt depth = 0, k, e, v;
+
+	    seen[root] = stamp;
+	    for ( ;; )
+		{
+		    next.clear();
+		    for ( k = 0; k < (PetscInt)level.size(); ++k )
+			{
+			    v = level[k];
+			    for ( e = graph.xadj[v]; e < graph.xadj[v+1]; ++e )
+				{
+				    if ( seen[graph.adj[e]] != stamp )
+					{
+					    seen[graph.adj[e]] = stamp;
+					    next.push_back( graph.adj[e] );
+					}
+				}
+			}
+		    if ( next.empty() ) { break; }
+		    level.swap( next );
+		    ++depth;
+		}
+	    last.swap( level );
+	    return depth;
+	}
+
+	// Gibbs-Poole-Stockmeyer: the vertex of least degree in the last level while the depth grows
+	PetscInt peripheral( const Graph& graph, PetscInt root, std::vector< PetscInt >& seen, PetscInt& stamp )
+	{
+	    std::vector< PetscInt > last;
+	    PetscInt depth = levels( graph, root, seen, ++stamp, last ), candidate, d;
+
+	    for ( PetscInt i = 0; i < 8; ++i )
+		{
+		    candidate = *std::min_element( last.begin(), last.end(), ByDegree( graph ) );
+		    std::vector< PetscInt > other;
+		    d = levels( graph, candidate, seen, ++stamp, other );
+		    if ( d <= depth ) { break; }
+		    root = candidate;
+		    depth = d;
+		    last.swap( other );
+		}
+	    return root;
+	}
+
+	// new to old numbering, the Cuthill-McKee order of every component reversed
+	void rcm( const Graph& graph, std::vector< PetscInt >& order )
+	{
+	    PetscInt N = graph.xadj.size() - 1, stamp = 0, start, head, v, e, first;
+	    std::vector< PetscInt > seen( N, -1 ), numbered( N, 0 ), vertices( N );
+
+	    for ( v = 0; v < N; ++v ) { vertices[v] = v; }
+	    std::stable_sort( vertices.begin(), vertices.end(), ByDegree( graph ) );
+
+	    order.clear();
+	    for ( start = 0; start < N; ++start )
+		{
+		    if ( numbered[vertices[start]] ) { continue; }
+
+		    head = order.size();
+		    v = peripheral( graph, vertices[start], seen, stamp );
+		    numbered[v] = 1;
+		    order.push_back( v );
+		    while ( head < (PetscInt)order.size() )
+			{
+			    v = order[head++];
+			    first = order.size();
+			    for ( e = graph.xadj[v]; e < graph.xadj[v+1]; ++e )
+				{
+				    if ( !numbered[graph.adj[e]] )
+					{
+					    numbered[graph.adj[e]] = 1;
+					    order.push_back( graph.adj[e] );
+					}
+				}
+			    std::stable_sort( order.begin() + first, order.end(), ByDegree( graph ) );
+			}
+		}
+	    std::reverse( order.begin(), order.end() );
+	}
+
+	// collective, largest |i - j| over the nonzeros
+	PetscInt bandwidth( Mat A )
+	{
+	    PetscInt rstart, rend, row, ncols, k, local = 0, global;
+	    const PetscInt* cols;
+	    MPI_Comm comm;
+
+	    PetscObjectGetComm( (PetscObject)A, &comm );
+	    MatGetOwnershipRange( A, &rstart, &rend );
+	    for ( row = rstart; row < rend; ++row )
+		{
+		    MatGetRow( A, row, &ncols, &cols, PETSC_NULL );
+		    for ( k = 0; k < ncols; ++k ) { local = PetscMax( local, PetscAbs( cols[k] - row ) ); }
+		    MatRestoreRow( A, row, &ncols, &cols, PETSC_NULL );
+		}
+	    MPI_Allreduce( &local, &global, 1, MPIU_INT, MPI_MAX, comm );
+	    return global;
+	}
+    }
+
+    Reordering::Reordering( Method method /*= None*/ )
+	: _method(method), _source(PETSC_NULL), _permuted(PETSC_NULL), _state(-1), _structure(DIFFERENT_NONZERO_PATTERN),
+	  _is(PETSC_NULL), _scatter(PETSC_NULL), _orderings(0), _refreshes(0)
+    {
+	_work[0] = _work[1] = PETSC_NULL;
+	_bandwidth[0] = _bandwidth[1] = 0;
+	_offRank[0] = _offRank[1] = 0;
+    }
+
+    Reordering::~Reordering()
+    {
+	destroy();
+    }
+
+    void Reordering::setMethod( Method method )
+    {
+	_method = method;
+	if ( _source ) { MatDestroy( _source ); _source = PETSC_NULL; }
+    }
+
+    Mat Reordering::operator()( Mat A )
+    {
+	PetscInt state, m, first, last;
+	MPI_Comm comm;
+	Vec x;
+	IS from;
+
+	PetscObjectStateQuery( (PetscObject)A, &state );
+	if ( A == _source && state == _state ) { return _permuted; }
+
+	// same pattern, new values
+	if ( A == _source && _structure == SAME_NONZERO_PATTERN )
+	    {
+		subMatrix( A, MAT_REUSE_MATRIX );
+		++_refreshes;
+		_state = state;
+		return _permuted;
+	    }
+
+	PetscObjectReference( (PetscObject)A );
+	destroy();
+	_source = A;
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	if ( _method == ReverseCuthillMcKee ) { reverseCuthillMcKee( A ); }
+	else if ( _method == Partitioning ) { partition( A ); }
+	else
+	    {
+		MatGetOwnershipRange( A, &first, &last );
+		_rows.resize( last - first );
+		for ( m = 0; m < last - first; ++m ) { _rows[m] = first + m; }
+	    }
+	++_orderings;
+
+	m = _rows.size();
+	ISCreateGeneral( comm, m, m ? &_rows[0] : PETSC_NULL, &_is );
+	subMatrix( A, MAT_INITIAL_MATRIX );
+	MatGetVecs( _permuted, &_work[0], PETSC_NULL );
+	VecDuplicate( _work[0], &_work[1] );
+
+	// the new row first + k is the old row _rows[k]
+	MatGetVecs( A, &x, PETSC_NULL );
+	VecGetOwnershipRange( _work[0], &first, &last );
+	ISCreateStride( comm, m, first, 1, &from );
+	VecScatterCreate( _work[0], from, x, _is, &_scatter );
+	ISDestroy( from );
+	VecDestroy( x );
+
+	_bandwidth[0] = bandwidth( A );
+	_bandwidth[1] = bandwidth( _permuted );
+	_offRank[0] = offRank( A );
+	_offRank[1] = offRank( _permuted );
+
+	_state = state;
+	return _permuted;
+    }
+
+    void Reordering::subMatrix( Mat A, MatReuse reuse )
+    {
+	// the same index set for the columns gives P A P^T the layout of its vectors
+	PetscErrorCode ierr = MatGetSubMatrix( A, _is, _is, reuse, &_permuted );
+	if ( ierr ) { throw std::runtime_error( "Reordering: MatGetSubMatrix failed" ); }
+    }
+
+    void Reordering::toOriginal( Vec y, Vec x ) const
+    {
+	VecScatterBegin( _scatter, y, x, INSERT_VALUES, SCATTER_FORWARD );
+	VecScatterEnd( _scatter, y, x, INSERT_VALUES, SCATTER_FORWARD );
+    }
+
+    void Reordering::printOn(std::ostream&) const
+    {
+	const char* names[] = { "none", "reverse Cuthill-McKee", "partitioning" };
+
+	PetscPrintf(PETSC_COMM_WORLD," Reordering (%s): bandwidth %d -> %d, off-rank nonzeros %d -> %d, orderings: %d, refreshes: %d\n\n",
+		    names[_method],_bandwidth[0],_bandwidth[1],_offRank[0],_offRank[1],_orderings,_refreshes);
+    }
+
+    void Reordering::reverseCuthillMcKee( Mat A )
+    {
+	PetscMPIInt rank, size, p;
+	PetscInt rstart, rend, N, row, ncols, k, v, e;
+	const PetscInt* cols;
+	MPI_Comm comm;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MPI_Comm_rank( comm, &rank );
+	MPI_Comm_size( comm, &size );
+	MatGetSize( A, &N, PETSC_NULL );
+	MatGetOwnershipRange( A, &rstart, &rend );
+
+	// the local pattern as (row, column) pairs, the diagonal left out
+	std::vector< PetscInt > local;
+	for ( row = rstart; row < rend; ++row )
+	    {
+		MatGetRow( A, row, &ncols, &cols, PETSC_NULL );
+		for ( k = 0; k < ncols; ++k )
+		    {
+			if ( cols[k] == row ) { continue; }
+			local.push_back( row );
+			local.push_back( cols[k] );
+		    }
+		MatRestoreRow( A, row, &ncols, &cols, PETSC_NULL );
+	    }
+
+	PetscMPIInt count = local.size(), m = rend - rstart;
+	std::vector< PetscMPIInt > counts( size ), displs( size, 0 ), sizes( size ), starts( size, 0 );
+	MPI_Gather( &count, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, comm );
+	MPI_Gather( &m, 1, MPI_INT, &sizes[0], 1, MPI_INT, 0, comm );
+	for ( p = 1; p < size; ++p )
+	    {
+		displs[p] = displs[p-1] + counts[p-1];
+		starts[p] = starts[p-1] + sizes[p-1];
+	    }
+
+	std::vector< PetscInt > pairs, order;
+	if ( !rank ) { pairs.resize( displs[size-1] + counts[size-1] + 1 ); }
+	local.push_back( 0 );
+	MPI_Gatherv( &local[0], count, MPIU_INT, rank ? PETSC_NULL : &pairs[0], &counts[0], &displs[0], MPIU_INT, 0, comm );
+
+	if ( !rank )
+	    {
+		// A + A^T without repeated neighbours
+		Graph graph;
+		PetscInt nnz = displs[size-1] + counts[size-1];
+		std::vector< PetscInt > fill( N + 1, 0 );
+		for ( k = 0; k < nnz; k += 2 )
+		    {
+			++fill[pairs[k]+1];
+			++fill[pairs[k+1]+1];
+		    }
+		for ( v = 0; v < N; ++v ) { fill[v+1] += fill[v]; }
+		graph.adj.resize( fill[N] );
+		std::vector< PetscInt > next( fill.begin(), fill.end() - 1 );
+		for ( k = 0; k < nnz; k += 2 )
+		    {
+			graph.adj[next[pairs[k]]++] = pairs[k+1];
+			graph.adj[next[pairs[k+1]]++] = pairs[k];
+		    }
+		graph.xadj.assign( N + 1, 0 );
+		for ( e = 0, v = 0; v < N; ++v )
+		    {
+			std::sort( graph.adj.begin() + fill[v], graph.adj.begin() + fill[v+1] );
+			PetscInt end = std::unique( graph.adj.begin() + fill[v], graph.adj.begin() + fill[v+1] ) - graph.adj.begin();
+			for ( k = fill[v]; k < end; ++k ) { graph.adj[e++] = graph.adj[k]; }
+			graph.xadj[v+1] = e;
+		    }
+		graph.adj.resize( e );
+
+		rcm( graph, order );
+	    }
+	order.push_back( 0 );
+
+	// every rank keeps its number of rows
+	_rows.resize( m + 1 );
+	MPI_Scatterv( &order[0], &sizes[0], &starts[0], MPIU_INT, &_rows[0], m, MPIU_INT, 0, comm );
+	_rows.resize( m );
+    }
+
+    void Reordering::partition( Mat A )
+    {
+	PetscMPIInt size, p;
+	PetscInt rstart, rend, row;
+	const PetscInt* target;
+	MatPartitioning part;
+	MPI_Comm comm;
+	Mat adj;
+	IS is;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MPI_Comm_size( comm, &size );
+	MatGetOwnershipRange( A, &rstart, &rend );
+
+	MatConvert( A, MATMPIADJ, MAT_INITIAL_MATRIX, &adj );
+	MatPartitioningCreate( comm, &part );
+	MatPartitioningSetAdjacency( part, adj );
+	MatPartitioningSetFromOptions( part );
+	MatPartitioningApply( part, &is );
+
+	// every row goes to its part, the rows from one rank keeping their order
+	std::vector< PetscMPIInt > sendCounts( size, 0 ), recvCounts( size ), sendDispls( size, 0 ), recvDispls( size, 0 );
+	ISGetIndices( is, &target );
+	for ( row = rstart; row < rend; ++row ) { ++sendCounts[target[row-rstart]]; }
+	MPI_Alltoall( &sendCounts[0], 1, MPI_INT, &recvCounts[0], 1, MPI_INT, comm );
+	for ( p = 1; p < size; ++p )
+	    {
+		sendDispls[p] = sendDispls[p-1] + sendCounts[p-1];
+		recvDispls[p] = recvDispls[p-1] + recvCounts[p-1];
+	    }
+
+	std::vector< PetscInt > send( rend - rstart + 1 );
+	std::vector< PetscMPIInt > next( sendDispls );
+	for ( row = rstart; row < rend; ++row ) { send[next[target[row-rstart]]++] = row; }
+	ISRestoreIndices( is, &target );
+
+	_rows.resize( recvDispls[size-1] + recvCounts[size-1] + 1 );
+	MPI_Alltoallv( &send[0], &sendCounts[0], &sendDispls[0], MPIU_INT, &_rows[0], &recvCounts[0], &recvDispls[0], MPIU_INT, comm );
+	_rows.resize( recvDispls[size-1] + recvCounts[size-1] );
+
+	ISDestroy( is );
+	MatPartitioningDestroy( part );
+	MatDestroy( adj );
+    }
+
+    PetscInt Reordering::offRank( Mat A )
+    {
+	PetscInt rstart, rend, row, ncols, k, local = 0, global;
+	const PetscInt* cols;
+	MPI_Comm comm;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MatGetOwnershipRange( A, &rstart, &rend );
+	for ( row = rstart; row < rend; ++row )
+	    {
+		MatGetRow( A, row, &ncols, &cols, PETSC_NULL );
+		for ( k = 0; k < ncols; ++k )
+		    {
+			if ( cols[k] < rstart || cols[k] >= rend ) { ++local; }
+		    }
+		MatRestoreRow( A, row, &ncols, &cols, PETSC_NULL );
+	    }
+	MPI_Allreduce( &local, &global, 1, MPIU_INT, MPI_SUM, comm );
+	return global;
+    }
+
+    void Reordering::destroy()
+    {
+	if ( _scatter ) { VecScatterDestroy( _scatter ); _scatter = PETSC_NULL; }
+	if ( _is ) { ISDestroy( _is ); _is = PETSC_NULL; }
+	if ( _permuted ) { MatDestroy( _permuted ); _permuted = PETSC_NULL; }
+	if ( _work[0] ) { VecDestroy( _work[0] ); _work[0] = PETSC_NULL; }
+	if ( _work[1] ) { VecDestroy( _work[1] ); _work[1] = PETSC_NULL; }
+	if ( _source ) { MatDestroy( _source ); _source = PETSC_NULL; }
+    }
+}
@@ -0,0 +1,118 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_Reordering_h
+#define _slepc_cxx_Reordering_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Symmetric permutation P A P^T of an assembled operator, so that the
+     * products of a solve read x near the diagonal and exchange fewer entries
+     * between ranks. The eigenvectors found for P A P^T are brought back to
+     * the ordering of A by toOriginal().
+     *
+     * ReverseCuthillMcKee gathers the pattern of A + A^T on rank 0 and
+     * numbers it level by level from a pseudo-peripheral vertex of every
+     * component, the ranks keeping their number of rows. Partitioning hands
+     * the pattern, which must be symmetric, to MatPartitioning (ParMETIS
+     * with -mat_partitioning_type parmetis) and moves every row to its part,
+     * in its previous order.
+     *
+     * The permutation is computed for the first A and kept while the same
+     * matrix is given unchanged. A change of its values recomputes it, unless
+     * setStructure(SAME_NONZERO_PATTERN) declares that the pattern was kept:
+     * only the entries of P A P^T are refreshed then, so repeated solves pay
+     * the ordering once. A is referenced while it is held, so its address
+     * cannot be reused by another matrix.
+     *
+     * Vectors handed to the eigensolver (deflation or initial spaces) would
+     * have to be permuted as well: EPSolver refuses to reorder with them.
+     */
+    class Reordering : public core_library::Printable
+    {
+    public:
+	enum Method { None, ReverseCuthillMcKee, Partitioning };
+
+	Reordering( Method method = None );
+	~Reordering();
+
+	// applies to the next A
+	void setMethod( Method method );
+	Method method() const { return _method; }
+
+	// pattern of A when its values change, DIFFERENT_NONZERO_PATTERN by default
+	void setStructure( MatStructure structure ) { _structure = structure; }
+
+	// collective, P A P^T, valid while A lives and until the next call
+	Mat operator()( Mat A );
+
+	// collective, x in the ordering of A from the permuted y
+	void toOriginal( Vec y, Vec x ) const;
+
+	// work vector k = 0, 1 of the permuted layout
+	Vec permuted( PetscInt k ) const { return _work[k]; }
+
+	// nonzeros whose column another rank owns, in A and in P A P^T
+	PetscInt offRankBefore() const { return _offRank[0]; }
+	PetscInt offRankAfter() const { return _offRank[1]; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	Reordering( const Reordering& );
+	Reordering& operator=( const Reordering& );
+
+	// the old indices of the new local rows into _rows
+	void reverseCuthillMcKee( Mat A );
+	void partition( Mat A );
+
+	static PetscInt offRank( Mat A );
+
+	// collective, _permuted from A through _is
+	void subMatrix( Mat A, MatReuse reuse );
+
+	void destroy();
+
+    private:
+	Method _method;
+	Mat _source;
+	Mat _permuted;
+	PetscInt _state;
+	MatStructure _structure;
+
+	std::vector< PetscInt > _rows;
+	IS _is;
+	VecScatter _scatter;
+	Vec _work[2];
+
+	PetscInt _bandwidth[2];
+	PetscInt _offRank[2];
+	PetscInt _orderings;
+	PetscInt _refreshes;
+    };
+}
+
+#endif // !_slepc_cxx_Reordering_h
@@ -0,0 +1,187 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "RowPartition.h"
+
+namespace slepc_cxx
+{
+    std::vector< PetscInt > RowPartition::balance( MPI_Comm comm, const std::vector< PetscInt >& weights )
+    {
+	PetscMPIInt size, rank, p;
+	PetscInt m = weights.size(), M, r;
+	long long before = 0, local = 0, total;
+
+	MPI_Comm_size( comm, &size );
+	MPI_Comm_rank( comm, &rank );
+
+	// running weight of the local rows, shifted by the weight of the previous ranks
+	std::vector< long long > prefix( m );
+	for ( r = 0; r < m; ++r ) { prefix[r] = ( local += weights[r] ); }
+	MPI_Exscan( &local, &before, 1, MPI_LONG_LONG_INT, MPI_SUM, comm );
+	if ( !rank ) { before = 0; }
+	for ( r = 0; r < m; ++r ) { prefix[r] += before; }
+
+	MPI_Allreduce( &local, &total, 1, MPI_LONG_LONG_INT, MPI_SUM, comm );
+	MPI_Allreduce( &m, &M, 1, MPIU_INT, MPI_SUM, comm );
+
+	std::vector< PetscInt > counts( size + 1, 0 ), cuts( size + 1, 0 );
+	if ( total == 0 )
+	    {
+		for ( p = 0; p <= size; ++p ) { cuts[p] = ( (long long)M * p ) / size; }
+		return cuts;
+	    }
+
+	// the p-th cut is the number of rows whose running weight stays within p/size of the total
+	for ( p = 1; p < size; ++p )
+	    {
+		long long target = ( total * p ) / size;
+		counts[p] = std::upper_bound( prefix.begin(), prefix.end(), target ) - prefix.begin();
+	    }
+	MPI_Allreduce( &counts[0], &cuts[0], size + 1, MPIU_INT, MPI_SUM, comm );
+	cuts[size] = M;
+	return cuts;
+    }
+
+    PetscReal RowPartition::imbalance( MPI_Comm comm, PetscReal weight )
+    {
+	PetscMPIInt size;
+	PetscReal max, sum;
+
+	MPI_Comm_size( comm, &size );
+	MPI_Allreduce( &weight, &max, 1, MPIU_REAL, MPI_MAX, comm );
+	MPI_Allreduce( &weight, &sum, 1, MPIU_REAL, MPI_SUM, comm );
+	return sum > 0 ? max * size / sum : 1.0;
+    }
+
+    void RowPartition::redistribute( Mat A, Mat* B, Weight weight /*= Nonzeros*/ )
+    {
+	PetscMPIInt rank;
+	PetscInt M, N, m;
+	MPI_Comm comm;
+	IS rows;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MPI_Comm_rank( comm, &rank );
+	MatGetSize( A, &M, &N );
+	if ( M != N ) { throw std::runtime_error( "RowPartition: the operator must be square" ); }
+
+	std::vector< PetscInt > cuts = balance( comm, weights( A, weight ) );
+	m = cuts[rank+1] - cuts[rank];
+	ISCreateStride( comm, m, cuts[rank], 1, &rows );
+	// the rows again for the columns, so that the vectors of B follow its rows
+	PetscErrorCode ierr = MatGetSubMatrix( A, rows, rows, MAT_INITIAL_MATRIX, B );
+	ISDestroy( rows );
+	if ( ierr ) { throw std::runtime_error( "RowPartition: MatGetSubMatrix failed" ); }
+    }
+
+    PetscReal RowPartition::imbalance( Mat A )
+    {
+	MPI_Comm comm;
+	MatInfo info;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MatGetInfo( A, MAT_LOCAL, &info );
+	return imbalance( comm, info.nz_used );
+    }
+
+    PetscLogDouble RowPartition::productTime( Mat A, PetscInt samples /*= 10*/ )
+    {
+	PetscLogDouble t0, t1, local = 0;
+	MPI_Comm comm;
+	Vec x, y;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	MatGetVecs( A, &x, &y );
+	VecSet( x, 1.0 );
+	for ( PetscInt k = 0; k < samples; ++k )
+	    {
+		MPI_Barrier( comm );
+		PetscGetTime( &t0 );
+		MatMult( A, x, y );
+		PetscGetTime( &t1 );
+		local += t1 - t0;
+	    }
+	VecDestroy( x );
+	VecDestroy( y );
+	return local;
+    }
+
+    PetscLogDouble RowPartition::blockTime( Mat A, PetscInt* nonzeros, PetscInt samples /*= 10*/ )
+    {
+	PetscLogDouble t0, t1;
+	PetscTruth mpi, seq;
+	MatInfo info;
+	Mat Ad = A, Ao;
+	PetscInt* garray;
+	Vec x, y;
+
+	PetscTypeCompare( (PetscObject)A, MATMPIAIJ, &mpi );
+	PetscTypeCompare( (PetscObject)A, MATSEQAIJ, &seq );
+	if ( !mpi && !seq ) { throw std::runtime_error( "RowPartition: measured weights need an AIJ matrix" ); }
+	if ( mpi ) { MatMPIAIJGetSeqAIJ( A, &Ad, &Ao, &garray ); }
+
+	MatGetInfo( Ad, MAT_LOCAL, &info );
+	*nonzeros = (PetscInt)info.nz_used;
+
+	MatGetVecs( Ad, &x, &y );
+	VecSet( x, 1.0 );
+	PetscGetTime( &t0 );
+	for ( PetscInt k = 0; k < samples; ++k ) { MatMult( Ad, x, y ); }
+	PetscGetTime( &t1 );
+	VecDestroy( x );
+	VecDestroy( y );
+	return t1 - t0;
+    }
+
+    std::vector< PetscInt > RowPartition::weights( Mat A, Weight weight )
+    {
+	PetscInt rstart, rend, i, ncols;
+	long long nonzeros = 0;
+
+	// the cost of a row in a product is its number of nonzeros
+	MatGetOwnershipRange( A, &rstart, &rend );
+	std::vector< PetscInt > weights( rend - rstart );
+	for ( i = rstart; i < rend; ++i )
+	    {
+		MatGetRow( A, i, &ncols, PETSC_NULL, PETSC_NULL );
+		weights[i-rstart] = ncols;
+		nonzeros += ncols;
+		MatRestoreRow( A, i, &ncols, PETSC_NULL, PETSC_NULL );
+	    }
+	if ( weight == Nonzeros ) { return weights; }
+
+	// the rows of a rank cost its time per nonzero in the diagonal block, relative to the average one
+	PetscReal local[2], total[2], scale;
+	PetscInt block;
+	MPI_Comm comm;
+
+	PetscObjectGetComm( (PetscObject)A, &comm );
+	local[0] = blockTime( A, &block );
+	local[1] = block;
+	MPI_Allreduce( local, total, 2, MPIU_REAL, MPI_SUM, comm );
+	scale = block > 0 && local[0] > 0 && total[0] > 0 ? ( local[0] / local[1] ) / ( total[0] / total[1] ) : 1.0;
+
+	// in 1/16 of a nonzero, so that slower ranks lose rows even when their rows are short
+	for ( i = 0; i < rend - rstart; ++i ) { weights[i] = (PetscInt)( 16 * scale * weights[i] + 0.5 ); }
+	return weights;
+    }
+}
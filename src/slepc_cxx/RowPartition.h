@@ -0,0 +1,77 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_RowPartition_h
+#define _slepc_cxx_RowPartition_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Contiguous row partitions with about the same total weight per rank.
+     *
+     * PETSC_DECIDE gives every rank the same number of rows, which leaves
+     * the ranks holding the dense rows of a power-law graph or of a Markov
+     * model behind at every reduction of a solve. redistribute() moves the
+     * rows of an assembled operator to cuts of equal weight, the number of
+     * nonzeros of a row or that number scaled by the time per nonzero of
+     * the local diagonal-block product on its rank, which leaves out the
+     * waits on the other ranks.
+     */
+    class RowPartition
+    {
+    public:
+	enum Weight { Nonzeros, Measured };
+
+	/*
+	 * Collective. weights[k] is the cost of the row rstart + k, the rows
+	 * being currently spread contiguously in rank order. Returns the first
+	 * row of every rank in the balanced partition, followed by the number
+	 * of rows. Falls back to the uniform split when all weights are zero.
+	 */
+	static std::vector< PetscInt > balance( MPI_Comm comm, const std::vector< PetscInt >& weights );
+
+	// collective, largest local weight over the average one
+	static PetscReal imbalance( MPI_Comm comm, PetscReal weight );
+
+	/*
+	 * Collective. B is a new copy of the square A whose rows, and columns
+	 * so that its vectors share the layout, are balanced by the weight.
+	 */
+	static void redistribute( Mat A, Mat* B, Weight weight = Nonzeros );
+
+	// collective, imbalance of the local number of nonzeros of A
+	static PetscReal imbalance( Mat A );
+
+	// collective, local time of samples products with A, each one started together
+	static PetscLogDouble productTime( Mat A, PetscInt samples = 10 );
+
+    private:
+	// local time of samples products with the diagonal block of the AIJ matrix A, and its number of nonzeros
+	static PetscLogDouble blockTime( Mat A, PetscInt* nonzeros, PetscInt samples = 10 );
+
+	// the number of nonzeros of the local rows, in 1/16 of a nonzero at the measured cost when Measured
+	static std::vector< PetscInt > weights( Mat A, Weight weight );
+    };
+}
+
+#endif // !_slepc_cxx_RowPartition_h
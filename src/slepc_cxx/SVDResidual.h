@@ -0,0 +1,65 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_SVDResidual_h
+#define _slepc_cxx_SVDResidual_h
+
+#include <cmath>
+
+#include <petscmat.h>
+
+namespace slepc_cxx
+{
+    // y = A^H x, PETSc has no Hermitian transpose product
+    inline void multHermitianTranspose( Mat A, Vec x, Vec y )
+    {
+#ifdef PETSC_USE_COMPLEX
+	VecConjugate( x );
+	MatMultTranspose( A, x, y );
+	VecConjugate( x );
+	VecConjugate( y );
+#else
+	MatMultTranspose( A, x, y );
+#endif
+    }
+
+    // collective, ||[A v - sigma u; A^H u - sigma v]|| / sigma as SVDComputeRelativeError, the absolute residual for sigma = 0
+    inline PetscReal relativeError( Mat A, PetscReal sigma, Vec u, Vec v )
+    {
+	PetscReal left, right;
+	Vec r, s;
+
+	VecDuplicate( u, &r );
+	VecDuplicate( v, &s );
+
+	MatMult( A, v, r );
+	VecAXPY( r, -sigma, u );
+	VecNorm( r, NORM_2, &left );
+	multHermitianTranspose( A, u, s );
+	VecAXPY( s, -sigma, v );
+	VecNorm( s, NORM_2, &right );
+
+	VecDestroy( r );
+	VecDestroy( s );
+
+	return std::sqrt( left * left + right * right ) / ( sigma > 0 ? sigma : 1 );
+    }
+}
+
+#endif // !_slepc_cxx_SVDResidual_h
@@ -0,0 +1,225 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_SVDSolver_h
+#define _slepc_cxx_SVDSolver_h
+
+#include <slepcsvd.h>
+
+#include <core_library/Printable.h>
+#include <core_library/UF.h>
+
+#include <petsc_cxx/Matrix.h>
+#include <petsc_cxx/Vector.h>
+
+#include "ImplicitSVD.h"
+#include "RandomizedSVD.h"
+#include "TallSkinnySVD.h"
+
+namespace slepc_cxx
+{
+    /*
+     * Singular triplets from the SLEPc SVD object (Krylov methods, set up
+     * with the -svd_ options), from RandomizedSVD once setRandomized() is
+     * called, with the number of triplets requested by SVDSetDimensions as
+     * rank, or from ImplicitSVD once setImplicit() is called, with the same
+     * number and which end of the spectrum. In the default Krylov mode, a
+     * matrix with few enough columns (or rows) relative to its other
+     * dimension goes to TallSkinnySVD instead, see setTallSkinny().
+     */
+    template < typename Atom >
+    class SVDSolver : public core_library::UF< const petsc_cxx::Matrix< Atom >&, void >, public core_library::Printable
+    {
+    public:
+	enum Mode { Krylov, Randomized, Implicit, TallSkinny };
+
+	SVDSolver( SVDType type = SVDCROSS, MPI_Comm comm = PETSC_COMM_WORLD )
+	    : _mode(Krylov), _used(Krylov), _aspectRatio(100), _maxColumns(1000),
+	      _randomizedSVD(10, 10, 2, comm), _implicitSVD(ImplicitSVD::Automatic, 1.5, comm), _tallSkinnySVD(comm)
+	{
+	    SVDCreate( comm, &_solver );
+	    SVDSetFromOptions(_solver);
+	    SVDSetType(_solver, type);
+	}
+
+	~SVDSolver()
+	{
+	    SVDDestroy( _solver );
+	}
+
+	virtual void operator()( const petsc_cxx::Matrix< Atom >& A ) { solve( A ); }
+
+	void solve( Mat A )
+	{
+	    PetscInt nsv;
+	    SVDWhich which;
+
+	    SVDGetDimensions(_solver, &nsv, PETSC_NULL, PETSC_NULL);
+	    SVDGetWhichSingularTriplets(_solver, &which);
+	    _used = _mode;
+	    if ( _mode == Krylov && _aspectRatio > 0 && TallSkinnySVD::suited( A, _aspectRatio, _maxColumns ) ) { _used = TallSkinny; }
+
+	    switch ( _used )
+		{
+		case Randomized:
+		    _randomizedSVD.setRank( nsv );
+		    _randomizedSVD.solve( A );
+		    break;
+		case Implicit:
+		    _implicitSVD.solve( A, nsv, which == SVD_SMALLEST ? PETSC_TRUE : PETSC_FALSE );
+		    break;
+		case TallSkinny:
+		    _tallSkinnySVD.solve( A, nsv, which == SVD_SMALLEST ? PETSC_TRUE : PETSC_FALSE );
+		    break;
+		default:
+		    SVDSetOperator(_solver, A);
+		    SVDSolve(_solver);
+		}
+	}
+
+	// one pass of a randomized range finder instead of a Krylov method
+	void setRandomized( PetscTruth flag = PETSC_TRUE, PetscInt oversampling = 10, PetscInt powerIterations = 2 )
+	{
+	    _mode = flag ? Randomized : Krylov;
+	    _randomizedSVD.setOversampling( oversampling );
+	    _randomizedSVD.setPowerIterations( powerIterations );
+	}
+
+	// eigensolver on a shell A^H A or [0 A; A^H 0], never assembled
+	void setImplicit( PetscTruth flag = PETSC_TRUE, ImplicitSVD::Formulation formulation = ImplicitSVD::Automatic )
+	{
+	    _mode = flag ? Implicit : Krylov;
+	    _implicitSVD.setFormulation( formulation );
+	}
+
+	/*
+	 * Krylov mode only: TSQR is used when min(M,N) <= maxColumns and
+	 * max(M,N) >= aspectRatio min(M,N), one reduction tree replacing the
+	 * reductions of every Lanczos step. An aspect ratio of 0 disables it.
+	 */
+	void setTallSkinny( PetscReal aspectRatio, PetscInt maxColumns = 1000 )
+	{
+	    _aspectRatio = aspectRatio;
+	    _maxColumns = maxColumns;
+	}
+
+	Mode mode() const { return _mode; }
+
+	// the one used by the last solve
+	Mode used() const { return _used; }
+
+	RandomizedSVD& randomized() { return _randomizedSVD; }
+	ImplicitSVD& implicit() { return _implicitSVD; }
+	TallSkinnySVD& tallSkinny() { return _tallSkinnySVD; }
+
+	PetscInt getConverged() const
+	{
+	    PetscInt nconv;
+	    if ( _used == Randomized ) { return _randomizedSVD.getConverged(); }
+	    if ( _used == Implicit ) { return _implicitSVD.getConverged(); }
+	    if ( _used == TallSkinny ) { return _tallSkinnySVD.getConverged(); }
+	    SVDGetConverged( _solver, &nconv );
+	    return nconv;
+	}
+
+	void getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u = PETSC_NULL, Vec v = PETSC_NULL ) const
+	{
+	    if ( _used == Randomized ) { _randomizedSVD.getSingularTriplet( i, sigma, u, v ); }
+	    else if ( _used == Implicit ) { _implicitSVD.getSingularTriplet( i, sigma, u, v ); }
+	    else if ( _used == TallSkinny ) { _tallSkinnySVD.getSingularTriplet( i, sigma, u, v ); }
+	    else { SVDGetSingularTriplet( _solver, i, sigma, u, v ); }
+	}
+
+	PetscReal getRelativeError( PetscInt i ) const
+	{
+	    PetscReal error;
+	    if ( _used == Randomized ) { return _randomizedSVD.getRelativeError( i ); }
+	    if ( _used == Implicit ) { return _implicitSVD.getRelativeError( i ); }
+	    if ( _used == TallSkinny ) { return _tallSkinnySVD.getRelativeError( i ); }
+	    SVDComputeRelativeError( _solver, i, &error );
+	    return error;
+	}
+
+	operator SVD() const { return _solver; }
+
+	void printOn(std::ostream& os) const
+	{
+	    const SVDType type;
+	    PetscReal error, tol, sigma;
+	    PetscInt i, nsv, maxit, its, nconv;
+
+	    if ( _used == Randomized )
+		{
+		    _randomizedSVD.printOn( os );
+		}
+	    else if ( _used == Implicit )
+		{
+		    _implicitSVD.printOn( os );
+		}
+	    else if ( _used == TallSkinny )
+		{
+		    _tallSkinnySVD.printOn( os );
+		}
+	    else
+		{
+		    SVDGetIterationNumber(_solver,&its);
+		    PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);
+		    SVDGetType(_solver,&type);
+		    PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);
+		    SVDGetTolerances(_solver,&tol,&maxit);
+		    PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);
+		}
+	    SVDGetDimensions(_solver,&nsv,PETSC_NULL,PETSC_NULL);
+	    PetscPrintf(PETSC_COMM_WORLD," Number of requested singular values: %d\n",nsv);
+
+	    nconv = getConverged();
+	    PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate singular triplets: %d\n\n",nconv);
+
+	    if (nconv>0)
+		{
+		    PetscPrintf(PETSC_COMM_WORLD,
+				"          sigma           residual norm\n"
+				"  --------------------- ------------------\n" );
+		    for( i=0; i<nconv; i++ )
+			{
+			    getSingularTriplet(i,&sigma);
+			    error = getRelativeError(i);
+			    PetscPrintf(PETSC_COMM_WORLD,"       % 6f       % 12g\n",sigma,error);
+			}
+		    PetscPrintf(PETSC_COMM_WORLD,"\n" );
+		}
+	}
+
+    private:
+	SVDSolver( const SVDSolver& );
+	SVDSolver& operator=( const SVDSolver& );
+
+    private:
+	SVD _solver;
+	Mode _mode;
+	Mode _used;
+	PetscReal _aspectRatio;
+	PetscInt _maxColumns;
+	RandomizedSVD _randomizedSVD;
+	ImplicitSVD _implicitSVD;
+	TallSkinnySVD _tallSkinnySVD;
+    };
+}
+
+#endif // !_slepc_cxx_SVDSolver_h
@@ -0,0 +1,286 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <algorithm>
+
+#include "SlicedEllpack.h"
+
+#if !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_SCALAR_SINGLE) && !defined(PETSC_USE_SCALAR_LONG_DOUBLE)
+#  if defined(__AVX512F__)
+#    define SLEPC_CXX_SELL_AVX512
+#  elif defined(__AVX2__)
+#    define SLEPC_CXX_SELL_AVX2
+#  endif
+#endif
+
+#if defined(SLEPC_CXX_SELL_AVX512) || defined(SLEPC_CXX_SELL_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace slepc_cxx
+{
+#if defined(SLEPC_CXX_SELL_AVX512)
+    const PetscInt SlicedEllpack::Chunk = 8;
+#else
+    const PetscInt SlicedEllpack::Chunk = 4;
+#endif
+
+    namespace
+    {
+#if defined(SLEPC_CXX_SELL_AVX512)
+	const char* Kernel = "AVX-512";
+#elif defined(SLEPC_CXX_SELL_AVX2)
+	const char* Kernel = "AVX2";
+#else
+	const char* Kernel = "generic";
+#endif
+
+	// longer rows first
+	class Longer
+	{
+	public:
+	    Longer( const std::vector< PetscInt >& lengths ) : _lengths(lengths) {}
+
+	    bool operator()( PetscInt a, PetscInt b ) const { return _lengths[a] > _lengths[b]; }
+
+	private:
+	    const std::vector< PetscInt >& _lengths;
+	};
+    }
+
+    SlicedEllpack::SlicedEllpack( PetscInt sigma /*= 256*/ )
+	: _comm(PETSC_COMM_WORLD), _source(PETSC_NULL), _shell(PETSC_NULL), _state(-1), _sigma(sigma), _m(0), _n(0),
+	  _ghosts(PETSC_NULL), _scatter(PETSC_NULL), _is(PETSC_NULL),
+	  _nonzeros(0), _conversions(0), _products(0)
+    {}
+
+    SlicedEllpack::~SlicedEllpack()
+    {
+	destroy();
+	if ( _shell ) { MatDestroy( _shell ); }
+	if ( _source ) { MatDestroy( _source ); }
+    }
+
+    Mat SlicedEllpack::operator()( Mat A )
+    {
+	PetscInt state, M, N, m, n;
+
+	PetscObjectStateQuery( (PetscObject)A, &state );
+	if ( A == _source && state == _state ) { return _shell; }
+
+	convert( A );
+	++_conversions;
+
+	if ( A != _source )
+	    {
+		PetscObjectReference( (PetscObject)A );
+		if ( _source ) { MatDestroy( _source ); }
+		_source = A;
+		if ( _shell ) { MatDestroy( _shell ); }
+		PetscObjectGetComm( (PetscObject)A, &_comm );
+		MatGetSize( A, &M, &N );
+		MatGetLocalSize( A, &m, &n );
+		MatCreateShell( _comm, m, n, M, N, this, &_shell );
+		MatShellSetOperation( _shell, MATOP_MULT, (void(*)(void))mult );
+		MatShellSetOperation( _shell, MATOP_GET_DIAGONAL, (void(*)(void))getDiagonal );
+	    }
+
+	_state = state;
+	return _shell;
+    }
+
+    PetscReal SlicedEllpack::fill() const
+    {
+	return _nonzeros ? (PetscReal)_values.size() / _nonzeros : 1.0;
+    }
+
+    void SlicedEllpack::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Sliced ELLPACK: C=%d, sigma=%d, %s kernel, fill %.3f, conversions: %d, products: %d\n\n",
+		    Chunk,_sigma,Kernel,fill(),_conversions,_products);
+    }
+
+    void SlicedEllpack::convert( Mat A )
+    {
+	PetscInt rstart, rend, cstart, cend, row, ncols, k, c, j, r, width, chunks;
+	const PetscInt* cols;
+	const PetscScalar* vals;
+	Vec x;
+
+	destroy();
+	MatGetOwnershipRange( A, &rstart, &rend );
+	_m = rend - rstart;
+
+	// x is distributed as the columns, which need not follow the rows
+	MatGetOwnershipRangeColumn( A, &cstart, &cend );
+	_n = cend - cstart;
+
+	// lengths, diagonal and the columns owned by other ranks
+	std::vector< PetscInt > lengths( _m ), ghosts;
+	_diagonal.assign( _m, 0.0 );
+	_nonzeros = 0;
+	for ( row = rstart; row < rend; ++row )
+	    {
+		MatGetRow( A, row, &ncols, &cols, &vals );
+		lengths[row-rstart] = ncols;
+		_nonzeros += ncols;
+		for ( k = 0; k < ncols; ++k )
+		    {
+			if ( cols[k] == row ) { _diagonal[row-rstart] = vals[k]; }
+			if ( cols[k] < cstart || cols[k] >= cend ) { ghosts.push_back( cols[k] ); }
+		    }
+		MatRestoreRow( A, row, &ncols, &cols, &vals );
+	    }
+	std::sort( ghosts.begin(), ghosts.end() );
+	ghosts.erase( std::unique( ghosts.begin(), ghosts.end() ), ghosts.end() );
+
+	// sigma windows sorted by length, then cut into chunks
+	chunks = ( _m + Chunk - 1 ) / Chunk;
+	_rows.assign( chunks * Chunk, -1 );
+	for ( r = 0; r < _m; ++r ) { _rows[r] = r; }
+	for ( r = 0; _sigma > 1 && r < _m; r += _sigma )
+	    {
+		std::stable_sort( _rows.begin() + r, _rows.begin() + PetscMin( r + _sigma, _m ), Longer( lengths ) );
+	    }
+
+	_start.assign( chunks + 1, 0 );
+	for ( c = 0; c < chunks; ++c )
+	    {
+		for ( width = 0, r = 0; r < Chunk; ++r )
+		    {
+			if ( _rows[c*Chunk+r] >= 0 ) { width = PetscMax( width, lengths[_rows[c*Chunk+r]] ); }
+		    }
+		_start[c+1] = _start[c] + width * Chunk;
+	    }
+
+	// the padding multiplies x[0] by zero
+	_values.assign( _start[chunks], 0.0 );
+	_columns.assign( _start[chunks], 0 );
+	for ( c = 0; c < chunks; ++c )
+	    {
+		for ( r = 0; r < Chunk; ++r )
+		    {
+			if ( _rows[c*Chunk+r] < 0 ) { continue; }
+			row = rstart + _rows[c*Chunk+r];
+			MatGetRow( A, row, &ncols, &cols, &vals );
+			for ( j = 0; j < ncols; ++j )
+			    {
+				k = _start[c] + j * Chunk + r;
+				_values[k] = vals[j];
+				_columns[k] = cols[j] >= cstart && cols[j] < cend ? cols[j] - cstart
+				    : _n + ( std::lower_bound( ghosts.begin(), ghosts.end(), cols[j] ) - ghosts.begin() );
+			    }
+			MatRestoreRow( A, row, &ncols, &cols, &vals );
+		    }
+	    }
+
+	_x.assign( _n + ghosts.size() + 1, 0.0 );
+	VecCreateSeqWithArray( PETSC_COMM_SELF, ghosts.size(), &_x[_n], &_ghosts );
+	ISCreateGeneral( PETSC_COMM_SELF, ghosts.size(), ghosts.empty() ? PETSC_NULL : &ghosts[0], &_is );
+	MatGetVecs( A, &x, PETSC_NULL );
+	VecScatterCreate( x, _is, _ghosts, PETSC_NULL, &_scatter );
+	VecDestroy( x );
+    }
+
+    void SlicedEllpack::destroy()
+    {
+	if ( _scatter ) { VecScatterDestroy( _scatter ); _scatter = PETSC_NULL; }
+	if ( _is ) { ISDestroy( _is ); _is = PETSC_NULL; }
+	if ( _ghosts ) { VecDestroy( _ghosts ); _ghosts = PETSC_NULL; }
+    }
+
+    void SlicedEllpack::kernel( PetscScalar* y ) const
+    {
+	const PetscScalar* x = &_x[0];
+	PetscInt chunks = _start.size() - 1, c, k, r;
+	PetscScalar sum[8];
+
+	for ( c = 0; c < chunks; ++c )
+	    {
+#if defined(SLEPC_CXX_SELL_AVX512)
+		__m512d s = _mm512_setzero_pd();
+		for ( k = _start[c]; k < _start[c+1]; k += Chunk )
+		    {
+			__m256i idx = _mm256_loadu_si256( (const __m256i*)&_columns[k] );
+			s = _mm512_fmadd_pd( _mm512_loadu_pd( &_values[k] ), _mm512_i32gather_pd( idx, x, 8 ), s );
+		    }
+		_mm512_storeu_pd( sum, s );
+#elif defined(SLEPC_CXX_SELL_AVX2)
+		__m256d s = _mm256_setzero_pd();
+		for ( k = _start[c]; k < _start[c+1]; k += Chunk )
+		    {
+			__m128i idx = _mm_loadu_si128( (const __m128i*)&_columns[k] );
+#  if defined(__FMA__)
+			s = _mm256_fmadd_pd( _mm256_loadu_pd( &_values[k] ), _mm256_i32gather_pd( x, idx, 8 ), s );
+#  else
+			s = _mm256_add_pd( s, _mm256_mul_pd( _mm256_loadu_pd( &_values[k] ), _mm256_i32gather_pd( x, idx, 8 ) ) );
+#  endif
+		    }
+		_mm256_storeu_pd( sum, s );
+#else
+		for ( r = 0; r < Chunk; ++r ) { sum[r] = 0.0; }
+		for ( k = _start[c]; k < _start[c+1]; k += Chunk )
+		    {
+			for ( r = 0; r < Chunk; ++r ) { sum[r] += _values[k+r] * x[_columns[k+r]]; }
+		    }
+#endif
+		for ( r = 0; r < Chunk; ++r )
+		    {
+			if ( _rows[c*Chunk+r] >= 0 ) { y[_rows[c*Chunk+r]] = sum[r]; }
+		    }
+	    }
+    }
+
+    PetscErrorCode SlicedEllpack::mult( Mat shell, Vec x, Vec y )
+    {
+	SlicedEllpack* self;
+	PetscScalar *px, *py;
+	PetscInt r;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = VecScatterBegin( self->_scatter, x, self->_ghosts, INSERT_VALUES, SCATTER_FORWARD );CHKERRQ(ierr);
+	ierr = VecGetArray( x, &px );CHKERRQ(ierr);
+	for ( r = 0; r < self->_n; ++r ) { self->_x[r] = px[r]; }
+	ierr = VecRestoreArray( x, &px );CHKERRQ(ierr);
+	ierr = VecScatterEnd( self->_scatter, x, self->_ghosts, INSERT_VALUES, SCATTER_FORWARD );CHKERRQ(ierr);
+
+	ierr = VecGetArray( y, &py );CHKERRQ(ierr);
+	self->kernel( py );
+	ierr = VecRestoreArray( y, &py );CHKERRQ(ierr);
+	++self->_products;
+	PetscFunctionReturn(0);
+    }
+
+    PetscErrorCode SlicedEllpack::getDiagonal( Mat shell, Vec d )
+    {
+	SlicedEllpack* self;
+	PetscScalar* p;
+	PetscInt r;
+	PetscErrorCode ierr;
+
+	PetscFunctionBegin;
+	ierr = MatShellGetContext( shell, (void**)&self );CHKERRQ(ierr);
+	ierr = VecGetArray( d, &p );CHKERRQ(ierr);
+	for ( r = 0; r < self->_m; ++r ) { p[r] = self->_diagonal[r]; }
+	ierr = VecRestoreArray( d, &p );CHKERRQ(ierr);
+	PetscFunctionReturn(0);
+    }
+}
@@ -0,0 +1,111 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_SlicedEllpack_h
+#define _slepc_cxx_SlicedEllpack_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Shell operator behaving as A with its local rows held in SELL-C-sigma
+     * form: sorted by decreasing length within windows of sigma rows, then
+     * cut into chunks of Chunk rows stored column by column and padded to
+     * the longest row of the chunk. A product loads Chunk values and Chunk
+     * column indices at a time and gathers x for them, which maps onto one
+     * AVX2 or AVX-512 gather and multiply-add; the CSR rows of AIJ, of
+     * irregular lengths, do not vectorise.
+     *
+     * Chunk is the SIMD width in scalars: 8 with AVX-512, 4 otherwise,
+     * the intrinsics being used for real double precision only (configure
+     * with ENABLE_NATIVE). The entries of x owned by other ranks are
+     * gathered first, as MPIAIJ does.
+     *
+     * The conversion is made on the first use and kept until the state of A
+     * changes; A is referenced meanwhile, as in SpectralTransform. The shell only provides products and the diagonal, so it
+     * fits spectral transformations that do not factor the operator.
+     */
+    class SlicedEllpack : public core_library::Printable
+    {
+    public:
+	static const PetscInt Chunk;
+
+	SlicedEllpack( PetscInt sigma = 256 );
+	~SlicedEllpack();
+
+	// rows sorted within windows of sigma, 1 keeps their order, applies on the next conversion
+	void setSigma( PetscInt sigma ) { _sigma = sigma; _state = -1; }
+
+	// collective, the shell stays valid while A lives and until the next call
+	Mat operator()( Mat A );
+
+	// stored entries over the nonzeros, padding included
+	PetscReal fill() const;
+
+	void printOn(std::ostream&) const;
+
+    private:
+	SlicedEllpack( const SlicedEllpack& );
+	SlicedEllpack& operator=( const SlicedEllpack& );
+
+	void convert( Mat A );
+	void destroy();
+
+	// y = chunks of the sliced rows times _x
+	void kernel( PetscScalar* y ) const;
+
+	static PetscErrorCode mult( Mat shell, Vec x, Vec y );
+	static PetscErrorCode getDiagonal( Mat shell, Vec d );
+
+    private:
+	MPI_Comm _comm;
+	Mat _source;
+	Mat _shell;
+	PetscInt _state;
+	PetscInt _sigma;
+	PetscInt _m;
+	PetscInt _n;
+
+	// chunk c spans _start[c] to _start[c+1], entry (slot r, column j) at _start[c] + j * Chunk + r
+	std::vector< PetscInt > _start;
+	std::vector< PetscScalar > _values;
+	std::vector< int > _columns;
+
+	// local row of every slot, -1 for the padding of the last chunk
+	std::vector< PetscInt > _rows;
+	std::vector< PetscScalar > _diagonal;
+
+	// x as its _n local entries followed by the ghost ones
+	mutable std::vector< PetscScalar > _x;
+	Vec _ghosts;
+	VecScatter _scatter;
+	IS _is;
+
+	PetscInt _nonzeros;
+	PetscInt _conversions;
+	PetscInt _products;
+    };
+}
+
+#endif // !_slepc_cxx_SlicedEllpack_h
@@ -0,0 +1,220 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_SpectralTransform_h
+#define _slepc_cxx_SpectralTransform_h
+
+#include <slepceps.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Default policies of SpectralTransform: OP = A^-1, solved by the inner KSP,
+     * and the matching back transformation k = 1/k.
+     */
+    class InverseApply
+    {
+    public:
+	PetscErrorCode operator()( KSP ksp, Vec x, Vec y ) { return KSPSolve( ksp, x, y ); }
+    };
+
+    class InverseBackTransform
+    {
+    public:
+	PetscErrorCode operator()( PetscScalar* eigr, PetscScalar* /*eigi*/ )
+	{
+	    *eigr = 1.0 / *eigr;
+	    return 0;
+	}
+    };
+
+    /*
+     * Non-template interface used by EPSolver to drive any SpectralTransform.
+     */
+    class SpectralTransformBase
+    {
+    public:
+	virtual ~SpectralTransformBase() {}
+
+	// installs the transformation as the STSHELL of the given solver
+	virtual void attach( EPS eps ) = 0;
+
+	// called by EPSolver before each solve with the current operator
+	virtual void setUp( Mat A ) = 0;
+
+	virtual KSP ksp() const = 0;
+    };
+
+    /*
+     * RAII replacement of the SampleShellST context of the shell ST example.
+     *
+     * The inner KSP lives as long as the object, so successive EPSolver solves
+     * keep the same preconditioner: setUp() passes SAME_PRECONDITIONER when the
+     * operator and its PetscObjectState are unchanged. When the same operator
+     * was modified, the structure declared by setStructure() is passed,
+     * DIFFERENT_NONZERO_PATTERN unless the caller knows that the pattern was
+     * kept; a new operator is always DIFFERENT_NONZERO_PATTERN. The operator is
+     * referenced, so its address cannot be reused by another matrix. Apply and
+     * BackTransform are functors called with the inner KSP and with each
+     * computed eigenvalue.
+     */
+    template < typename Apply = InverseApply, typename BackTransform = InverseBackTransform >
+    class SpectralTransform : public SpectralTransformBase, public core_library::Printable
+    {
+    public:
+	SpectralTransform( Apply apply = Apply(), BackTransform backTransform = BackTransform(), MPI_Comm comm = PETSC_COMM_WORLD )
+	    : _apply(apply), _backTransform(backTransform),
+	      _operator(PETSC_NULL), _state(-1), _structure(DIFFERENT_NONZERO_PATTERN), _configured(PETSC_FALSE),
+	      _setups(0), _reuses(0), _applications(0), _innerIterations(0)
+	{
+	    KSPCreate( comm, &_ksp );
+	    KSPAppendOptionsPrefix( _ksp, "st_" );
+	}
+
+	~SpectralTransform()
+	{
+	    KSPDestroy( _ksp );
+	    if ( _operator ) { MatDestroy( _operator ); }
+	}
+
+	void attach( EPS eps )
+	{
+	    ST st;
+	    EPSGetST( eps, &st );
+	    STSetType( st, STSHELL );
+	    STShellSetApply( st, &SpectralTransform::apply );
+	    STShellSetBackTransform( st, &SpectralTransform::backTransform );
+	    STShellSetContext( st, this );
+	    PetscObjectSetName( (PetscObject)st, "SpectralTransform" );
+	}
+
+	void setUp( Mat A )
+	{
+	    PetscInt state;
+	    MatStructure flag = DIFFERENT_NONZERO_PATTERN;
+
+	    PetscObjectStateQuery( (PetscObject)A, &state );
+
+	    // the state changes with every modification, the nonzero count alone does not tell a new pattern
+	    if ( A == _operator )
+		{
+		    flag = ( state == _state ) ? SAME_PRECONDITIONER : _structure;
+		}
+	    else
+		{
+		    PetscObjectReference( (PetscObject)A );
+		    if ( _operator ) { MatDestroy( _operator ); }
+		}
+
+	    KSPSetOperators( _ksp, A, A, flag );
+
+	    if ( !_configured )
+		{
+		    KSPSetFromOptions( _ksp );
+		    _configured = PETSC_TRUE;
+		}
+
+	    if ( flag == SAME_PRECONDITIONER ) { ++_reuses; }
+	    else { ++_setups; }
+
+	    _operator = A;
+	    _state = state;
+	}
+
+	/*
+	 * How the values of the operator change between two solves, e.g.
+	 * SAME_NONZERO_PATTERN when only its values are updated in place. It is
+	 * the caller's promise, nothing checks it.
+	 */
+	void setStructure( MatStructure structure ) { _structure = structure; }
+
+	KSP ksp() const { return _ksp; }
+
+	Apply& applyFunctor() { return _apply; }
+	BackTransform& backTransformFunctor() { return _backTransform; }
+
+	// number of preconditioner (re)builds and of reuses across solves
+	PetscInt setups() const { return _setups; }
+	PetscInt reuses() const { return _reuses; }
+
+	// number of OP applications and total inner KSP iterations they cost
+	PetscInt applications() const { return _applications; }
+	PetscInt innerIterations() const { return _innerIterations; }
+
+	void resetCounters()
+	{
+	    _applications = 0;
+	    _innerIterations = 0;
+	}
+
+	void printOn(std::ostream&) const
+	{
+	    PetscPrintf(PETSC_COMM_WORLD," Preconditioner setups: %d, reuses: %d\n",_setups,_reuses);
+	    PetscPrintf(PETSC_COMM_WORLD," Inner solves: %d, inner iterations: %d",_applications,_innerIterations);
+	    if (_applications > 0)
+		{
+		    PetscPrintf(PETSC_COMM_WORLD," (%.2f per solve)",(double)_innerIterations/_applications);
+		}
+	    PetscPrintf(PETSC_COMM_WORLD,"\n\n");
+	}
+
+    private:
+	SpectralTransform( const SpectralTransform& );
+	SpectralTransform& operator=( const SpectralTransform& );
+
+	static PetscErrorCode apply( void* ctx, Vec x, Vec y )
+	{
+	    SpectralTransform* self = static_cast< SpectralTransform* >( ctx );
+	    PetscErrorCode ierr;
+	    PetscInt its;
+
+	    PetscFunctionBegin;
+	    ierr = self->_apply( self->_ksp, x, y );CHKERRQ(ierr);
+	    ierr = KSPGetIterationNumber( self->_ksp, &its );CHKERRQ(ierr);
+	    ++self->_applications;
+	    self->_innerIterations += its;
+	    PetscFunctionReturn(0);
+	}
+
+	static PetscErrorCode backTransform( void* ctx, PetscScalar* eigr, PetscScalar* eigi )
+	{
+	    SpectralTransform* self = static_cast< SpectralTransform* >( ctx );
+	    return self->_backTransform( eigr, eigi );
+	}
+
+    private:
+	Apply _apply;
+	BackTransform _backTransform;
+	KSP _ksp;
+
+	Mat _operator;
+	PetscInt _state;
+	MatStructure _structure;
+	PetscTruth _configured;
+
+	PetscInt _setups;
+	PetscInt _reuses;
+	PetscInt _applications;
+	PetscInt _innerIterations;
+    };
+}
+
+#endif // !_slepc_cxx_SpectralTransform_h
@@ -0,0 +1,145 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include "StationaryDistribution.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// drops the negative entries left by an extrapolation and scales the sum to one
+	void normalize( Vec x )
+	{
+	    PetscScalar* px;
+	    PetscScalar sum;
+	    PetscInt n, k;
+
+	    VecGetLocalSize( x, &n );
+	    VecGetArray( x, &px );
+	    for ( k = 0; k < n; ++k )
+		{
+		    if ( PetscRealPart( px[k] ) < 0 ) { px[k] = 0.0; }
+		}
+	    VecRestoreArray( x, &px );
+	    VecSum( x, &sum );
+	    VecScale( x, 1.0 / sum );
+	}
+    }
+
+    StationaryDistribution::StationaryDistribution( Orientation orientation /*= ColumnStochastic*/, MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _orientation(orientation), _tol(1e-10), _maxIterations(100000), _shift(1.0), _period(10),
+	  _x(PETSC_NULL), _transpose(PETSC_NULL), _source(PETSC_NULL), _state(-1),
+	  _iterations(0), _extrapolations(0), _residual(0), _ratio(0)
+    {}
+
+    StationaryDistribution::~StationaryDistribution()
+    {
+	if ( _x ) { VecDestroy( _x ); }
+	if ( _transpose ) { MatDestroy( _transpose ); }
+	if ( _source ) { MatDestroy( _source ); }
+    }
+
+    PetscTruth StationaryDistribution::solve( Mat A )
+    {
+	Mat B = columnStochastic( A );
+	PetscReal norm, previous = 0, last = 0;
+	PetscScalar sum;
+	PetscInt N;
+	Vec y, d, t;
+
+	if ( _x ) { VecDestroy( _x ); }
+	MatGetVecs( B, &_x, PETSC_NULL );
+	VecDuplicate( _x, &y );
+	VecDuplicate( _x, &d );
+	MatGetSize( B, &N, PETSC_NULL );
+	VecSet( _x, 1.0 / N );
+
+	_iterations = 0;
+	_extrapolations = 0;
+	_residual = _tol + 1;
+	_ratio = 0;
+
+	while ( _iterations < _maxIterations )
+	    {
+		MatMult( B, _x, y );
+		++_iterations;
+		if ( _shift != 0 ) { VecAXPBY( y, _shift / ( 1 + _shift ), 1 / ( 1 + _shift ), _x ); }
+
+		// y - x = (A x - x) / (1 + s), kept orthogonal to the left eigenvector of 1
+		VecWAXPY( d, -1.0, _x, y );
+		VecSum( d, &sum );
+		VecShift( d, -sum / (PetscReal)N );
+		VecNorm( d, NORM_1, &norm );
+		_residual = ( 1 + _shift ) * norm;
+
+		t = _x; _x = y; y = t;
+
+		if ( _residual < _tol ) { break; }
+
+		if ( previous > 0 )
+		    {
+			last = _ratio;
+			_ratio = norm / previous;
+		    }
+		previous = norm;
+
+		if ( _period > 0 && _iterations % _period == 0 && _ratio < 1 && PetscAbsReal( _ratio - last ) < 1e-3 * _ratio )
+		    {
+			VecAXPY( _x, _ratio / ( 1 - _ratio ), d );
+			normalize( _x );
+			++_extrapolations;
+			// the differences no longer follow the same geometric sequence
+			previous = 0;
+		    }
+	    }
+
+	normalize( _x );
+
+	VecDestroy( y );
+	VecDestroy( d );
+
+	return _residual < _tol ? PETSC_TRUE : PETSC_FALSE;
+    }
+
+    void StationaryDistribution::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," Stationary distribution: %d iterations (%d matrix-vector products, %d extrapolations)\n",
+		    _iterations,matvecs(),_extrapolations);
+	PetscPrintf(_comm," Residual ||Ax-x||_1: %g, subdominant ratio: %.6f\n\n",_residual,_ratio);
+    }
+
+    Mat StationaryDistribution::columnStochastic( Mat A )
+    {
+	PetscInt state;
+
+	if ( _orientation == ColumnStochastic ) { return A; }
+
+	PetscObjectStateQuery( (PetscObject)A, &state );
+	if ( _transpose && A == _source && state == _state ) { return _transpose; }
+
+	// the operator is referenced, so that its address cannot be reused by another matrix
+	PetscObjectReference( (PetscObject)A );
+	if ( _source ) { MatDestroy( _source ); }
+	_source = A;
+	if ( _transpose ) { MatDestroy( _transpose ); }
+	MatTranspose( A, MAT_INITIAL_MATRIX, &_transpose );
+	_state = state;
+	return _transpose;
+    }
+}
@@ -0,0 +1,106 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_StationaryDistribution_h
+#define _slepc_cxx_StationaryDistribution_h
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Stationary distribution of a Markov chain, i.e. the eigenvector of the
+     * known eigenvalue 1 of its column-stochastic operator.
+     *
+     * Since the eigenvalue is known, every step costs one matrix-vector
+     * product and one norm: x <- (A x + s x) / (1 + s) keeps the sum of x and
+     * the residual is ||A x - x||_1. The shift s > 0 moves the eigenvalues of
+     * periodic chains (e.g. -1 on bipartite graphs) away from the unit circle;
+     * s = 0 gives the plain power iteration. Every few steps, once the ratio
+     * of successive differences settles to an estimate r of the subdominant
+     * eigenvalue, the geometric tail r / (1 - r) (x_k - x_k-1) is added.
+     *
+     * The known eigenvalue 1 is deflated rather than solved for: its left
+     * eigenvector is the vector of ones, so the differences x_k - x_k-1, which
+     * sum to zero, follow the power iteration on the complement of x. Their
+     * sum is reset to zero at every step, and the ratio estimate and the
+     * extrapolation only see the subdominant eigenvalues. There is no Wielandt
+     * deflation of A itself, since its dominant vector is the wanted one.
+     *
+     * There is no separate column-stochastic format either: a row-stochastic
+     * operator is transposed once into an AIJ matrix, whose rows are the
+     * columns of the chain, so that the iteration uses MatMult rather than
+     * MatMultTranspose. The transpose is kept while the operator, referenced
+     * meanwhile, is unchanged.
+     */
+    class StationaryDistribution : public core_library::Printable
+    {
+    public:
+	enum Orientation { ColumnStochastic, RowStochastic };
+
+	StationaryDistribution( Orientation orientation = ColumnStochastic, MPI_Comm comm = PETSC_COMM_WORLD );
+	~StationaryDistribution();
+
+	// collective, returns PETSC_TRUE when the residual reached the tolerance
+	PetscTruth solve( Mat A );
+
+	// nonnegative, sums to one
+	Vec distribution() const { return _x; }
+
+	void setTolerances( PetscReal tol, PetscInt maxIterations ) { _tol = tol; _maxIterations = maxIterations; }
+	void setShift( PetscReal shift ) { _shift = shift; }
+
+	// extrapolates every period steps, 0 disables it
+	void setExtrapolation( PetscInt period ) { _period = period; }
+
+	PetscInt iterations() const { return _iterations; }
+	PetscInt matvecs() const { return _iterations; }
+	PetscReal residual() const { return _residual; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	StationaryDistribution( const StationaryDistribution& );
+	StationaryDistribution& operator=( const StationaryDistribution& );
+
+	Mat columnStochastic( Mat A );
+
+    private:
+	MPI_Comm _comm;
+	Orientation _orientation;
+	PetscReal _tol;
+	PetscInt _maxIterations;
+	PetscReal _shift;
+	PetscInt _period;
+
+	Vec _x;
+	Mat _transpose;
+	Mat _source;
+	PetscInt _state;
+
+	PetscInt _iterations;
+	PetscInt _extrapolations;
+	PetscReal _residual;
+	PetscReal _ratio;
+    };
+}
+
+#endif // !_slepc_cxx_StationaryDistribution_h
@@ -0,0 +1,228 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <stdexcept>
+
+#include <petscblaslapack.h>
+
+#include "SVDResidual.h"
+#include "TallSkinnySVD.h"
+
+namespace slepc_cxx
+{
+    namespace
+    {
+	// Householder QR of the rows x N block W (leading dimension ld), R is N x N upper triangular
+	void factor( std::vector< PetscScalar >& W, PetscInt rows, PetscInt ld, PetscInt N, std::vector< PetscScalar >& R )
+	{
+	    PetscBLASInt m = rows, n = N, lda = ld, lwork = 64 * N, info;
+	    std::vector< PetscScalar > tau( N ), work( lwork );
+	    PetscInt i, j;
+
+	    LAPACKgeqrf_( &m, &n, &W[0], &lda, &tau[0], &work[0], &lwork, &info );
+	    if ( info ) { throw std::runtime_error( "TallSkinnySVD: xGEQRF failed" ); }
+
+	    R.assign( N * N, 0.0 );
+	    for ( j = 0; j < N; ++j )
+		{
+		    for ( i = 0; i <= j && i < rows; ++i ) { R[i+j*N] = W[i+j*ld]; }
+		}
+	}
+    }
+
+    TallSkinnySVD::TallSkinnySVD( MPI_Comm comm /*= PETSC_COMM_WORLD*/ )
+	: _comm(comm), _A(PETSC_NULL), _B(PETSC_NULL), _transposed(PETSC_FALSE), _N(0), _nsv(0), _smallest(PETSC_FALSE), _levels(0)
+    {}
+
+    TallSkinnySVD::~TallSkinnySVD()
+    {
+	if ( _transposed ) { MatDestroy( _B ); }
+    }
+
+    void TallSkinnySVD::solve( Mat A, PetscInt nsv /*= 1*/, PetscTruth smallest /*= PETSC_FALSE*/ )
+    {
+	PetscInt M, N;
+	PetscMPIInt rank;
+	PetscBLASInt info = 0;
+	std::vector< PetscScalar > R;
+
+	if ( _transposed ) { MatDestroy( _B ); }
+
+	MatGetSize( A, &M, &N );
+	_A = A;
+	_transposed = N > M ? PETSC_TRUE : PETSC_FALSE;
+	if ( _transposed ) { MatTranspose( A, MAT_INITIAL_MATRIX, &_B ); }
+	else { _B = A; }
+	_N = PetscMin( M, N );
+	_nsv = PetscMin( nsv, _N );
+	_smallest = smallest;
+
+	reduce( R );
+
+	_sigma.assign( _N, 0 );
+	_VT.assign( _N * _N, 0.0 );
+	MPI_Comm_rank( _comm, &rank );
+	if ( !rank )
+	    {
+		PetscBLASInt n = _N, one = 1, lwork = 10 * _N;
+		std::vector< PetscScalar > work( lwork );
+		std::vector< PetscReal > rwork( 5 * _N );
+		PetscScalar dummy;
+#ifndef PETSC_USE_COMPLEX
+		LAPACKgesvd_( "N", "A", &n, &n, &R[0], &n, &_sigma[0], &dummy, &one, &_VT[0], &n, &work[0], &lwork, &info );
+#else
+		LAPACKgesvd_( "N", "A", &n, &n, &R[0], &n, &_sigma[0], &dummy, &one, &_VT[0], &n, &work[0], &lwork, &rwork[0], &info );
+#endif
+	    }
+	MPI_Bcast( &info, 1, MPI_INT, 0, _comm );
+	if ( info ) { throw std::runtime_error( "TallSkinnySVD: xGESVD failed" ); }
+	MPI_Bcast( &_sigma[0], _N, MPIU_REAL, 0, _comm );
+	MPI_Bcast( &_VT[0], _N * _N, MPIU_SCALAR, 0, _comm );
+    }
+
+    PetscTruth TallSkinnySVD::suited( Mat A, PetscReal aspectRatio, PetscInt maxColumns )
+    {
+	PetscInt M, N;
+
+	MatGetSize( A, &M, &N );
+	return PetscMin( M, N ) <= maxColumns && (PetscReal)PetscMax( M, N ) >= aspectRatio * PetscMin( M, N ) ? PETSC_TRUE : PETSC_FALSE;
+    }
+
+    void TallSkinnySVD::getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u /*= PETSC_NULL*/, Vec v /*= PETSC_NULL*/ ) const
+    {
+	PetscInt k = _smallest ? _N - 1 - i : i, first, last, j;
+	PetscScalar* p;
+	PetscReal norm;
+	Vec x, y;
+
+	*sigma = _sigma[k];
+	if ( !u && !v ) { return; }
+
+	// x = row k of VT^H, y = B x / sigma
+	MatGetVecs( _B, &x, &y );
+	VecGetOwnershipRange( x, &first, &last );
+	VecGetArray( x, &p );
+	for ( j = first; j < last; ++j ) { p[j-first] = PetscConj( _VT[k+j*_N] ); }
+	VecRestoreArray( x, &p );
+	MatMult( _B, x, y );
+	VecNormalize( y, &norm );
+
+	// A^T = X S Y^H gives A = conj(Y) S conj(X)^H
+	if ( _transposed )
+	    {
+#ifdef PETSC_USE_COMPLEX
+		VecConjugate( x );
+		VecConjugate( y );
+#endif
+		if ( u ) { VecCopy( x, u ); }
+		if ( v ) { VecCopy( y, v ); }
+	    }
+	else
+	    {
+		if ( u ) { VecCopy( y, u ); }
+		if ( v ) { VecCopy( x, v ); }
+	    }
+
+	VecDestroy( x );
+	VecDestroy( y );
+    }
+
+    PetscReal TallSkinnySVD::getRelativeError( PetscInt i ) const
+    {
+	PetscReal sigma, error;
+	Vec u, v;
+
+	MatGetVecs( _A, &v, &u );
+	getSingularTriplet( i, &sigma, u, v );
+	error = relativeError( _A, sigma, u, v );
+	VecDestroy( u );
+	VecDestroy( v );
+	return error;
+    }
+
+    void TallSkinnySVD::printOn(std::ostream&) const
+    {
+	PetscPrintf(_comm," TSQR SVD: %d columns%s, %d reduction levels, singular values in [%g, %g]\n\n",
+		    _N,_transposed ? " (of the transpose)" : "",_levels,_N ? _sigma[_N-1] : 0,_N ? _sigma[0] : 0);
+    }
+
+    void TallSkinnySVD::localFactor( std::vector< PetscScalar >& R ) const
+    {
+	PetscInt N = _N, chunk = PetscMax( 4 * N, 256 ), ld = N + chunk, first, last, row, r, i, j, ncols;
+	const PetscInt* cols;
+	const PetscScalar* vals;
+	std::vector< PetscScalar > W;
+
+	R.assign( N * N, 0.0 );
+	MatGetOwnershipRange( _B, &first, &last );
+
+	// [R; next chunk of rows] -> R
+	for ( row = first; row < last; )
+	    {
+		W.assign( ld * N, 0.0 );
+		for ( j = 0; j < N; ++j )
+		    {
+			for ( i = 0; i <= j; ++i ) { W[i+j*ld] = R[i+j*N]; }
+		    }
+		for ( r = 0; r < chunk && row < last; ++r, ++row )
+		    {
+			MatGetRow( _B, row, &ncols, &cols, &vals );
+			for ( j = 0; j < ncols; ++j ) { W[N+r+cols[j]*ld] = vals[j]; }
+			MatRestoreRow( _B, row, &ncols, &cols, &vals );
+		    }
+		factor( W, N + r, ld, N, R );
+	    }
+    }
+
+    void TallSkinnySVD::reduce( std::vector< PetscScalar >& R )
+    {
+	PetscMPIInt rank, size, step;
+	PetscInt N = _N, i, j;
+	std::vector< PetscScalar > other( N * N ), W( 2 * N * N );
+	MPI_Status status;
+
+	MPI_Comm_rank( _comm, &rank );
+	MPI_Comm_size( _comm, &size );
+	localFactor( R );
+
+	for ( _levels = 0; ( 1 << _levels ) < size; ++_levels ) {}
+
+	for ( step = 1; step < size; step *= 2 )
+	    {
+		if ( rank % ( 2 * step ) == step )
+		    {
+			MPI_Send( &R[0], N * N, MPIU_SCALAR, rank - step, 0, _comm );
+			break;
+		    }
+		if ( rank % ( 2 * step ) == 0 && rank + step < size )
+		    {
+			MPI_Recv( &other[0], N * N, MPIU_SCALAR, rank + step, 0, _comm, &status );
+			for ( j = 0; j < N; ++j )
+			    {
+				for ( i = 0; i < N; ++i )
+				    {
+					W[i+j*2*N] = R[i+j*N];
+					W[N+i+j*2*N] = other[i+j*N];
+				    }
+			    }
+			factor( W, 2 * N, 2 * N, N, R );
+		    }
+	    }
+    }
+}
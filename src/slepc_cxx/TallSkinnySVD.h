@@ -0,0 +1,98 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_TallSkinnySVD_h
+#define _slepc_cxx_TallSkinnySVD_h
+
+#include <vector>
+
+#include <petscmat.h>
+
+#include <core_library/Printable.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Full SVD of a matrix with few columns (or few rows) from a tall-skinny
+     * QR, TSQR.
+     *
+     * Every rank streams its rows through a Householder QR by chunks, so the
+     * dense copy never exceeds a few N x N blocks, then the local R factors
+     * are combined pairwise along a binary tree: log2(P) messages of N^2
+     * scalars, against one reduction per Lanczos step for a Krylov method.
+     * The SVD of the final R on rank 0 gives the singular values and right
+     * vectors, which are broadcast; a left vector costs one MatMult, A v / s,
+     * so the small singular values keep the accuracy of the backward stable
+     * R but their left vectors do not.
+     *
+     * A wide matrix is transposed once explicitly and its triplets swapped.
+     */
+    class TallSkinnySVD : public core_library::Printable
+    {
+    public:
+	TallSkinnySVD( MPI_Comm comm = PETSC_COMM_WORLD );
+	~TallSkinnySVD();
+
+	// collective, the nsv largest (or smallest) triplets are kept, A must outlive them
+	void solve( Mat A, PetscInt nsv = 1, PetscTruth smallest = PETSC_FALSE );
+
+	// the min(M,N) of A is small enough and max(M,N) / min(M,N) large enough
+	static PetscTruth suited( Mat A, PetscReal aspectRatio, PetscInt maxColumns );
+
+	PetscInt getConverged() const { return _nsv; }
+
+	// u and v may be PETSC_NULL
+	void getSingularTriplet( PetscInt i, PetscReal* sigma, Vec u = PETSC_NULL, Vec v = PETSC_NULL ) const;
+
+	// collective, see relativeError()
+	PetscReal getRelativeError( PetscInt i ) const;
+
+	// all the min(M,N) singular values, decreasing
+	const std::vector< PetscReal >& singularValues() const { return _sigma; }
+
+	PetscInt levels() const { return _levels; }
+
+	void printOn(std::ostream&) const;
+
+    private:
+	TallSkinnySVD( const TallSkinnySVD& );
+	TallSkinnySVD& operator=( const TallSkinnySVD& );
+
+	// R of the local rows of _B
+	void localFactor( std::vector< PetscScalar >& R ) const;
+
+	// R of the whole _B on rank 0
+	void reduce( std::vector< PetscScalar >& R );
+
+    private:
+	MPI_Comm _comm;
+	Mat _A;
+	Mat _B;
+	PetscTruth _transposed;
+	PetscInt _N;
+	PetscInt _nsv;
+	PetscTruth _smallest;
+	PetscInt _levels;
+
+	std::vector< PetscReal > _sigma;
+	std::vector< PetscScalar > _VT;
+    };
+}
+
+#endif // !_slepc_cxx_TallSkinnySVD_h
@@ -0,0 +1,94 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ * Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _slepc_cxx_TextParsing_h
+#define _slepc_cxx_TextParsing_h
+
+#include <cstdlib>
+#include <cctype>
+
+#include <petscsys.h>
+
+namespace slepc_cxx
+{
+    /*
+     * Scanning helpers over a memory-mapped text, which is not null-terminated.
+     */
+    namespace text
+    {
+	// offset following the end of the line containing k
+	inline size_t nextLine( const char* p, size_t k, size_t end )
+	{
+	    while ( k < end && p[k] != '\n' ) { ++k; }
+	    return k < end ? k + 1 : end;
+	}
+
+	// first line starting in [k, end), ranges cut anywhere agree on line ownership
+	inline size_t lineStart( const char* p, size_t first, size_t k, size_t end )
+	{
+	    if ( k <= first ) { return first; }
+	    if ( p[k-1] == '\n' ) { return k; }
+	    return nextLine( p, k, end );
+	}
+
+	// the part-th of parts line-aligned slices of [first, last)
+	inline void slice( const char* p, size_t first, size_t last, size_t part, size_t parts, size_t* begin, size_t* end )
+	{
+	    size_t length = last - first;
+	    *begin = lineStart( p, first, first + ( length * part ) / parts, last );
+	    *end = lineStart( p, first, first + ( length * ( part + 1 ) ) / parts, last );
+	}
+
+	inline const char* skipBlanks( const char* p, const char* end )
+	{
+	    while ( p < end && ( *p == ' ' || *p == '\t' || *p == '\r' ) ) { ++p; }
+	    return p;
+	}
+
+	inline bool parseInteger( const char*& p, const char* end, long long& value )
+	{
+	    bool negative = false;
+	    p = skipBlanks( p, end );
+	    if ( p < end && ( *p == '-' || *p == '+' ) ) { negative = ( *p == '-' ); ++p; }
+	    if ( p >= end || !isdigit( *p ) ) { return false; }
+	    for ( value = 0; p < end && isdigit( *p ); ++p ) { value = 10 * value + ( *p - '0' ); }
+	    if ( negative ) { value = -value; }
+	    return true;
+	}
+
+	// the token is copied before strtod
+	inline bool parseReal( const char*& p, const char* end, PetscReal& value )
+	{
+	    char token[64];
+	    size_t n = 0;
+	    p = skipBlanks( p, end );
+	    while ( p < end && n < sizeof(token) - 1 && !isspace( *p ) ) { token[n++] = *p++; }
+	    if ( n == 0 ) { return false; }
+	    token[n] = '\0';
+
+	    char* last;
+	    PetscReal parsed = strtod( token, &last );
+	    if ( *last != '\0' ) { return false; }
+	    value = parsed;
+	    return true;
+	}
+    }
+}
+
+#endif // !_slepc_cxx_TextParsing_h
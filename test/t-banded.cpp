@@ -0,0 +1,93 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Solves the 1-D Laplacian eigenproblem of t-ex1 stored as AIJ, as a banded shell and with the banded direct solver.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions = matrix dimension.\n"
+  "  -nev <k>, where <k> = number of largest eigenpairs wanted.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat A;
+    PetscInt n=10000, nev=10, Istart, Iend, i;
+    PetscLogDouble t0, t1, t2, t3, t4, t5;
+    PetscReal error = 0;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-nev",&nev,PETSC_NULL);
+    PetscPrintf(PETSC_COMM_WORLD,"\n1-D Laplacian Eigenproblem, n=%d, %d eigenpairs\n\n",n,nev);
+
+    MatCreate(PETSC_COMM_WORLD,&A);
+    MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n,n);
+    MatSetFromOptions(A);
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for( i=Istart; i<Iend; i++ )
+	{
+	    if(i>0) { MatSetValue(A,i,i-1,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(A,i,i+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(A,i,i,2.0,INSERT_VALUES);
+	}
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+
+    // the same rows, stored by diagonal
+    slepc_cxx::BandedMatrix B(A);
+
+    slepc_cxx::EPSolver<T> aij;
+    EPSSetDimensions(aij,nev,PETSC_DECIDE,PETSC_DECIDE);
+
+    PetscGetTime(&t0);
+    aij.solve(A);
+    PetscGetTime(&t1);
+
+    std::cout << aij;
+
+    slepc_cxx::EPSolver<T> banded;
+    EPSSetDimensions(banded,nev,PETSC_DECIDE,PETSC_DECIDE);
+
+    PetscGetTime(&t2);
+    banded.solve(B);
+    PetscGetTime(&t3);
+
+    std::cout << B;
+
+    slepc_cxx::BandedEigensolver direct;
+
+    PetscGetTime(&t4);
+    direct.solve(B,nev);
+    PetscGetTime(&t5);
+
+    std::cout << direct;
+
+    for ( i = 0; i < direct.getConverged(); i++ ) { error = PetscMax(error,direct.getRelativeError(i)); }
+
+    PetscPrintf(PETSC_COMM_WORLD," AIJ Krylov:      %10.3f s, %d eigenpairs\n",t1-t0,aij.getConverged());
+    PetscPrintf(PETSC_COMM_WORLD," Banded Krylov:   %10.3f s, %d eigenpairs\n",t3-t2,banded.getConverged());
+    PetscPrintf(PETSC_COMM_WORLD," Banded direct:   %10.3f s, %d eigenpairs, largest relative error %9.2e\n\n",t5-t4,direct.getConverged(),error);
+
+    MatDestroy(A);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Times the 1-D Laplacian eigenproblem of t-ex1 with SLEPc and with the dense LAPACK fallback for growing sizes, to calibrate EPSolver::setDense().\n\n"
+  "The command line options are:\n"
+  "  -min <a>, -max <b>, where the matrix dimension doubles from a up to b.\n"
+  "  -repeat <r>, where <r> = number of solves averaged for each timing.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+// the tridiagonal (-1, 2, -1) matrix of order n
+static void laplacian(Mat* A, PetscInt n)
+{
+    PetscInt Istart, Iend, i;
+
+    MatCreate(PETSC_COMM_WORLD,A);
+    MatSetSizes(*A,PETSC_DECIDE,PETSC_DECIDE,n,n);
+    MatSetFromOptions(*A);
+    MatGetOwnershipRange(*A,&Istart,&Iend);
+    for( i=Istart; i<Iend; i++ )
+	{
+	    if(i>0) { MatSetValue(*A,i,i-1,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(*A,i,i+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(*A,i,i,2.0,INSERT_VALUES);
+	}
+    MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);
+}
+
+// mean wall time of r solves, the largest eigenvalue found through k
+static PetscLogDouble timing(Mat A, PetscInt maxSize, PetscInt r, PetscScalar* k)
+{
+    PetscLogDouble t0, t1, total=0;
+    PetscScalar ki;
+
+    *k = 0;
+    for ( PetscInt i = 0; i < r; i++ )
+	{
+	    slepc_cxx::EPSolver<T> eps;
+	    eps.setDense(maxSize);
+
+	    PetscGetTime(&t0);
+	    eps.solve(A);
+	    PetscGetTime(&t1);
+	    total += t1-t0;
+
+	    if (eps.getConverged() > 0) { eps.getEigenpair(0,k,&ki); }
+	}
+    return total/r;
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat A;
+    PetscInt n, from=16, to=1024, repeat=3, crossover=0;
+    PetscLogDouble krylov, dense;
+    PetscScalar kk, kd;
+
+    PetscOptionsGetInt(PETSC_NULL,"-min",&from,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-max",&to,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-repeat",&repeat,PETSC_NULL);
+    PetscPrintf(PETSC_COMM_WORLD,"\nStandard symmetric eigenproblem, 1-D Laplacian, %d solves per timing\n\n",repeat);
+
+    PetscPrintf(PETSC_COMM_WORLD,"      n          SLEPc            dense         largest eigenvalue\n");
+    PetscPrintf(PETSC_COMM_WORLD," -------- ---------------- ---------------- --------------------------\n");
+    for ( n = from; n <= to; n *= 2 )
+	{
+	    laplacian(&A,n);
+	    krylov = timing(A,0,repeat,&kk);
+	    dense = timing(A,n,repeat,&kd);
+	    MatDestroy(A);
+
+	    // the largest size up to which the dense solve keeps winning
+	    if (dense < krylov && (n == from || crossover == n/2)) { crossover = n; }
+
+	    PetscPrintf(PETSC_COMM_WORLD," %8d %12.6f s   %12.6f s   %12f %12f\n",n,krylov,dense,PetscRealPart(kk),PetscRealPart(kd));
+	}
+
+    if (crossover > 0)
+	{
+	    PetscPrintf(PETSC_COMM_WORLD,"\n The dense solve is faster up to n=%d, use EPSolver::setDense(%d)\n\n",crossover,crossover);
+	}
+    else
+	{
+	    PetscPrintf(PETSC_COMM_WORLD,"\n SLEPc is faster from n=%d, use EPSolver::setDense(0)\n\n",from);
+	}
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cstdlib>
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Compares a cold start with the multilevel initial space for the Fiedler vector.\n\n"
+  "The graph is a 2-D regular mesh with extra random edges between close vertices. "
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions in each dimension.\n"
+  "  -extra <e>, where <e> = number of extra edges per vertex.\n"
+  "  -coarse <c>, where <c> = largest size of the coarsest graph.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt n=300, extra=1, coarse=1000, N, i, j, k, e, II, Istart, Iend, its0, its1;
+    PetscMPIInt rank;
+    PetscLogDouble t0, t1, t2, t3;
+    Mat L;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-extra",&extra,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-coarse",&coarse,PETSC_NULL);
+
+    N = n*n;
+    PetscPrintf(PETSC_COMM_WORLD,"\nFiedler vector of a %dx%d mesh with %d extra edges per vertex, N=%d\n\n",n,n,extra,N);
+
+    MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+    srand(rank+1);
+
+    slepc_cxx::GraphLaplacian graph(N);
+
+    k = PETSC_DECIDE;
+    PetscSplitOwnership(PETSC_COMM_WORLD,&k,&N);
+    MPI_Scan(&k,&Iend,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);
+    Istart = Iend-k;
+
+    for( II=Istart; II<Iend; II++ )
+	{
+	    i = II/n; j = II-i*n;
+	    if(i<n-1) { graph.addEdge(II,II+n); }
+	    if(j<n-1) { graph.addEdge(II,II+1); }
+	    for( e=0; e<extra; e++ )
+		{
+		    PetscInt di = rand()%5-2, dj = rand()%5-2;
+		    if(i+di>=0 && i+di<n && j+dj>=0 && j+dj<n) { graph.addEdge(II,(i+di)*n+j+dj,0.5); }
+		}
+	}
+
+    graph.assemble(&L);
+
+    std::cout << graph;
+
+    // cold start
+    PetscGetTime(&t0);
+    {
+	slepc_cxx::EPSolver<T> eps(EPSKRYLOVSCHUR);
+	EPSSetWhichEigenpairs(eps,EPS_SMALLEST_REAL);
+	EPSSetFromOptions(eps);
+	graph.deflate(eps);
+	eps.solve(L);
+	EPSGetIterationNumber(eps,&its0);
+	std::cout << eps;
+    }
+    PetscGetTime(&t1);
+
+    // multilevel initial space
+    slepc_cxx::MultilevelFiedler fiedler(coarse);
+    fiedler.compute(L,graph.nullspace());
+    PetscGetTime(&t2);
+    {
+	slepc_cxx::EPSolver<T> eps(EPSKRYLOVSCHUR);
+	EPSSetWhichEigenpairs(eps,EPS_SMALLEST_REAL);
+	EPSSetFromOptions(eps);
+	graph.deflate(eps);
+	fiedler.initialize(eps);
+	eps.solve(L);
+	EPSGetIterationNumber(eps,&its1);
+	std::cout << eps;
+    }
+    PetscGetTime(&t3);
+
+    std::cout << fiedler;
+
+    PetscPrintf(PETSC_COMM_WORLD," Cold start:  %10.3f s, %d iterations\n",t1-t0,its0);
+    PetscPrintf(PETSC_COMM_WORLD," Multilevel:  %10.3f s (setup %.3f s), %d iterations\n\n",t3-t1,t2-t1,its1);
+
+    MatDestroy(L);
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+#include "tall_matrix.h"
+
+static char help[] = "Streams the rows of a tall sparse matrix into an incremental SVD and compares it to a full recomputation.\n\n"
+  "The command line options are:\n"
+  "  -m <m>, where <m> = number of rows.\n"
+  "  -n <n>, where <n> = number of columns.\n"
+  "  -batch <b>, where <b> = number of rows of each batch.\n"
+  "  -k <k>, where <k> = rank of the factorisation.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt m=100000, n=200, b=5000, k=10, row, i;
+    PetscReal sigma, reference, difference=0, alignment=1;
+    PetscScalar dot;
+    PetscLogDouble t0, t1, tIncremental=0, tFull;
+    Mat A, B;
+    Vec v, w;
+
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-batch",&b,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-k",&k,PETSC_NULL);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nRank %d SVD of a %dx%d sparse matrix streamed in batches of %d rows\n\n",k,m,n,b);
+
+    // only one batch is alive at a time
+    slepc_cxx::IncrementalSVD incremental(k);
+    for( row=0; row<m; row+=b )
+	{
+	    B = tallMatrix(PETSC_COMM_WORLD,PetscMin(b,m-row),n,row);
+	    PetscGetTime(&t0);
+	    incremental.update(B);
+	    PetscGetTime(&t1);
+	    tIncremental += t1-t0;
+	    MatDestroy(B);
+	}
+
+    // the whole matrix at once, recomputed with the Krylov method rather than TSQR
+    A = tallMatrix(PETSC_COMM_WORLD,m,n);
+    slepc_cxx::SVDSolver<T> full;
+    full.setTallSkinny(0);
+    SVDSetDimensions(full,k,PETSC_DECIDE,PETSC_DECIDE);
+    PetscGetTime(&t0);
+    full.solve(A);
+    PetscGetTime(&t1);
+    tFull = t1-t0;
+
+    std::cout << incremental;
+    std::cout << full;
+
+    PetscPrintf(PETSC_COMM_WORLD," Incremental: %10.3f s, %12.0f rows/s\n",tIncremental,m/tIncremental);
+    PetscPrintf(PETSC_COMM_WORLD," Full:        %10.3f s, %12.0f rows/s, %10.3f s if recomputed after every batch\n\n",
+		tFull,m/tFull,tFull*(m+b-1)/b);
+
+    // singular values and right singular vectors, up to a unit factor
+    MatGetVecs(A,&v,PETSC_NULL);
+    VecDuplicate(v,&w);
+    for( i=0; i<PetscMin(incremental.getConverged(),full.getConverged()); i++ )
+	{
+	    full.getSingularTriplet(i,&reference,PETSC_NULL,v);
+	    incremental.getSingularTriplet(i,&sigma,w);
+	    VecDot(v,w,&dot);
+	    difference = PetscMax(difference,PetscAbsReal(sigma-reference)/reference);
+	    alignment = PetscMin(alignment,PetscAbsScalar(dot));
+	    PetscPrintf(PETSC_COMM_WORLD,"   %12g   %12g\n",sigma,reference);
+	}
+    PetscPrintf(PETSC_COMM_WORLD,"\n Largest relative difference of the singular values: %g\n",difference);
+    PetscPrintf(PETSC_COMM_WORLD," Smallest |v_incremental^H v_full|: %g\n",alignment);
+    PetscPrintf(PETSC_COMM_WORLD," Truncation error: %g\n\n",incremental.truncationError());
+
+    VecDestroy(v);
+    VecDestroy(w);
+    MatDestroy(A);
+
+    return 0;
+}
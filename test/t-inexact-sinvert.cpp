@@ -0,0 +1,102 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Compares exact and inexact shift-and-invert on the 1-D Laplacian.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions = matrix dimension.\n"
+  "  -factor <f>, where <f> = ratio between inner tolerance and outer residual.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt n=1000, i, Istart, Iend, col[3], exactIts, inexactIts, nconv;
+    PetscReal factor=1e-2, tol=1e-8, error=0, difference=0;
+    PetscScalar value[3], kr, ki;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-factor",&factor,PETSC_NULL);
+
+    petsc_cxx::Matrix<T> A(n);
+
+    MatGetOwnershipRange(A,&Istart,&Iend);
+
+    for( i = Istart; i < Iend; i++ )
+	{
+	    col[0]=i-1; col[1]=i; col[2]=i+1;
+	    value[0]=-1.0; value[1]=2.0; value[2]=-1.0;
+	    if (i==0) { MatSetValues(A,1,&i,2,col+1,value+1,INSERT_VALUES); }
+	    else if (i==n-1) { MatSetValues(A,1,&i,2,col,value,INSERT_VALUES); }
+	    else { MatSetValues(A,1,&i,3,col,value,INSERT_VALUES); }
+	}
+
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+
+    slepc_cxx::SpectralTransform<> st;
+
+    slepc_cxx::EPSolver<T> eps;
+    EPSSetTolerances(eps,tol,PETSC_DEFAULT);
+    eps.setSpectralTransform( st );
+
+    // reference: every inner solve to a tenth of the outer tolerance
+    KSPSetTolerances(st.ksp(),0.1*tol,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);
+
+    eps(A);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nExact shift-and-invert\n\n");
+    std::cout << eps;
+    std::cout << st;
+    exactIts = st.innerIterations();
+
+    std::vector<PetscScalar> exact(eps.getConverged());
+    for( i = 0; i < (PetscInt)exact.size(); i++ ) { eps.getEigenpair(i,&exact[i],&ki); }
+
+    st.resetCounters();
+    eps.setInexact();
+    eps.inexact().setFactor( factor );
+
+    eps(A);
+
+    PetscPrintf(PETSC_COMM_WORLD,"Inexact shift-and-invert\n\n");
+    std::cout << eps;
+    std::cout << st;
+    std::cout << eps.inexact();
+    inexactIts = st.innerIterations();
+
+    // the loose inner solves must not cost accuracy: residuals at the outer tolerance, same eigenvalues
+    nconv = PetscMin(eps.getConverged(),(PetscInt)exact.size());
+    for( i = 0; i < nconv; i++ )
+	{
+	    eps.getEigenpair(i,&kr,&ki);
+	    error = PetscMax(error,eps.getRelativeError(i));
+	    difference = PetscMax(difference,PetscAbsScalar(kr-exact[i])/PetscAbsScalar(exact[i]));
+	}
+
+    PetscPrintf(PETSC_COMM_WORLD," Inner iterations: exact %d, inexact %d (%.1f%%)\n",
+		exactIts,inexactIts,exactIts ? 100.0*inexactIts/exactIts : 0.0);
+    PetscPrintf(PETSC_COMM_WORLD," Inexact: %d of %d eigenpairs, largest relative residual %g, largest difference to the exact solve %g\n\n",
+		nconv,(PetscInt)exact.size(),error,difference);
+
+    return nconv > 0 && error <= 10*tol && difference <= 10*tol ? 0 : 1;
+}
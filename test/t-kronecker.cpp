@@ -0,0 +1,117 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Solves the 2-D Laplacian eigenproblem of ex2 assembled and as the Kronecker sum of two 1-D Laplacians.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions in both x and y dimensions.\n"
+  "  -products <p>, where <p> = number of products timed for each operator.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat A;
+    Vec x, y, z;
+    MatInfo info;
+    PetscInt N, n=300, m, Istart, Iend, II, i, j, products=100;
+    PetscLogDouble t0, t1, t2, t3, t4, t5, t6;
+    PetscReal difference;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-products",&products,PETSC_NULL);
+    N = n*n;
+    PetscPrintf(PETSC_COMM_WORLD,"\n2-D Laplacian Eigenproblem, N=%d (%dx%d grid)\n\n",N,n,n);
+
+    // T (x) I + I (x) T with T the 1-D Laplacian tridiag(-1, 2, -1)
+    slepc_cxx::KroneckerSum K(n,1,1,n,1,1);
+    for ( i = 0; i < n; i++ )
+	{
+	    for ( j = 0; j < 2; j++ )
+		{
+		    K.setValue(j,i,i,2.0);
+		    if(i>0) { K.setValue(j,i,i-1,-1.0); }
+		    if(i<n-1) { K.setValue(j,i,i+1,-1.0); }
+		}
+	}
+
+    // the assembled matrix with the row layout of the shell
+    MatGetLocalSize(K,&m,PETSC_NULL);
+    MatCreate(PETSC_COMM_WORLD,&A);
+    MatSetSizes(A,m,m,N,N);
+    MatSetFromOptions(A);
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for( II=Istart; II<Iend; II++ )
+	{
+	    i = II/n; j = II-i*n;
+	    if(i>0) { MatSetValue(A,II,II-n,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(A,II,II+n,-1.0,INSERT_VALUES); }
+	    if(j>0) { MatSetValue(A,II,II-1,-1.0,INSERT_VALUES); }
+	    if(j<n-1) { MatSetValue(A,II,II+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(A,II,II,4.0,INSERT_VALUES);
+	}
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+    MatGetInfo(A,MAT_GLOBAL_SUM,&info);
+
+    // both operators on the same vectors, their products must agree
+    MatGetVecs(K,&x,&y);
+    VecDuplicate(y,&z);
+    VecSetRandom(x,PETSC_NULL);
+
+    PetscGetTime(&t0);
+    for ( i = 0; i < products; i++ ) { MatMult(A,x,y); }
+    PetscGetTime(&t1);
+    for ( i = 0; i < products; i++ ) { MatMult(K,x,z); }
+    PetscGetTime(&t2);
+
+    VecAXPY(z,-1.0,y);
+    VecNorm(z,NORM_2,&difference);
+
+    slepc_cxx::EPSolver<T> assembled;
+
+    PetscGetTime(&t3);
+    assembled.solve(A);
+    PetscGetTime(&t4);
+
+    std::cout << assembled;
+
+    slepc_cxx::EPSolver<T> kronecker;
+
+    PetscGetTime(&t5);
+    kronecker.solve(K);
+    PetscGetTime(&t6);
+
+    std::cout << kronecker;
+    std::cout << K;
+
+    PetscPrintf(PETSC_COMM_WORLD," Assembled:      %10.0f nonzeros stored, %d products %8.3f s, solve %8.3f s\n",info.nz_used,products,t1-t0,t4-t3);
+    PetscPrintf(PETSC_COMM_WORLD," Kronecker sum:  %10d scalars stored, %d products %8.3f s, solve %8.3f s\n",K.storage(),products,t2-t1,t6-t5);
+    PetscPrintf(PETSC_COMM_WORLD," Norm of the difference of the products: %9.2e\n\n",difference);
+
+    VecDestroy(x);
+    VecDestroy(y);
+    VecDestroy(z);
+    MatDestroy(A);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Generates the Markov model of a random walk on a triangular grid "
+  "with the MatSetValue loop of the SLEPc examples and with slepc_cxx::MarkovModel.\n\n"
+  "The command line options are:\n"
+  "  -m <m>, where <m> = number of grid subdivisions in each dimension.\n"
+  "  -reference <0|1>, to skip the MatSetValue loop on large grids.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+// MatMarkovModel of the SLEPc examples ex5, ex12 and ex18, visits every grid point on every rank
+static void MatMarkovModel( PetscInt m, Mat A )
+{
+    const PetscReal cst = 0.5/(PetscReal)(m-1);
+    PetscReal pd, pu;
+    PetscInt Istart, Iend, i, j, jmax, ix=0;
+
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for( i=1; i<=m; i++ )
+	{
+	    jmax = m-i+1;
+	    for( j=1; j<=jmax; j++ )
+		{
+		    ix = ix + 1;
+		    if( ix-1<Istart || ix>Iend ) continue;
+		    if( j!=jmax )
+			{
+			    pd = cst*(PetscReal)(i+j-1);
+			    MatSetValue( A, ix-1, ix, i==1 ? 2*pd : pd, INSERT_VALUES );
+			    MatSetValue( A, ix-1, ix+jmax-1, j==1 ? 2*pd : pd, INSERT_VALUES );
+			}
+		    pu = 0.5 - cst*(PetscReal)(i+j-3);
+		    if( j>1 ) { MatSetValue( A, ix-1, ix-2, pu, INSERT_VALUES ); }
+		    if( i>1 ) { MatSetValue( A, ix-1, ix-jmax-2, pu, INSERT_VALUES ); }
+		}
+	}
+    MatAssemblyBegin( A, MAT_FINAL_ASSEMBLY );
+    MatAssemblyEnd( A, MAT_FINAL_ASSEMBLY );
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt N, m=1000;
+    PetscTruth reference=PETSC_TRUE, flg=PETSC_TRUE;
+    PetscLogDouble t0, t1, t2;
+
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+    PetscOptionsGetTruth(PETSC_NULL,"-reference",&reference,PETSC_NULL);
+
+    slepc_cxx::MarkovModel model( m );
+    N = model.size();
+    PetscPrintf(PETSC_COMM_WORLD,"\nMarkov Model, N=%d (m=%d)\n\n",N,m);
+
+    petsc_cxx::Matrix<T> A(N);
+    petsc_cxx::Matrix<T> B(N);
+
+    PetscGetTime(&t0);
+    if (reference) { MatMarkovModel( m, A ); }
+    PetscGetTime(&t1);
+    model.assemble( B );
+    PetscGetTime(&t2);
+
+    if (reference)
+	{
+	    MatEqual(A,B,&flg);
+	    PetscPrintf(PETSC_COMM_WORLD," MatSetValue:  %10.3f s\n",t1-t0);
+	}
+    PetscPrintf(PETSC_COMM_WORLD," MarkovModel:  %10.3f s\n",t2-t1);
+    if (reference) { PetscPrintf(PETSC_COMM_WORLD," Matrices are %s\n",flg ? "equal" : "different"); }
+    PetscPrintf(PETSC_COMM_WORLD,"\n");
+
+    return flg ? 0 : 1;
+}
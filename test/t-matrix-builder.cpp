@@ -0,0 +1,108 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Assembly benchmark of the 2-D Laplacian: per-row MatSetValues without preallocation "
+  "against the preallocating MatrixBuilder.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions in each dimension (about 5n^2 nonzeros).\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt n=1415, N, II, Istart, Iend;
+    PetscLogDouble t0, t1, t2;
+    PetscTruth flg;
+    MatInfo info;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    N = n*n;
+
+    PetscPrintf(PETSC_COMM_WORLD,"\n2-D Laplacian assembly, N=%d (n=%d)\n\n",N,n);
+
+    // current pattern: one MatSetValue per entry, default preallocation
+
+    petsc_cxx::Matrix<T> A(N);
+
+    PetscGetTime(&t0);
+
+    MatGetOwnershipRange(A,&Istart,&Iend);
+
+    for( II = Istart; II < Iend; II++ )
+	{
+	    PetscInt i = II/n, j = II-i*n;
+	    if(i>0) { MatSetValue(A,II,II-n,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(A,II,II+n,-1.0,INSERT_VALUES); }
+	    if(j>0) { MatSetValue(A,II,II-1,-1.0,INSERT_VALUES); }
+	    if(j<n-1) { MatSetValue(A,II,II+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(A,II,II,4.0,INSERT_VALUES);
+	}
+
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+
+    PetscGetTime(&t1);
+
+    MatGetInfo(A,MAT_GLOBAL_SUM,&info);
+    PetscPrintf(PETSC_COMM_WORLD," MatSetValue:   %10.3f s, nonzeros=%g, mallocs=%g\n",t1-t0,info.nz_used,info.mallocs);
+
+    // builder: thread-local triplets, exact preallocation, sorted rows
+
+    petsc_cxx::Matrix<T> B(N);
+    slepc_cxx::MatrixBuilder builder;
+
+    PetscGetTime(&t1);
+
+    builder.ownershipRange(B,&Istart,&Iend);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+	builder.prepare();
+#ifdef _OPENMP
+#pragma omp for
+#endif
+	for( II = Istart; II < Iend; II++ )
+	    {
+		PetscInt i = II/n, j = II-i*n;
+		if(i>0) { builder.add(II,II-n,-1.0); }
+		if(i<n-1) { builder.add(II,II+n,-1.0); }
+		if(j>0) { builder.add(II,II-1,-1.0); }
+		if(j<n-1) { builder.add(II,II+1,-1.0); }
+		builder.add(II,II,4.0);
+	    }
+    }
+
+    builder.assemble(B);
+
+    PetscGetTime(&t2);
+
+    MatGetInfo(B,MAT_GLOBAL_SUM,&info);
+    PetscPrintf(PETSC_COMM_WORLD," MatrixBuilder: %10.3f s, nonzeros=%g, mallocs=%g\n\n",t2-t1,info.nz_used,info.mallocs);
+
+    MatEqual(A,B,&flg);
+    PetscPrintf(PETSC_COMM_WORLD," Matrices are %s\n\n",flg ? "equal" : "different");
+
+    return flg ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cstdio>
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Loads a PETSc binary matrix with MatLoad and with the memory-mapped MatrixLoader, without and with its row index.\n\n"
+  "The command line options are:\n"
+  "  -f <file>, where <file> = matrix file, only loaded without index; a 2-D Laplacian is written and loaded both ways when omitted.\n"
+  "  -n <n>, where <n> = number of grid subdivisions of the generated Laplacian.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    char filename[PETSC_MAX_PATH_LEN] = "t-matrix-loader.petsc";
+    PetscTruth flg, plain, indexed=PETSC_TRUE;
+    PetscInt n=300, N, II, Istart, Iend;
+    PetscMPIInt rank;
+    PetscLogDouble t0, t1, t2, t3;
+    PetscViewer viewer;
+    Mat B, C, D;
+
+    MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetString(PETSC_NULL,"-f",filename,PETSC_MAX_PATH_LEN-1,&flg);
+
+    if (!flg)
+	{
+	    N = n*n;
+	    petsc_cxx::Matrix<T> A(N);
+	    slepc_cxx::MatrixBuilder builder;
+
+	    builder.ownershipRange(A,&Istart,&Iend);
+	    for( II = Istart; II < Iend; II++ )
+		{
+		    PetscInt i = II/n, j = II-i*n;
+		    if(i>0) { builder.add(II,II-n,-1.0); }
+		    if(i<n-1) { builder.add(II,II+n,-1.0); }
+		    if(j>0) { builder.add(II,II-1,-1.0); }
+		    if(j<n-1) { builder.add(II,II+1,-1.0); }
+		    builder.add(II,II,4.0);
+		}
+	    builder.assemble(A);
+
+	    PetscViewerBinaryOpen(PETSC_COMM_WORLD,filename,FILE_MODE_WRITE,&viewer);
+	    MatView(A,viewer);
+	    PetscViewerDestroy(viewer);
+
+	    // an index left by an earlier run would describe another file
+	    if (!rank) { remove(slepc_cxx::MatrixLoader::indexPath(filename).c_str()); }
+	    MPI_Barrier(PETSC_COMM_WORLD);
+	}
+
+    PetscGetTime(&t0);
+
+    PetscViewerBinaryOpen(PETSC_COMM_WORLD,filename,FILE_MODE_READ,&viewer);
+    MatLoad(viewer,MATAIJ,&B);
+    PetscViewerDestroy(viewer);
+
+    PetscGetTime(&t1);
+
+    // the row lengths before each block are summed
+    slepc_cxx::MatrixLoader loader;
+    loader.load(filename,&C);
+
+    PetscGetTime(&t2);
+
+    MatEqual(B,C,&plain);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\n MatLoad:                  %10.3f s\n",t1-t0);
+    PetscPrintf(PETSC_COMM_WORLD," MatrixLoader, no index:   %10.3f s, %s\n",t2-t1,plain ? "equal" : "different");
+
+    // the index is only written next to the generated file, never next to the user's
+    if (!flg)
+	{
+	    if (!rank) { slepc_cxx::MatrixLoader::writeIndex(filename); }
+	    MPI_Barrier(PETSC_COMM_WORLD);
+
+	    PetscGetTime(&t2);
+	    loader.load(filename,&D);
+	    PetscGetTime(&t3);
+
+	    MatEqual(B,D,&indexed);
+	    PetscPrintf(PETSC_COMM_WORLD," MatrixLoader, with index: %10.3f s, %s\n",t3-t2,indexed ? "equal" : "different");
+
+	    MatDestroy(D);
+	    if (!rank) { remove(slepc_cxx::MatrixLoader::indexPath(filename).c_str()); }
+	}
+    PetscPrintf(PETSC_COMM_WORLD,"\n");
+
+    MatDestroy(B);
+    MatDestroy(C);
+
+    return plain && indexed ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <cstdio>
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Reads a Matrix Market file, first from the text and then from the binary cache.\n\n"
+  "The command line options are:\n"
+  "  -f <file>, where <file> = Matrix Market file, a symmetric 2-D Laplacian is written when omitted.\n"
+  "  -n <n>, where <n> = number of grid subdivisions of the generated Laplacian.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    char filename[PETSC_MAX_PATH_LEN] = "t-matrix-market.mtx";
+    PetscTruth flg;
+    PetscInt n=300, N, II;
+    PetscMPIInt rank;
+    PetscLogDouble t0, t1, t2;
+    Mat A, B;
+
+    MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetString(PETSC_NULL,"-f",filename,PETSC_MAX_PATH_LEN-1,&flg);
+
+    if (!flg && !rank)
+	{
+	    // lower triangle only, the reader mirrors it
+	    N = n*n;
+	    FILE* file = fopen(filename,"w");
+	    fprintf(file,"%%%%MatrixMarket matrix coordinate real symmetric\n%% 2-D Laplacian\n");
+	    fprintf(file,"%d %d %d\n",(int)N,(int)N,(int)(N+2*n*(n-1)));
+	    for( II = 0; II < N; II++ )
+		{
+		    PetscInt i = II/n, j = II-i*n;
+		    if(i>0) { fprintf(file,"%d %d -1.0\n",(int)II+1,(int)(II-n)+1); }
+		    if(j>0) { fprintf(file,"%d %d -1.0\n",(int)II+1,(int)II); }
+		    fprintf(file,"%d %d 4.0\n",(int)II+1,(int)II+1);
+		}
+	    fclose(file);
+	}
+    MPI_Barrier(PETSC_COMM_WORLD);
+
+    slepc_cxx::MatrixMarketReader reader;
+    std::string cache = reader.cachePath(filename);
+    if (!rank) { remove(cache.c_str()); remove(slepc_cxx::MatrixLoader::indexPath(cache).c_str()); }
+    MPI_Barrier(PETSC_COMM_WORLD);
+
+    PetscGetTime(&t0);
+    reader.load(filename,&A);
+    PetscGetTime(&t1);
+    reader.load(filename,&B);
+    PetscGetTime(&t2);
+
+    MatEqual(A,B,&flg);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\n Text:         %10.3f s\n",t1-t0);
+    PetscPrintf(PETSC_COMM_WORLD," Binary cache: %10.3f s (%s)\n",t2-t1,cache.c_str());
+    PetscPrintf(PETSC_COMM_WORLD," Matrices are %s\n\n",flg ? "equal" : "different");
+
+    MatDestroy(A);
+    MatDestroy(B);
+
+    return flg ? 0 : 1;
+}
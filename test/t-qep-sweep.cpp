@@ -0,0 +1,141 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Sweeps the target of a shift-and-invert quadratic eigenproblem, factorising the linearization or P(s) only.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions in each dimension.\n"
+  "  -damping <c>, where <c> = C is c times the identity.\n"
+  "  -from <a>, -to <b>, -steps <s>, where the targets are s values of w from a to b: i*w in complex builds, -w on the real axis otherwise.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+// a single LU factorisation per target, which every solve then reuses
+static void direct(KSP ksp)
+{
+    PC pc;
+
+    KSPSetType(ksp,KSPPREONLY);
+    KSPGetPC(ksp,&pc);
+    PCSetType(pc,PCLU);
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat M, C, K;
+    PetscInt N, n=50, Istart, Iend, II, i, j, k, steps=5;
+    PetscReal c=5, from=0.5, to=4.5, w;
+    PetscScalar sigma, kr, ki;
+    PetscLogDouble t0, t1, t2, linear=0, compact=0;
+    EPS eps;
+    ST st;
+    KSP ksp;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-damping",&c,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-from",&from,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-to",&to,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-steps",&steps,PETSC_NULL);
+    N = n*n;
+    PetscPrintf(PETSC_COMM_WORLD,"\nQuadratic Eigenproblem, N=%d (%dx%d grid), damping %g, %d targets\n\n",N,n,n,c,steps);
+
+    // K is the 2-D Laplacian
+    MatCreate(PETSC_COMM_WORLD,&K);
+    MatSetSizes(K,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(K);
+    MatGetOwnershipRange(K,&Istart,&Iend);
+    for( II=Istart; II<Iend; II++ )
+	{
+	    i = II/n; j = II-i*n;
+	    if(i>0) { MatSetValue(K,II,II-n,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(K,II,II+n,-1.0,INSERT_VALUES); }
+	    if(j>0) { MatSetValue(K,II,II-1,-1.0,INSERT_VALUES); }
+	    if(j<n-1) { MatSetValue(K,II,II+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(K,II,II,4.0,INSERT_VALUES);
+	}
+    MatAssemblyBegin(K,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(K,MAT_FINAL_ASSEMBLY);
+
+    // C is c times the identity matrix
+    MatCreate(PETSC_COMM_WORLD,&C);
+    MatSetSizes(C,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(C);
+    MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);
+    MatShift(C,c);
+
+    // M is the identity matrix
+    MatCreate(PETSC_COMM_WORLD,&M);
+    MatSetSizes(M,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(M);
+    MatAssemblyBegin(M,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(M,MAT_FINAL_ASSEMBLY);
+    MatShift(M,1.0);
+
+    PetscPrintf(PETSC_COMM_WORLD,"        target          linearized (2n LU)        compact (n LU)          nearest eigenvalue\n");
+    PetscPrintf(PETSC_COMM_WORLD," ------------------- ------------------------ ------------------------ -------------------------\n");
+    for ( k = 0; k < steps; k++ )
+	{
+	    w = steps > 1 ? from + k*(to-from)/(steps-1) : from;
+#ifdef PETSC_USE_COMPLEX
+	    sigma = PETSC_i*w;
+#else
+	    sigma = -w;
+#endif
+
+	    slepc_cxx::QEPSolver<T> lqep;
+	    lqep.setTarget(sigma);
+	    QEPLinearGetEPS(lqep,&eps);
+	    EPSGetST(eps,&st);
+	    STGetKSP(st,&ksp);
+	    direct(ksp);
+
+	    slepc_cxx::QEPSolver<T> cqep;
+	    cqep.setCompact();
+	    cqep.setTarget(sigma);
+	    direct(cqep.compact().ksp());
+
+	    PetscGetTime(&t0);
+	    lqep.solve(M,C,K);
+	    PetscGetTime(&t1);
+	    cqep.solve(M,C,K);
+	    PetscGetTime(&t2);
+	    linear += t1-t0;
+	    compact += t2-t1;
+
+	    kr = ki = 0;
+	    if (cqep.getConverged() > 0) { cqep.getEigenpair(0,&kr,&ki); }
+#ifdef PETSC_USE_COMPLEX
+	    ki = PetscImaginaryPart(kr);
+#endif
+	    PetscPrintf(PETSC_COMM_WORLD," %8.4f%+8.4fi   %10.3f s, %3d conv  %10.3f s, %3d conv   %10.6f%+10.6fi\n",
+			PetscRealPart(sigma),PetscImaginaryPart(sigma),t1-t0,lqep.getConverged(),t2-t1,cqep.getConverged(),
+			PetscRealPart(kr),PetscRealPart(ki));
+	}
+    PetscPrintf(PETSC_COMM_WORLD,"\n Sweep: linearized %.3f s, compact %.3f s\n\n",linear,compact);
+
+    MatDestroy(M);
+    MatDestroy(C);
+    MatDestroy(K);
+
+    return 0;
+}
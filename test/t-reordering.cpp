@@ -0,0 +1,142 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Solves a symmetric eigenproblem repeatedly in the given ordering, then on P A P^T with reverse Cuthill-McKee and with graph partitioning.\n\n"
+  "The command line options are:\n"
+  "  -file <filename>, where <filename> = matrix file in PETSc binary form, a 2-D Laplacian in scattered numbering is generated when omitted.\n"
+  "  -n <n>, where <n> = number of grid subdivisions in each dimension of the generated matrix.\n"
+  "  -repeats <r>, where <r> = number of solves in each ordering, the ordering being computed once.\n"
+  "  -mat_partitioning_type <type>, where <type> = partitioner of the third run, parmetis for instance.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+static PetscInt gcd(PetscInt a, PetscInt b)
+{
+    return b ? gcd(b,a%b) : a;
+}
+
+// row of the grid point v
+static PetscInt number(PetscInt v, PetscInt a, PetscInt N)
+{
+    return (PetscInt)(((long long)v*a)%N);
+}
+
+// largest ||Ax-kx||/||kx|| of the converged eigenpairs, x given in the ordering of A
+static PetscReal residual(slepc_cxx::EPSolver<T>& eps, Mat A)
+{
+    PetscReal worst = 0, norm;
+    PetscScalar kr, ki;
+    Vec x, y;
+
+    MatGetVecs(A,&x,&y);
+    for ( PetscInt i = 0; i < eps.getConverged(); i++ )
+	{
+	    eps.getEigenpair(i,&kr,&ki,x);
+	    MatMult(A,x,y);
+	    VecAXPY(y,-kr,x);
+	    VecNorm(y,NORM_2,&norm);
+	    worst = PetscMax(worst,norm/PetscAbsScalar(kr));
+	}
+    VecDestroy(x);
+    VecDestroy(y);
+    return worst;
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    char filename[PETSC_MAX_PATH_LEN];
+    PetscInt N, n=100, v, i, j, a, r, repeats=3, Istart, Iend, method;
+    PetscTruth flg;
+    PetscLogDouble t0, t1;
+    const char* names[] = { "given", "reverse Cuthill-McKee", "partitioning" };
+    Mat A;
+
+    PetscOptionsGetString(PETSC_NULL,"-file",filename,PETSC_MAX_PATH_LEN-1,&flg);
+    PetscOptionsGetInt(PETSC_NULL,"-repeats",&repeats,PETSC_NULL);
+
+    if (flg)
+	{
+	    slepc_cxx::MatrixLoader().load(filename,&A);
+	    MatGetSize(A,&N,PETSC_NULL);
+	    PetscPrintf(PETSC_COMM_WORLD,"\nSymmetric eigenproblem stored in file, N=%d\n\n",N);
+	}
+    else
+	{
+	    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+	    N = n*n;
+	    PetscPrintf(PETSC_COMM_WORLD,"\n2-D Laplacian Eigenproblem in scattered numbering, N=%d (%dx%d grid)\n\n",N,n,n);
+
+	    // the grid point v is the row v*a mod N, which puts its neighbours anywhere
+	    for ( a = 7919; gcd(a,N) != 1; a++ ) {}
+
+	    MatCreate(PETSC_COMM_WORLD,&A);
+	    MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);
+	    MatSetFromOptions(A);
+	    MatGetOwnershipRange(A,&Istart,&Iend);
+	    for( v=Istart; v<Iend; v++ )
+		{
+		    i = v/n; j = v-i*n;
+		    r = number(v,a,N);
+		    if(i>0) { MatSetValue(A,r,number(v-n,a,N),-1.0,INSERT_VALUES); }
+		    if(i<n-1) { MatSetValue(A,r,number(v+n,a,N),-1.0,INSERT_VALUES); }
+		    if(j>0) { MatSetValue(A,r,number(v-1,a,N),-1.0,INSERT_VALUES); }
+		    if(j<n-1) { MatSetValue(A,r,number(v+1,a,N),-1.0,INSERT_VALUES); }
+		    MatSetValue(A,r,r,4.0,INSERT_VALUES);
+		}
+	    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+	    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+	}
+
+    PetscPrintf(PETSC_COMM_WORLD,"        ordering            first solve   next solves    off-rank nonzeros  conv    residual\n");
+    PetscPrintf(PETSC_COMM_WORLD," ------------------------- ------------- ------------- ------------------ ------ -----------\n");
+    for ( method = slepc_cxx::Reordering::None; method <= slepc_cxx::Reordering::Partitioning; method++ )
+	{
+	    slepc_cxx::EPSolver<T> eps;
+	    eps.setReordering((slepc_cxx::Reordering::Method)method);
+
+	    PetscLogDouble first = 0, next = 0;
+	    for ( r = 0; r < repeats; r++ )
+		{
+		    PetscGetTime(&t0);
+		    eps.solve(A);
+		    PetscGetTime(&t1);
+		    if (r == 0) { first = t1-t0; }
+		    else { next += t1-t0; }
+		}
+
+	    // the given ordering is the "before" of the reordered runs
+	    PetscInt before = 0, after = 0;
+	    if (method != slepc_cxx::Reordering::None)
+		{
+		    before = eps.reordering().offRankBefore();
+		    after = eps.reordering().offRankAfter();
+		}
+	    PetscPrintf(PETSC_COMM_WORLD," %-25s %10.3f s  %10.3f s  %7d -> %7d %6d %11.2e\n",
+			names[method],first,repeats > 1 ? next/(repeats-1) : 0,before,after,eps.getConverged(),residual(eps,A));
+	}
+    PetscPrintf(PETSC_COMM_WORLD,"\n");
+
+    MatDestroy(A);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Solves a power-law graph and the ex5 Markov model on the uniform row split and on splits balancing the nonzeros or the measured product time.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of vertices of the power-law graph.\n"
+  "  -degree <d>, where <d> = the vertex i has about d/(i+1) neighbours.\n"
+  "  -m <m>, where <m> = number of grid subdivisions of the Markov model.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+static void benchmark(const char* name, Mat A, EPSProblemType type)
+{
+    const char* names[] = { "uniform", "nonzeros", "measured" };
+    PetscLogDouble t0, t1, t2, t3;
+    PetscScalar kr, ki;
+    PetscInt layout;
+    Mat B;
+
+    PetscPrintf(PETSC_COMM_WORLD," %-8s     split      moved in   nonzero imbalance  product imbalance     solve       first eigenvalue\n",name);
+    PetscPrintf(PETSC_COMM_WORLD," -------- ------------ ---------- ------------------ ------------------ ---------- --------------------\n");
+    for ( layout = -1; layout <= slepc_cxx::RowPartition::Measured; layout++ )
+	{
+	    PetscGetTime(&t0);
+	    if (layout < 0) { B = A; }
+	    else { slepc_cxx::RowPartition::redistribute(A,&B,(slepc_cxx::RowPartition::Weight)layout); }
+	    PetscGetTime(&t1);
+
+	    PetscReal nonzeros = slepc_cxx::RowPartition::imbalance(B);
+	    PetscReal products = slepc_cxx::RowPartition::imbalance(PETSC_COMM_WORLD,slepc_cxx::RowPartition::productTime(B));
+
+	    slepc_cxx::EPSolver<T> eps;
+	    EPSSetProblemType(eps,type);
+	    eps.setDense(0);
+
+	    PetscGetTime(&t2);
+	    eps.solve(B);
+	    PetscGetTime(&t3);
+
+	    kr = ki = 0;
+	    if (eps.getConverged() > 0) { eps.getEigenpair(0,&kr,&ki); }
+	    PetscPrintf(PETSC_COMM_WORLD," %-8s %-12s %8.3f s %18.3f %18.3f %8.3f s %10.6f%+10.6fi\n",
+			"",names[layout+1],layout < 0 ? 0 : t1-t0,nonzeros,products,t3-t2,PetscRealPart(kr),PetscRealPart(ki));
+
+	    if (layout >= 0) { MatDestroy(B); }
+	}
+    PetscPrintf(PETSC_COMM_WORLD,"\n");
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt n=100000, degree=2000, m=150, i, j, k, d, Istart, Iend;
+    Mat A, P;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-degree",&degree,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+
+    // the first vertices hold most of the edges, which the uniform split gives to rank 0
+    MatCreate(PETSC_COMM_WORLD,&P);
+    MatSetSizes(P,PETSC_DECIDE,PETSC_DECIDE,n,n);
+    MatSetFromOptions(P);
+    MatGetOwnershipRange(P,&Istart,&Iend);
+    for( i=Istart; i<Iend; i++ )
+	{
+	    d = 1 + degree/(i+1);
+	    for ( k = 1; k <= d; k++ )
+		{
+		    j = (PetscInt)((i + (long long)k*7919) % n);
+		    if (j == i) { continue; }
+		    MatSetValue(P,i,j,-1.0,INSERT_VALUES);
+		    MatSetValue(P,j,i,-1.0,INSERT_VALUES);
+		}
+	    MatSetValue(P,i,i,2.0*d,INSERT_VALUES);
+	}
+    MatAssemblyBegin(P,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(P,MAT_FINAL_ASSEMBLY);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nPower-law graph, N=%d, degree %d\n\n",n,degree);
+    benchmark("graph",P,EPS_HEP);
+
+    slepc_cxx::MarkovModel markov(m);
+    markov.create(&A);
+
+    PetscPrintf(PETSC_COMM_WORLD,"Markov model, N=%d (m=%d)\n\n",markov.size(),m);
+    benchmark("markov",A,EPS_NHEP);
+
+    MatDestroy(P);
+    MatDestroy(A);
+
+    return 0;
+}
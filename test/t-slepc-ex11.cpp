@@ -1,183 +1,95 @@
-/*
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-   SLEPc - Scalable Library for Eigenvalue Problem Computations
-   Copyright (c) 2002-2010, Universidad Politecnica de Valencia, Spain
-
-   This file is part of SLEPc.
-      
-   SLEPc is free software: you can redistribute it and/or modify it under  the
-   terms of version 3 of the GNU Lesser General Public License as published by
-   the Free Software Foundation.
-
-   SLEPc  is  distributed in the hope that it will be useful, but WITHOUT  ANY 
-   WARRANTY;  without even the implied warranty of MERCHANTABILITY or  FITNESS 
-   FOR  A  PARTICULAR PURPOSE. See the GNU Lesser General Public  License  for 
-   more details.
-
-   You  should have received a copy of the GNU Lesser General  Public  License
-   along with SLEPc. If not, see <http://www.gnu.org/licenses/>.
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-*/
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+// Binding of the example available on file:///usr/share/doc/slepc3.1-doc/src/examples/ex11.c.html
+
+#include <slepc_cxx/slepc_cxx>
 
 static char help[] = "Computes the smallest nonzero eigenvalue of the Laplacian of a graph.\n\n"
-  "This example illustrates EPSSetDeflationSpace(). The example graph corresponds to a "
-  "2-D regular mesh. The command line options are:\n"
+  "The nullspace is found by GraphLaplacian and attached as deflation space. The example graph "
+  "is made of disjoint 2-D regular meshes. The command line options are:\n"
   "  -n <n>, where <n> = number of grid subdivisions in x dimension.\n"
-  "  -m <m>, where <m> = number of grid subdivisions in y dimension.\n\n";
+  "  -m <m>, where <m> = number of grid subdivisions in y dimension.\n"
+  "  -c <c>, where <c> = number of disjoint meshes.\n"
+  "  -f <file>, where <file> = edge list \"i j [w]\" of a graph with -N <N> vertices, replaces the meshes.\n"
+  "  -normalized, to use the normalised Laplacian.\n\n";
 
-#include "slepceps.h"
+typedef petsc_cxx::Scalar T;
 
-#undef __FUNCT__
-#define __FUNCT__ "main"
-int main( int argc, char **argv )
+int main(int ac, char** av)
 {
-  Mat         	 A;		  /* operator matrix */
-  Vec         	 x;
-  EPS         	 eps;		  /* eigenproblem solver context */
-  const EPSType  type;
-  PetscReal   	 error, tol, re, im;
-  PetscScalar 	 kr, ki;
-  PetscErrorCode ierr;
-  PetscInt    	 N, n=10, m, i, j, II, Istart, Iend, nev, maxit, its, nconv;
-  PetscScalar 	 w;
-  PetscBool   	 flag;
-
-  SlepcInitialize(&argc,&argv,(char*)0,help);
-
-  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,&flag);CHKERRQ(ierr);
-  if(!flag) m=n;
-  N = n*m;
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nFiedler vector of a 2-D regular mesh, N=%d (%dx%d grid)\n\n",N,n,m);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-     Compute the operator matrix that defines the eigensystem, Ax=kx
-     In this example, A = L(G), where L is the Laplacian of graph G, i.e.
-     Lii = degree of node i, Lij = -1 if edge (i,j) exists in G
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
-  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
-  
-  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
-  for( II=Istart; II<Iend; II++ ) { 
-    i = II/n; j = II-i*n;
-    w = 0.0;
-    if(i>0) { ierr = MatSetValue(A,II,II-n,-1.0,INSERT_VALUES);CHKERRQ(ierr); w=w+1.0; }
-    if(i<m-1) { ierr = MatSetValue(A,II,II+n,-1.0,INSERT_VALUES);CHKERRQ(ierr); w=w+1.0; }
-    if(j>0) { ierr = MatSetValue(A,II,II-1,-1.0,INSERT_VALUES);CHKERRQ(ierr); w=w+1.0; }
-    if(j<n-1) { ierr = MatSetValue(A,II,II+1,-1.0,INSERT_VALUES);CHKERRQ(ierr); w=w+1.0; }
-    ierr = MatSetValue(A,II,II,w,INSERT_VALUES);CHKERRQ(ierr);
-  }
-
-  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                Create the eigensolver and set various options
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Create eigensolver context
-  */
-  ierr = EPSCreate(PETSC_COMM_WORLD,&eps);CHKERRQ(ierr);
-
-  /* 
-     Set operators. In this case, it is a standard eigenvalue problem
-  */
-  ierr = EPSSetOperators(eps,A,PETSC_NULL);CHKERRQ(ierr);
-  ierr = EPSSetProblemType(eps,EPS_HEP);CHKERRQ(ierr);
-  
-  /*
-     Select portion of spectrum
-  */
-  ierr = EPSSetWhichEigenpairs(eps,EPS_SMALLEST_REAL);CHKERRQ(ierr);
-
-  /*
-     Set solver parameters at runtime
-  */
-  ierr = EPSSetFromOptions(eps);CHKERRQ(ierr);
-
-  /*
-     Attach deflation space: in this case, the matrix has a constant 
-     nullspace, [1 1 ... 1]^T is the eigenvector of the zero eigenvalue
-  */
-  ierr = MatGetVecs(A,&x,PETSC_NULL);CHKERRQ(ierr);
-  ierr = VecSet(x,1.0);CHKERRQ(ierr);
-  ierr = EPSSetDeflationSpace(eps,1,&x);CHKERRQ(ierr);
-  ierr = VecDestroy(x);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                      Solve the eigensystem
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = EPSSolve(eps);CHKERRQ(ierr);
-  ierr = EPSGetIterationNumber(eps, &its);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);CHKERRQ(ierr);
-
-  /*
-     Optional: Get some information from the solver and display it
-  */
-  ierr = EPSGetType(eps,&type);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);CHKERRQ(ierr);
-  ierr = EPSGetDimensions(eps,&nev,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);CHKERRQ(ierr);
-  ierr = EPSGetTolerances(eps,&tol,&maxit);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                    Display solution and clean up
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Get number of converged approximate eigenpairs
-  */
-  ierr = EPSGetConverged(eps,&nconv);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate eigenpairs: %d\n\n",nconv);
-         CHKERRQ(ierr);
-
-  if (nconv>0) {
-    /*
-       Display eigenvalues and relative errors
-    */
-    ierr = PetscPrintf(PETSC_COMM_WORLD,
-         "           k          ||Ax-kx||/||kx||\n"
-         "   ----------------- ------------------\n" );CHKERRQ(ierr);
-
-    for( i=0; i<nconv; i++ ) {
-      /* 
-        Get converged eigenpairs: i-th eigenvalue is stored in kr (real part) and
-        ki (imaginary part)
-      */
-      ierr = EPSGetEigenpair(eps,i,&kr,&ki,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-      /*
-         Compute the relative error associated to each eigenpair
-      */
-      ierr = EPSComputeRelativeError(eps,i,&error);CHKERRQ(ierr);
-
-#ifdef PETSC_USE_COMPLEX
-      re = PetscRealPart(kr);
-      im = PetscImaginaryPart(kr);
-#else
-      re = kr;
-      im = ki;
-#endif 
-      if (im!=0.0) {
-        ierr = PetscPrintf(PETSC_COMM_WORLD," %9f%+9f j %12g\n",re,im,error);CHKERRQ(ierr);
-      } else {
-        ierr = PetscPrintf(PETSC_COMM_WORLD,"   %12f       %12g\n",re,error);CHKERRQ(ierr); 
-      }
-    }
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"\n" );CHKERRQ(ierr);
-  }
-  
-  /* 
-     Free work space
-  */
-  ierr = EPSDestroy(eps);CHKERRQ(ierr);
-  ierr = MatDestroy(A);CHKERRQ(ierr);
-  ierr = SlepcFinalize();CHKERRQ(ierr);
-  return 0;
-}
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    char filename[PETSC_MAX_PATH_LEN];
+    PetscInt n=10, m, c=1, N, i, j, k, II, Istart, Iend;
+    PetscTruth flag, normalized=PETSC_FALSE, fromFile;
+    Mat L;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,&flag);
+    if(!flag) m=n;
+    PetscOptionsGetInt(PETSC_NULL,"-c",&c,PETSC_NULL);
+    PetscOptionsHasName(PETSC_NULL,"-normalized",&normalized);
+    PetscOptionsGetString(PETSC_NULL,"-f",filename,PETSC_MAX_PATH_LEN-1,&fromFile);
+
+    N = c*n*m;
+    if (fromFile) { PetscOptionsGetInt(PETSC_NULL,"-N",&N,PETSC_NULL); }
+
+    slepc_cxx::GraphLaplacian graph(N, normalized ? slepc_cxx::GraphLaplacian::Normalized : slepc_cxx::GraphLaplacian::Combinatorial);
+
+    if (fromFile)
+	{
+	    PetscPrintf(PETSC_COMM_WORLD,"\nFiedler vector of the graph %s, N=%d\n\n",filename,N);
+	    graph.load(filename);
+	}
+    else
+	{
+	    PetscPrintf(PETSC_COMM_WORLD,"\nFiedler vector of %d 2-D regular meshes, N=%d (%dx%d grids)\n\n",c,N,n,m);
+
+	    // every rank adds the edges leaving a contiguous block of vertices
+	    k = PETSC_DECIDE;
+	    PetscSplitOwnership(PETSC_COMM_WORLD,&k,&N);
+	    MPI_Scan(&k,&Iend,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);
+	    Istart = Iend-k;
+
+	    for( II=Istart; II<Iend; II++ )
+		{
+		    k = II%(n*m); i = k/n; j = k-i*n;
+		    if(i<m-1) { graph.addEdge(II,II+n); }
+		    if(j<n-1) { graph.addEdge(II,II+1); }
+		}
+	}
 
+    graph.assemble(&L);
+
+    std::cout << graph;
+
+    slepc_cxx::EPSolver<T> eps;
+    EPSSetWhichEigenpairs(eps,EPS_SMALLEST_REAL);
+    EPSSetFromOptions(eps);
+    graph.deflate(eps);
+
+    eps.solve(L);
+
+    std::cout << eps;
+
+    MatDestroy(L);
+
+    return 0;
+}
@@ -1,144 +1,96 @@
-/*
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-   SLEPc - Scalable Library for Eigenvalue Problem Computations
-   Copyright (c) 2002-2010, Universidad Politecnica de Valencia, Spain
-
-   This file is part of SLEPc.
-      
-   SLEPc is free software: you can redistribute it and/or modify it under  the
-   terms of version 3 of the GNU Lesser General Public License as published by
-   the Free Software Foundation.
-
-   SLEPc  is  distributed in the hope that it will be useful, but WITHOUT  ANY 
-   WARRANTY;  without even the implied warranty of MERCHANTABILITY or  FITNESS 
-   FOR  A  PARTICULAR PURPOSE. See the GNU Lesser General Public  License  for 
-   more details.
-
-   You  should have received a copy of the GNU Lesser General  Public  License
-   along with SLEPc. If not, see <http://www.gnu.org/licenses/>.
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-*/
-
-static char help[] = "Solves a singular value problem with the matrix loaded from a file.\n"
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+// Binding of the example available on file:///usr/share/doc/slepc3.1-doc/src/examples/ex14.c.html
+
+#include <slepc_cxx/slepc_cxx>
+#include "tall_matrix.h"
+
+static char help[] = "Solves a singular value problem with the matrix loaded from a file, "
+  "first with a Krylov method and then with a randomized range finder.\n"
   "This example works for both real and complex numbers.\n\n"
   "The command line options are:\n"
-  "  -file <filename>, where <filename> = matrix file in PETSc binary form.\n\n";
+  "  -file <filename>, where <filename> = matrix file in PETSc binary form, a tall sparse matrix is generated when omitted.\n"
+  "  -m <m> -n <n>, where <m> x <n> = size of the generated matrix.\n"
+  "  -oversampling <p>, where <p> = extra columns of the randomized range finder.\n"
+  "  -power_its <q>, where <q> = number of power iterations.\n\n";
 
-#include "slepcsvd.h"
+typedef petsc_cxx::Scalar T;
 
-#undef __FUNCT__
-#define __FUNCT__ "main"
-int main( int argc, char **argv )
+int main(int ac, char** av)
 {
-  Mat         	 A;		  /* operator matrix */
-  SVD         	 svd;		  /* singular value problem solver context */
-  const SVDType  type;
-  PetscReal   	 error, tol, sigma;
-  PetscErrorCode ierr;
-  PetscInt    	 nsv, maxit, i, its, nconv;
-  char        	 filename[256];
-  PetscViewer 	 viewer;
-  PetscBool   	 flg;
-
-
-  SlepcInitialize(&argc,&argv,(char*)0,help);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-        Load the operator matrix that defines the singular value problem
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nSingular value problem stored in file.\n\n");CHKERRQ(ierr);
-  ierr = PetscOptionsGetString(PETSC_NULL,"-file",filename,256,&flg);CHKERRQ(ierr);
-  if (!flg) {
-    SETERRQ(PETSC_COMM_WORLD,1,"Must indicate a file name with the -file option.");
-  }
-
-#if defined(PETSC_USE_COMPLEX)
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Reading COMPLEX matrix from a binary file...\n");CHKERRQ(ierr);
-#else
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Reading REAL matrix from a binary file...\n");CHKERRQ(ierr);
-#endif
-  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,filename,FILE_MODE_READ,&viewer);CHKERRQ(ierr);
-  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
-  ierr = MatLoad(A,viewer);CHKERRQ(ierr);
-  ierr = PetscViewerDestroy(viewer);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                Create the singular value solver and set various options
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Create singular value solver context
-  */
-  ierr = SVDCreate(PETSC_COMM_WORLD,&svd);CHKERRQ(ierr);
-
-  /* 
-     Set operator
-  */
-  ierr = SVDSetOperator(svd,A);CHKERRQ(ierr);
-
-  /*
-     Set solver parameters at runtime
-  */
-  ierr = SVDSetFromOptions(svd);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                      Solve the singular value system
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = SVDSolve(svd);CHKERRQ(ierr);
-  ierr = SVDGetIterationNumber(svd, &its);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);CHKERRQ(ierr);
-
-  /*
-     Optional: Get some information from the solver and display it
-  */
-  ierr = SVDGetType(svd,&type);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);CHKERRQ(ierr);
-  ierr = SVDGetDimensions(svd,&nsv,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of requested singular values: %d\n",nsv);CHKERRQ(ierr);
-  ierr = SVDGetTolerances(svd,&tol,&maxit);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                    Display solution and clean up
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Get number of converged singular triplets
-  */
-  ierr = SVDGetConverged(svd,&nconv);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate singular triplets: %d\n\n",nconv);CHKERRQ(ierr);
-
-  if (nconv>0) {
-    /*
-       Display singular values and relative errors
-    */
-    ierr = PetscPrintf(PETSC_COMM_WORLD,
-         "          sigma           residual norm\n"
-         "  --------------------- ------------------\n" );CHKERRQ(ierr);
-    for( i=0; i<nconv; i++ ) {
-      /* 
-         Get converged singular triplets: i-th singular value is stored in sigma
-      */
-      ierr = SVDGetSingularTriplet(svd,i,&sigma,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-
-      /*
-         Compute the error associated to each singular triplet 
-      */
-      ierr = SVDComputeRelativeError(svd,i,&error);CHKERRQ(ierr);
-      ierr = PetscPrintf(PETSC_COMM_WORLD,"       % 6f      ",sigma); CHKERRQ(ierr);
-      ierr = PetscPrintf(PETSC_COMM_WORLD," % 12g\n",error);CHKERRQ(ierr);
-    }
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"\n" );CHKERRQ(ierr);
-  }
-  
-  /* 
-     Free work space
-  */
-  ierr = SVDDestroy(svd);CHKERRQ(ierr);
-  ierr = MatDestroy(A);CHKERRQ(ierr);
-  ierr = SlepcFinalize();CHKERRQ(ierr);
-  return 0;
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    char filename[PETSC_MAX_PATH_LEN];
+    PetscInt m=20000, n=500, p=10, q=2, i, nconv, nsv;
+    PetscReal sigma, reference, difference=0;
+    PetscTruth flg;
+    PetscLogDouble t0, t1, t2;
+    Mat A;
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nSingular value problem stored in file.\n\n");
+    PetscOptionsGetString(PETSC_NULL,"-file",filename,PETSC_MAX_PATH_LEN-1,&flg);
+    PetscOptionsGetInt(PETSC_NULL,"-oversampling",&p,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-power_its",&q,PETSC_NULL);
+
+    if (flg)
+	{
+	    slepc_cxx::MatrixLoader().load(filename,&A);
+	}
+    else
+	{
+	    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+	    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+	    PetscPrintf(PETSC_COMM_WORLD," Generated %dx%d sparse matrix with decaying column scales\n",m,n);
+
+	    A = tallMatrix(PETSC_COMM_WORLD,m,n);
+	}
+
+    slepc_cxx::SVDSolver<T> krylov;
+    slepc_cxx::SVDSolver<T> randomized;
+    krylov.setTallSkinny(0);
+    randomized.setRandomized(PETSC_TRUE,p,q);
+    SVDGetDimensions(krylov,&nsv,PETSC_NULL,PETSC_NULL);
+    SVDSetDimensions(randomized,nsv,PETSC_IGNORE,PETSC_IGNORE);
+
+    PetscGetTime(&t0);
+    krylov.solve(A);
+    PetscGetTime(&t1);
+    randomized.solve(A);
+    PetscGetTime(&t2);
+
+    std::cout << krylov;
+    std::cout << randomized;
+
+    nconv = PetscMin(krylov.getConverged(),randomized.getConverged());
+    for( i=0; i<nconv; i++ )
+	{
+	    krylov.getSingularTriplet(i,&reference);
+	    randomized.getSingularTriplet(i,&sigma);
+	    difference = PetscMax(difference,PetscAbsReal(sigma-reference)/reference);
+	}
+
+    PetscPrintf(PETSC_COMM_WORLD," Krylov:     %10.3f s\n",t1-t0);
+    PetscPrintf(PETSC_COMM_WORLD," Randomized: %10.3f s\n",t2-t1);
+    PetscPrintf(PETSC_COMM_WORLD," Largest relative difference of the %d leading singular values: %g\n\n",nconv,difference);
+
+    MatDestroy(A);
+
+    return 0;
 }
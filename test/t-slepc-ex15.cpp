@@ -1,155 +1,120 @@
-/*
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-   SLEPc - Scalable Library for Eigenvalue Problem Computations
-   Copyright (c) 2002-2010, Universidad Politecnica de Valencia, Spain
-
-   This file is part of SLEPc.
-      
-   SLEPc is free software: you can redistribute it and/or modify it under  the
-   terms of version 3 of the GNU Lesser General Public License as published by
-   the Free Software Foundation.
-
-   SLEPc  is  distributed in the hope that it will be useful, but WITHOUT  ANY 
-   WARRANTY;  without even the implied warranty of MERCHANTABILITY or  FITNESS 
-   FOR  A  PARTICULAR PURPOSE. See the GNU Lesser General Public  License  for 
-   more details.
-
-   You  should have received a copy of the GNU Lesser General  Public  License
-   along with SLEPc. If not, see <http://www.gnu.org/licenses/>.
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-*/
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+// Binding of the example available on file:///usr/share/doc/slepc3.1-doc/src/examples/ex15.c.html
+
+#include <cmath>
+
+#include <slepc_cxx/slepc_cxx>
 
 static char help[] = "Singular value decomposition of the Lauchli matrix.\n"
   "The command line options are:\n"
   "  -n <n>, where <n> = matrix dimension.\n"
-  "  -mu <mu>, where <mu> = subdiagonal value.\n\n";
+  "  -mu <mu>, where <mu> = subdiagonal value.\n"
+  "  -smallest, to compute the smallest singular values, the cyclic formulation is then chosen.\n"
+  "  -explicit, also solves with the explicit product A^T A and compares its nonzeros and accuracy.\n\n";
 
-#include "slepcsvd.h"
+typedef petsc_cxx::Scalar T;
 
-#undef __FUNCT__
-#define __FUNCT__ "main"
-int main( int argc, char **argv )
+int main(int ac, char** av)
 {
-  Mat         	 A;               /* operator matrix */
-  Vec            u,v;             /* left and right singular vectors */
-  SVD         	 svd;             /* singular value problem solver context */
-  const SVDType  type;
-  PetscReal   	 error, tol, sigma, mu=PETSC_SQRT_MACHINE_EPSILON;
-  PetscErrorCode ierr;
-  PetscInt       n=100, i, j, Istart, Iend, nsv, maxit, its, nconv;
-
-  SlepcInitialize(&argc,&argv,(char*)0,help);
-
-  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscOptionsGetReal(PETSC_NULL,"-mu",&mu,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nLauchli singular value decomposition, (%d x %d) mu=%g\n\n",n+1,n,mu);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                          Build the Lauchli matrix
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
-  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n+1,n);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
-
-  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
-  for (i=Istart;i<Iend;i++) {
-    if (i == 0) {
-      for (j=0;j<n;j++) {
-        ierr = MatSetValue(A,0,j,1.0,INSERT_VALUES);CHKERRQ(ierr);
-      }
-    } else {
-      ierr = MatSetValue(A,i,i-1,mu,INSERT_VALUES);CHKERRQ(ierr);
-    }
-  }
-  
-  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-  ierr = MatGetVecs(A,&v,&u);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-          Create the singular value solver and set various options
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Create singular value solver context
-  */
-  ierr = SVDCreate(PETSC_COMM_WORLD,&svd);CHKERRQ(ierr);
-
-  /* 
-     Set operator
-  */
-  ierr = SVDSetOperator(svd,A);CHKERRQ(ierr);
-  
-  /*
-     Use thick-restart Lanczos as default solver
-  */
-  ierr = SVDSetType(svd,SVDTRLANCZOS);CHKERRQ(ierr);
-
-  /*
-     Set solver parameters at runtime
-  */
-  ierr = SVDSetFromOptions(svd);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                      Solve the singular value system
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = SVDSolve(svd);CHKERRQ(ierr);
-  ierr = SVDGetIterationNumber(svd, &its);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);CHKERRQ(ierr);
-
-  /*
-     Optional: Get some information from the solver and display it
-  */
-  ierr = SVDGetType(svd,&type);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);CHKERRQ(ierr);
-  ierr = SVDGetDimensions(svd,&nsv,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of requested singular values: %d\n",nsv);CHKERRQ(ierr);
-  ierr = SVDGetTolerances(svd,&tol,&maxit);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                    Display solution and clean up
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Get number of converged singular triplets
-  */
-  ierr = SVDGetConverged(svd,&nconv);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate singular triplets: %d\n\n",nconv);CHKERRQ(ierr);
-
-  if (nconv>0) {
-    /*
-       Display singular values and relative errors
-    */
-    ierr = PetscPrintf(PETSC_COMM_WORLD,
-         "          sigma           residual norm\n"
-         "  --------------------- ------------------\n" );CHKERRQ(ierr);
-    for( i=0; i<nconv; i++ ) {
-      /* 
-         Get converged singular triplets: i-th singular value is stored in sigma
-      */
-      ierr = SVDGetSingularTriplet(svd,i,&sigma,u,v);CHKERRQ(ierr);
-
-      /*
-         Compute the error associated to each singular triplet 
-      */
-      ierr = SVDComputeRelativeError(svd,i,&error);CHKERRQ(ierr);
-
-      ierr = PetscPrintf(PETSC_COMM_WORLD,"       % 6f      ",sigma); CHKERRQ(ierr);
-      ierr = PetscPrintf(PETSC_COMM_WORLD," % 12g\n",error);CHKERRQ(ierr);
-    }
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"\n" );CHKERRQ(ierr);
-  }
-  
-  /* 
-     Free work space
-  */
-  ierr = SVDDestroy(svd);CHKERRQ(ierr);
-  ierr = MatDestroy(A);CHKERRQ(ierr);
-  ierr = VecDestroy(u);CHKERRQ(ierr);
-  ierr = VecDestroy(v);CHKERRQ(ierr);
-  ierr = SlepcFinalize();CHKERRQ(ierr);
-  return 0;
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscReal mu=PETSC_SQRT_MACHINE_EPSILON, sigma, exact;
+    PetscInt n=100, i, j, Istart, Iend, nsv, nconv;
+    PetscTruth smallest=PETSC_FALSE, explicitProduct=PETSC_FALSE;
+    Mat A;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-mu",&mu,PETSC_NULL);
+    PetscOptionsGetTruth(PETSC_NULL,"-smallest",&smallest,PETSC_NULL);
+    PetscOptionsGetTruth(PETSC_NULL,"-explicit",&explicitProduct,PETSC_NULL);
+    PetscPrintf(PETSC_COMM_WORLD,"\nLauchli singular value decomposition, (%d x %d) mu=%g\n\n",n+1,n,mu);
+
+    MatCreate(PETSC_COMM_WORLD,&A);
+    MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n+1,n);
+    MatSetFromOptions(A);
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for (i=Istart;i<Iend;i++)
+	{
+	    if (i == 0)
+		{
+		    for (j=0;j<n;j++) { MatSetValue(A,0,j,1.0,INSERT_VALUES); }
+		}
+	    else
+		{
+		    MatSetValue(A,i,i-1,mu,INSERT_VALUES);
+		}
+	}
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+
+    // sqrt(n + mu^2) once, mu for the others
+    exact = smallest ? mu : std::sqrt(n+mu*mu);
+
+    slepc_cxx::SVDSolver<T> svd;
+    SVDSetWhichSingularTriplets(svd,smallest ? SVD_SMALLEST : SVD_LARGEST);
+    svd.setImplicit();
+    svd.solve(A);
+
+    std::cout << svd;
+
+    if (svd.getConverged() > 0)
+	{
+	    svd.getSingularTriplet(0,&sigma);
+	    PetscPrintf(PETSC_COMM_WORLD," Implicit: relative error of sigma = %g\n\n",PetscAbsReal(sigma-exact)/exact);
+	}
+
+    if (explicitProduct)
+	{
+	    Mat At, AtA;
+	    MatInfo info;
+	    EPS eps;
+	    PetscScalar kr;
+
+	    MatTranspose(A,MAT_INITIAL_MATRIX,&At);
+	    MatMatMult(At,A,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&AtA);
+	    MatGetInfo(AtA,MAT_GLOBAL_SUM,&info);
+	    PetscPrintf(PETSC_COMM_WORLD," Explicit A^T A: %g nonzeros\n",info.nz_used);
+
+	    SVDGetDimensions(svd,&nsv,PETSC_NULL,PETSC_NULL);
+	    EPSCreate(PETSC_COMM_WORLD,&eps);
+	    EPSSetOperators(eps,AtA,PETSC_NULL);
+	    EPSSetProblemType(eps,EPS_HEP);
+	    EPSSetWhichEigenpairs(eps,smallest ? EPS_SMALLEST_REAL : EPS_LARGEST_REAL);
+	    EPSSetDimensions(eps,nsv,PETSC_DECIDE,PETSC_DECIDE);
+	    EPSSolve(eps);
+	    EPSGetConverged(eps,&nconv);
+	    if (nconv > 0)
+		{
+		    EPSGetEigenpair(eps,0,&kr,PETSC_NULL,PETSC_NULL,PETSC_NULL);
+		    sigma = std::sqrt(PetscMax(PetscRealPart(kr),0));
+		    PetscPrintf(PETSC_COMM_WORLD," Explicit: relative error of sigma = %g\n\n",PetscAbsReal(sigma-exact)/exact);
+		}
+	    else { PetscPrintf(PETSC_COMM_WORLD," Explicit: no eigenpair converged\n\n"); }
+
+	    EPSDestroy(eps);
+	    MatDestroy(AtA);
+	    MatDestroy(At);
+	}
+
+    MatDestroy(A);
+
+    return 0;
 }
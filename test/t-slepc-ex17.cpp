@@ -1,181 +1,84 @@
-/*
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-   SLEPc - Scalable Library for Eigenvalue Problem Computations
-   Copyright (c) 2002-2010, Universidad Politecnica de Valencia, Spain
-
-   This file is part of SLEPc.
-      
-   SLEPc is free software: you can redistribute it and/or modify it under  the
-   terms of version 3 of the GNU Lesser General Public License as published by
-   the Free Software Foundation.
-
-   SLEPc  is  distributed in the hope that it will be useful, but WITHOUT  ANY 
-   WARRANTY;  without even the implied warranty of MERCHANTABILITY or  FITNESS 
-   FOR  A  PARTICULAR PURPOSE. See the GNU Lesser General Public  License  for 
-   more details.
-
-   You  should have received a copy of the GNU Lesser General  Public  License
-   along with SLEPc. If not, see <http://www.gnu.org/licenses/>.
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-*/
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+// Binding of the example available on file:///usr/share/doc/slepc3.1-doc/src/examples/ex17.c.html
+
+#include <stdexcept>
+
+#include <slepc_cxx/slepc_cxx>
 
 static char help[] = "Solves a quadratic eigenproblem (l^2*M + l*C + K)*x = 0 with matrices loaded from a file.\n\n"
   "The command line options are:\n"
   "  -M <filename>, where <filename> = matrix (M) file in PETSc binary form.\n"
   "  -C <filename>, where <filename> = matrix (C) file in PETSc binary form.\n"
-  "  -K <filename>, where <filename> = matrix (K) file in PETSc binary form.\n\n";
+  "  -K <filename>, where <filename> = matrix (K) file in PETSc binary form.\n"
+  "  -target <s>, where <s> = eigenvalues nearest to s instead of the largest ones, by shift-and-invert.\n"
+  "  -compact, solves with the compact Q-Arnoldi, which only factorises s^2*M + s*C + K for a target.\n\n";
 
-#include "slepcqep.h"
+typedef petsc_cxx::Scalar T;
 
-#undef __FUNCT__
-#define __FUNCT__ "main"
-int main( int argc, char **argv )
+int main(int ac, char** av)
 {
-  Mat         	 M, C, K;         /* problem matrices */
-  QEP         	 qep;             /* quadratic eigenproblem solver context */
-  const QEPType  type;
-  PetscReal   	 error, tol, re, im;
-  PetscScalar 	 kr, ki;
-  PetscErrorCode ierr;
-  PetscInt    	 nev, maxit, i, its, nconv;
-  char        	 filename[256];
-  PetscViewer 	 viewer;
-  PetscBool   	 flg;
-
-  SlepcInitialize(&argc,&argv,(char*)0,help);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-        Load the matrices that define the quadratic eigenproblem
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nQuadratic eigenproblem stored in file.\n\n");CHKERRQ(ierr);
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat M, C, K;
+    char filename[256];
+    const char* names[] = { "M", "C", "K" };
+    Mat* matrices[] = { &M, &C, &K };
+    PetscTruth flg, compact=PETSC_FALSE;
+    PetscScalar target;
+    PetscLogDouble t0, t1;
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nQuadratic eigenproblem stored in file.\n\n");
 #if defined(PETSC_USE_COMPLEX)
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Reading COMPLEX matrices from binary files...\n");CHKERRQ(ierr);
+    PetscPrintf(PETSC_COMM_WORLD," Reading COMPLEX matrices from binary files...\n");
 #else
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Reading REAL matrices from binary files...\n");CHKERRQ(ierr);
+    PetscPrintf(PETSC_COMM_WORLD," Reading REAL matrices from binary files...\n");
 #endif
 
-  ierr = PetscOptionsGetString(PETSC_NULL,"-M",filename,256,&flg);CHKERRQ(ierr);
-  if (!flg) {
-    SETERRQ(PETSC_COMM_WORLD,1,"Must indicate a file name for matrix M with the -M option.");
-  }
-  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,filename,FILE_MODE_READ,&viewer);CHKERRQ(ierr);
-  ierr = MatCreate(PETSC_COMM_WORLD,&M);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(M);CHKERRQ(ierr);
-  ierr = MatLoad(M,viewer);CHKERRQ(ierr);
-  ierr = PetscViewerDestroy(viewer);CHKERRQ(ierr);
-
-  ierr = PetscOptionsGetString(PETSC_NULL,"-C",filename,256,&flg);CHKERRQ(ierr);
-  if (!flg) {
-    SETERRQ(PETSC_COMM_WORLD,1,"Must indicate a file name for matrix C with the -C option.");
-  }
-  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,filename,FILE_MODE_READ,&viewer);CHKERRQ(ierr);
-  ierr = MatCreate(PETSC_COMM_WORLD,&C);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(C);CHKERRQ(ierr);
-  ierr = MatLoad(C,viewer);CHKERRQ(ierr);
-  ierr = PetscViewerDestroy(viewer);CHKERRQ(ierr);
-
-  ierr = PetscOptionsGetString(PETSC_NULL,"-K",filename,256,&flg);CHKERRQ(ierr);
-  if (!flg) {
-    SETERRQ(PETSC_COMM_WORLD,1,"Must indicate a file name for matrix K with the -K option.");
-  }
-  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,filename,FILE_MODE_READ,&viewer);CHKERRQ(ierr);
-  ierr = MatCreate(PETSC_COMM_WORLD,&K);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(K);CHKERRQ(ierr);
-  ierr = MatLoad(K,viewer);CHKERRQ(ierr);
-  ierr = PetscViewerDestroy(viewer);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                Create the eigensolver and set various options
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Create eigensolver context
-  */
-  ierr = QEPCreate(PETSC_COMM_WORLD,&qep);CHKERRQ(ierr);
-
-  /* 
-     Set matrices
-  */
-  ierr = QEPSetOperators(qep,M,C,K);CHKERRQ(ierr);
-
-  /*
-     Set solver parameters at runtime
-  */
-  ierr = QEPSetFromOptions(qep);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                      Solve the eigensystem
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = QEPSolve(qep);CHKERRQ(ierr);
-  ierr = QEPGetIterationNumber(qep, &its);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);CHKERRQ(ierr);
-
-  /*
-     Optional: Get some information from the solver and display it
-  */
-  ierr = QEPGetType(qep,&type);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);CHKERRQ(ierr);
-  ierr = QEPGetDimensions(qep,&nev,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);CHKERRQ(ierr);
-  ierr = QEPGetTolerances(qep,&tol,&maxit);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                    Display solution and clean up
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Get number of converged approximate eigenpairs
-  */
-  ierr = QEPGetConverged(qep,&nconv);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate eigenpairs: %d\n\n",nconv);
-         CHKERRQ(ierr);
-
-  if (nconv>0) {
-    /*
-       Display eigenvalues and relative errors
-    */
-    ierr = PetscPrintf(PETSC_COMM_WORLD,
-         "           k          ||(k^2M+Ck+K)x||/||kx||\n"
-         "   ----------------- -------------------------\n" );CHKERRQ(ierr);
-
-    for( i=0; i<nconv; i++ ) {
-      /* 
-        Get converged eigenpairs: i-th eigenvalue is stored in kr (real part) and
-        ki (imaginary part)
-      */
-      ierr = QEPGetEigenpair(qep,i,&kr,&ki,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-      /*
-         Compute the relative error associated to each eigenpair
-      */
-      ierr = QEPComputeRelativeError(qep,i,&error);CHKERRQ(ierr);
-
-#ifdef PETSC_USE_COMPLEX
-      re = PetscRealPart(kr);
-      im = PetscImaginaryPart(kr);
-#else
-      re = kr;
-      im = ki;
-#endif 
-      if (im!=0.0) {
-        ierr = PetscPrintf(PETSC_COMM_WORLD," %9f%+9f j    %12g\n",re,im,error);CHKERRQ(ierr);
-      } else {
-        ierr = PetscPrintf(PETSC_COMM_WORLD,"   %12f       %12g\n",re,error);CHKERRQ(ierr); 
-      }
-    }
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"\n" );CHKERRQ(ierr);
-  }
-  
-  /* 
-     Free work space
-  */
-  ierr = QEPDestroy(qep);CHKERRQ(ierr);
-  ierr = MatDestroy(M);CHKERRQ(ierr);
-  ierr = MatDestroy(C);CHKERRQ(ierr);
-  ierr = MatDestroy(K);CHKERRQ(ierr);
-  ierr = SlepcFinalize();CHKERRQ(ierr);
-  return 0;
+    slepc_cxx::MatrixLoader loader;
+    for ( int i = 0; i < 3; i++ )
+	{
+	    PetscOptionsGetString(PETSC_NULL,(std::string("-") + names[i]).c_str(),filename,256,&flg);
+	    if (!flg)
+		{
+		    throw std::runtime_error(std::string("Must indicate a file name for matrix ") + names[i] + " with the -" + names[i] + " option.");
+		}
+	    loader.load(filename,matrices[i]);
+	}
+
+    slepc_cxx::QEPSolver<T> qep;
+    PetscOptionsGetTruth(PETSC_NULL,"-compact",&compact,PETSC_NULL);
+    if (compact) { qep.setCompact(); }
+    PetscOptionsGetScalar(PETSC_NULL,"-target",&target,&flg);
+    if (flg) { qep.setTarget(target); }
+
+    PetscGetTime(&t0);
+    qep.solve(M,C,K);
+    PetscGetTime(&t1);
+
+    std::cout << qep;
+    PetscPrintf(PETSC_COMM_WORLD," Solved in %.3f s\n\n",t1-t0);
+
+    MatDestroy(M);
+    MatDestroy(C);
+    MatDestroy(K);
+
+    return 0;
 }
-
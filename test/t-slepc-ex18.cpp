@@ -1,278 +1,66 @@
-/*
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-   SLEPc - Scalable Library for Eigenvalue Problem Computations
-   Copyright (c) 2002-2010, Universidad Politecnica de Valencia, Spain
-
-   This file is part of SLEPc.
-      
-   SLEPc is free software: you can redistribute it and/or modify it under  the
-   terms of version 3 of the GNU Lesser General Public License as published by
-   the Free Software Foundation.
-
-   SLEPc  is  distributed in the hope that it will be useful, but WITHOUT  ANY 
-   WARRANTY;  without even the implied warranty of MERCHANTABILITY or  FITNESS 
-   FOR  A  PARTICULAR PURPOSE. See the GNU Lesser General Public  License  for 
-   more details.
-
-   You  should have received a copy of the GNU Lesser General  Public  License
-   along with SLEPc. If not, see <http://www.gnu.org/licenses/>.
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-*/
-
-static char help[] = "Solves the same problem as in ex5, but with a user-defined sorting criterion."
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+// Binding of the example available on file:///usr/share/doc/slepc3.1-doc/src/examples/ex18.c.html
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Solves the same problem as in ex5, but with a user-defined sorting criterion. "
   "It is a standard nonsymmetric eigenproblem with real eigenvalues and the rightmost eigenvalue is known to be 1.\n"
   "This example illustrates how the user can set a custom spectrum selection.\n\n"
   "The command line options are:\n"
-  "  -m <m>, where <m> = number of grid subdivisions in each dimension.\n\n";
-
-#include "slepceps.h"
-
-/* 
-   User-defined routines
-*/
-
-PetscErrorCode MyEigenSort(EPS eps, PetscScalar ar, PetscScalar ai, PetscScalar br, PetscScalar bi, PetscInt *r, void *ctx);
+  "  -m <m>, where <m> = number of grid subdivisions in each dimension.\n"
+  "  -target <target>, where <target> = eigenvalues are searched closest to it on its right.\n\n";
 
-PetscErrorCode MatMarkovModel( PetscInt m, Mat A );
+typedef petsc_cxx::Scalar T;
 
-#undef __FUNCT__
-#define __FUNCT__ "main"
-int main( int argc, char **argv )
+int main(int ac, char** av)
 {
-  Vec         	 v0;		  /* initial vector */
-  Mat         	 A;		  /* operator matrix */
-  EPS         	 eps;		  /* eigenproblem solver context */
-  const EPSType  type;
-  PetscReal   	 error, tol, re, im;
-  PetscScalar 	 kr, ki, target=0.5;
-  PetscInt    	 N, m=15, nev, maxit, i, its, nconv;
-  PetscErrorCode ierr;
-  
-  SlepcInitialize(&argc,&argv,(char*)0,help);
-
-  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
-  N = m*(m+1)/2;
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nMarkov Model, N=%d (m=%d)\n",N,m);CHKERRQ(ierr);
-  ierr = PetscOptionsGetScalar(PETSC_NULL,"-target",&target,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"Searching closest eigenvalues to the right of %g.\n\n",target);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-     Compute the operator matrix that defines the eigensystem, Ax=kx
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
-  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
-  ierr = MatMarkovModel( m, A );CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                Create the eigensolver and set various options
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Create eigensolver context
-  */
-  ierr = EPSCreate(PETSC_COMM_WORLD,&eps);CHKERRQ(ierr);
-
-  /* 
-     Set operators. In this case, it is a standard eigenvalue problem
-  */
-  ierr = EPSSetOperators(eps,A,PETSC_NULL);CHKERRQ(ierr);
-  ierr = EPSSetProblemType(eps,EPS_NHEP);CHKERRQ(ierr);
-
-  /*
-     Set the custom comparing routine in order to obtain the eigenvalues
-     closest to the target on the right only
-  */
-  ierr = EPSSetEigenvalueComparison(eps,MyEigenSort,&target);CHKERRQ(ierr);
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
 
-  /*
-     Set solver parameters at runtime
-  */
-  ierr = EPSSetFromOptions(eps);CHKERRQ(ierr);
+    PetscInt N, m=15;
+    PetscScalar target=0.5;
+    Vec v0;
 
-  /*
-     Set the initial vector. This is optional, if not done the initial
-     vector is set to random values
-  */
-  ierr = MatGetVecs(A,&v0,PETSC_NULL);CHKERRQ(ierr);
-  ierr = VecSet(v0,1.0);CHKERRQ(ierr);
-  ierr = EPSSetInitialSpace(eps,1,&v0);CHKERRQ(ierr);
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+    N = m*(m+1)/2;
+    PetscPrintf(PETSC_COMM_WORLD,"\nMarkov Model, N=%d (m=%d)\n",N,m);
+    PetscOptionsGetScalar(PETSC_NULL,"-target",&target,PETSC_NULL);
+    PetscPrintf(PETSC_COMM_WORLD,"Searching closest eigenvalues to the right of %g.\n\n",PetscRealPart(target));
 
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                      Solve the eigensystem
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    petsc_cxx::Matrix<T> A(N);
+    slepc_cxx::MarkovModel( m ).assemble( A );
 
-  ierr = EPSSolve(eps);CHKERRQ(ierr);
-  ierr = EPSGetIterationNumber(eps, &its);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of iterations of the method: %d\n",its);CHKERRQ(ierr);
+    // the comparator is a template argument, SLEPc calls it through a typed trampoline
+    slepc_cxx::EPSolver< T, slepc_cxx::RightOfTarget > eps;
+    eps.setComparison( slepc_cxx::RightOfTarget( target ) );
+    EPSSetProblemType(eps,EPS_NHEP);
 
-  /*
-     Optional: Get some information from the solver and display it
-  */
-  ierr = EPSGetType(eps,&type);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Solution method: %s\n\n",type);CHKERRQ(ierr);
-  ierr = EPSGetDimensions(eps,&nev,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of requested eigenvalues: %d\n",nev);CHKERRQ(ierr);
-  ierr = EPSGetTolerances(eps,&tol,&maxit);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Stopping condition: tol=%.4g, maxit=%d\n",tol,maxit);CHKERRQ(ierr);
+    MatGetVecs(A,&v0,PETSC_NULL);
+    VecSet(v0,1.0);
+    eps.setInitialSpace(1,&v0);
 
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                    Display solution and clean up
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Get number of converged approximate eigenpairs
-  */
-  ierr = EPSGetConverged(eps,&nconv);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD," Number of converged approximate eigenpairs: %d\n\n",nconv);CHKERRQ(ierr);
-
-  if (nconv>0) {
-    /*
-       Display eigenvalues and relative errors
-    */
-    ierr = PetscPrintf(PETSC_COMM_WORLD,
-         "           k          ||Ax-kx||/||kx||\n"
-         "   ----------------- ------------------\n" );CHKERRQ(ierr);
-
-    for( i=0; i<nconv; i++ ) {
-      /* 
-        Get converged eigenpairs: i-th eigenvalue is stored in kr (real part) and
-        ki (imaginary part)
-      */
-      ierr = EPSGetEigenpair(eps,i,&kr,&ki,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-      /*
-         Compute the relative error associated to each eigenpair
-      */
-      ierr = EPSComputeRelativeError(eps,i,&error);CHKERRQ(ierr);
-
-#ifdef PETSC_USE_COMPLEX
-      re = PetscRealPart(kr);
-      im = PetscImaginaryPart(kr);
-#else
-      re = kr;
-      im = ki;
-#endif 
-      if (im!=0.0) {
-        ierr = PetscPrintf(PETSC_COMM_WORLD," %9f%+9f j %12g\n",re,im,error);CHKERRQ(ierr);
-      } else {
-        ierr = PetscPrintf(PETSC_COMM_WORLD,"   %12f       %12g\n",re,error);CHKERRQ(ierr); 
-      }
-    }
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"\n" );CHKERRQ(ierr);
-  }
-  
-  /* 
-     Free work space
-  */
-  ierr = EPSDestroy(eps);CHKERRQ(ierr);
-  ierr = MatDestroy(A);CHKERRQ(ierr);
-  ierr = VecDestroy(v0);CHKERRQ(ierr);
-  ierr = SlepcFinalize();CHKERRQ(ierr);
-  return 0;
-}
-
-#undef __FUNCT__
-#define __FUNCT__ "MatMarkovModel"
-/*
-    Matrix generator for a Markov model of a random walk on a triangular grid.
-
-    This subroutine generates a test matrix that models a random walk on a 
-    triangular grid. This test example was used by G. W. Stewart ["{SRRIT} - a 
-    FORTRAN subroutine to calculate the dominant invariant subspaces of a real
-    matrix", Tech. report. TR-514, University of Maryland (1978).] and in a few
-    papers on eigenvalue problems by Y. Saad [see e.g. LAA, vol. 34, pp. 269-295
-    (1980) ]. These matrices provide reasonably easy test problems for eigenvalue
-    algorithms. The transpose of the matrix  is stochastic and so it is known 
-    that one is an exact eigenvalue. One seeks the eigenvector of the transpose 
-    associated with the eigenvalue unity. The problem is to calculate the steady
-    state probability distribution of the system, which is the eigevector 
-    associated with the eigenvalue one and scaled in such a way that the sum all
-    the components is equal to one.
-
-    Note: the code will actually compute the transpose of the stochastic matrix
-    that contains the transition probabilities.
-*/
-PetscErrorCode MatMarkovModel( PetscInt m, Mat A )
-{
-  const PetscReal cst = 0.5/(PetscReal)(m-1);
-  PetscReal       pd, pu;
-  PetscErrorCode  ierr;
-  PetscInt        Istart, Iend, i, j, jmax, ix=0;
-
-  PetscFunctionBegin;
-  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
-  for( i=1; i<=m; i++ ) {
-    jmax = m-i+1;
-    for( j=1; j<=jmax; j++ ) {
-      ix = ix + 1;
-      if( ix-1<Istart || ix>Iend ) continue;  /* compute only owned rows */
-      if( j!=jmax ) {
-        pd = cst*(PetscReal)(i+j-1);
-        /* north */
-        if( i==1 ) { 
-          ierr = MatSetValue( A, ix-1, ix, 2*pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-	else {
-          ierr = MatSetValue( A, ix-1, ix, pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-        /* east */
-        if( j==1 ) { 
-          ierr = MatSetValue( A, ix-1, ix+jmax-1, 2*pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-	else {
-          ierr = MatSetValue( A, ix-1, ix+jmax-1, pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-      }
-      /* south */
-      pu = 0.5 - cst*(PetscReal)(i+j-3);
-      if( j>1 ) {
-        ierr = MatSetValue( A, ix-1, ix-2, pu, INSERT_VALUES );CHKERRQ(ierr);
-      }
-      /* west */
-      if( i>1 ) {
-        ierr = MatSetValue( A, ix-1, ix-jmax-2, pu, INSERT_VALUES );CHKERRQ(ierr);
-      }
-    }
-  }
-  ierr = MatAssemblyBegin( A, MAT_FINAL_ASSEMBLY );CHKERRQ(ierr);
-  ierr = MatAssemblyEnd( A, MAT_FINAL_ASSEMBLY );CHKERRQ(ierr);
-  PetscFunctionReturn(0);
-}
-
-#undef __FUNCT__
-#define __FUNCT__ "MyEigenSort"
-/*
-    Function for user-defined eigenvalue ordering criterion.
-
-    Given two eigenvalues ar+i*ai and br+i*bi, the subroutine must choose
-    one of them as the preferred one according to the criterion.
-    In this example, the preferred value is the one closest to the target,
-    but on the right side.
-*/
-PetscErrorCode MyEigenSort(EPS eps, PetscScalar ar, PetscScalar ai, PetscScalar br, PetscScalar bi, PetscInt *r, void *ctx)
-{
-  PetscScalar     target = *(PetscScalar*)ctx;
-  PetscReal       da,db;
-  PetscBool       aisright, bisright;
+    eps(A);
 
-  PetscFunctionBegin;
+    std::cout << eps;
 
-  if (PetscRealPart(target) < PetscRealPart(ar)) aisright = PETSC_TRUE;
-  else aisright = PETSC_FALSE;
-  if (PetscRealPart(target) < PetscRealPart(br)) bisright = PETSC_TRUE;
-  else bisright = PETSC_FALSE;
-  if (aisright == bisright) {
-    /* both are on the same side of the target */
-    da = SlepcAbsEigenvalue(ar-target,ai);
-    db = SlepcAbsEigenvalue(br-target,bi);
-    if (da < db) *r = -1;
-    else if (da > db) *r = 1;
-    else *r = 0;
-  } else if (aisright && !bisright)
-    *r = -1; /* 'a' is on the right */
-  else
-    *r = 1;  /* 'b' is on the right */
+    VecDestroy(v0);
 
-  PetscFunctionReturn(0);
+    return 0;
 }
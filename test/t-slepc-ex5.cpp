@@ -26,11 +26,7 @@ static char help[] = "Eigenvalue problem associated with a Markov model of a ran
   "  -m <m>, where <m> = number of grid subdivisions in each dimension.\n\n";
 
 #include "slepceps.h"
-
-/* 
-   User-defined routines
-*/
-PetscErrorCode MatMarkovModel( PetscInt m, Mat A );
+#include <slepc_cxx/MarkovModel.h>
 
 #undef __FUNCT__
 #define __FUNCT__ "main"
@@ -58,7 +54,7 @@ int main( int argc, char **argv )
   ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
   ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);CHKERRQ(ierr);
   ierr = MatSetFromOptions(A);CHKERRQ(ierr);
-  ierr = MatMarkovModel( m, A );CHKERRQ(ierr);
+  slepc_cxx::MarkovModel( m ).assemble( A );
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
                 Create the eigensolver and set various options
@@ -160,72 +156,3 @@ int main( int argc, char **argv )
   ierr = SlepcFinalize();CHKERRQ(ierr);
   return 0;
 }
-
-#undef __FUNCT__
-#define __FUNCT__ "MatMarkovModel"
-/*
-    Matrix generator for a Markov model of a random walk on a triangular grid.
-
-    This subroutine generates a test matrix that models a random walk on a 
-    triangular grid. This test example was used by G. W. Stewart ["{SRRIT} - a 
-    FORTRAN subroutine to calculate the dominant invariant subspaces of a real
-    matrix", Tech. report. TR-514, University of Maryland (1978).] and in a few
-    papers on eigenvalue problems by Y. Saad [see e.g. LAA, vol. 34, pp. 269-295
-    (1980) ]. These matrices provide reasonably easy test problems for eigenvalue
-    algorithms. The transpose of the matrix  is stochastic and so it is known 
-    that one is an exact eigenvalue. One seeks the eigenvector of the transpose 
-    associated with the eigenvalue unity. The problem is to calculate the steady
-    state probability distribution of the system, which is the eigevector 
-    associated with the eigenvalue one and scaled in such a way that the sum all
-    the components is equal to one.
-
-    Note: the code will actually compute the transpose of the stochastic matrix
-    that contains the transition probabilities.
-*/
-PetscErrorCode MatMarkovModel( PetscInt m, Mat A )
-{
-  const PetscReal cst = 0.5/(PetscReal)(m-1);
-  PetscReal       pd, pu;
-  PetscErrorCode  ierr;
-  PetscInt        Istart, Iend, i, j, jmax, ix=0;
-
-  PetscFunctionBegin;
-  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
-  for( i=1; i<=m; i++ ) {
-    jmax = m-i+1;
-    for( j=1; j<=jmax; j++ ) {
-      ix = ix + 1;
-      if( ix-1<Istart || ix>Iend ) continue;  /* compute only owned rows */
-      if( j!=jmax ) {
-        pd = cst*(PetscReal)(i+j-1);
-        /* north */
-        if( i==1 ) { 
-          ierr = MatSetValue( A, ix-1, ix, 2*pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-	else {
-          ierr = MatSetValue( A, ix-1, ix, pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-        /* east */
-        if( j==1 ) { 
-          ierr = MatSetValue( A, ix-1, ix+jmax-1, 2*pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-	else {
-          ierr = MatSetValue( A, ix-1, ix+jmax-1, pd, INSERT_VALUES );CHKERRQ(ierr);
-        }
-      }
-      /* south */
-      pu = 0.5 - cst*(PetscReal)(i+j-3);
-      if( j>1 ) {
-        ierr = MatSetValue( A, ix-1, ix-2, pu, INSERT_VALUES );CHKERRQ(ierr);
-      }
-      /* west */
-      if( i>1 ) {
-        ierr = MatSetValue( A, ix-1, ix-jmax-2, pu, INSERT_VALUES );CHKERRQ(ierr);
-      }
-    }
-  }
-  ierr = MatAssemblyBegin( A, MAT_FINAL_ASSEMBLY );CHKERRQ(ierr);
-  ierr = MatAssemblyEnd( A, MAT_FINAL_ASSEMBLY );CHKERRQ(ierr);
-  PetscFunctionReturn(0);
-}
-
@@ -1,30 +1,33 @@
-/*
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-   SLEPc - Scalable Library for Eigenvalue Problem Computations
-   Copyright (c) 2002-2010, Universidad Politecnica de Valencia, Spain
-
-   This file is part of SLEPc.
-      
-   SLEPc is free software: you can redistribute it and/or modify it under  the
-   terms of version 3 of the GNU Lesser General Public License as published by
-   the Free Software Foundation.
-
-   SLEPc  is  distributed in the hope that it will be useful, but WITHOUT  ANY 
-   WARRANTY;  without even the implied warranty of MERCHANTABILITY or  FITNESS 
-   FOR  A  PARTICULAR PURPOSE. See the GNU Lesser General Public  License  for 
-   more details.
-
-   You  should have received a copy of the GNU Lesser General  Public  License
-   along with SLEPc. If not, see <http://www.gnu.org/licenses/>.
-   - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-*/
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+// Binding of the example available on file:///usr/share/doc/slepc3.1-doc/src/examples/ex8.c.html
+
+#include <slepcsvd.h>
+
+#include <slepc_cxx/slepc_cxx>
 
 static char help[] = "Estimates the 2-norm condition number of a matrix A, that is, the ratio of the largest to the smallest singular values of A. "
   "The matrix is a Grcar matrix.\n\n"
   "The command line options are:\n"
-  "  -n <n>, where <n> = matrix dimension.\n\n";
-
-#include "slepcsvd.h"
+  "  -n <n>, where <n> = matrix dimension.\n"
+  "  -tol <tol>, where <tol> = relative residual of both singular values.\n"
+  "  -reference, also runs one SVD solve per end of the spectrum and compares the timings.\n\n";
 
 /*
    This example computes the singular values of an nxn Grcar matrix,
@@ -42,120 +45,74 @@ static char help[] = "Estimates the 2-norm condition number of a matrix A, that
 
  */
 
-#undef __FUNCT__
-#define __FUNCT__ "main"
-int main( int argc, char **argv )
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
 {
-  PetscErrorCode ierr;
-  Mat         	 A;		  /* Grcar matrix */
-  SVD            svd;             /* singular value solver context */
-  PetscInt    	 N=30, Istart, Iend, i, col[5], nconv1, nconv2;
-  PetscScalar 	 value[] = { -1, 1, 1, 1, 1 };
-  PetscReal   	 sigma_1, sigma_n;
-
-  SlepcInitialize(&argc,&argv,(char*)0,help);
-
-  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&N,PETSC_NULL);CHKERRQ(ierr);
-  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nEstimate the condition number of a Grcar matrix, n=%d\n\n",N);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-        Generate the matrix 
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
-  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);CHKERRQ(ierr);
-  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
-
-  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
-  for( i=Istart; i<Iend; i++ ) {
-    col[0]=i-1; col[1]=i; col[2]=i+1; col[3]=i+2; col[4]=i+3;
-    if (i==0) {
-      ierr = MatSetValues(A,1,&i,4,col+1,value+1,INSERT_VALUES);CHKERRQ(ierr);
-    }
-    else {
-      ierr = MatSetValues(A,1,&i,PetscMin(5,N-i+1),col,value,INSERT_VALUES);CHKERRQ(ierr);
-    }
-  }
-
-  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-             Create the singular value solver and set the solution method
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /* 
-     Create singular value context
-  */
-  ierr = SVDCreate(PETSC_COMM_WORLD,&svd);CHKERRQ(ierr);
-
-  /* 
-     Set operator
-  */
-  ierr = SVDSetOperator(svd,A);CHKERRQ(ierr);
-
-  /*
-     Set solver parameters at runtime
-  */
-  ierr = SVDSetFromOptions(svd);CHKERRQ(ierr);
-  ierr = SVDSetDimensions(svd,1,PETSC_IGNORE,PETSC_IGNORE);CHKERRQ(ierr);
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                      Solve the eigensystem
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-  /*
-     First request an eigenvalue from one end of the spectrum
-  */
-  ierr = SVDSetWhichSingularTriplets(svd,SVD_LARGEST);CHKERRQ(ierr);
-  ierr = SVDSolve(svd);CHKERRQ(ierr);
-  /* 
-     Get number of converged singular values
-  */
-  ierr = SVDGetConverged(svd,&nconv1);CHKERRQ(ierr);
-  /* 
-     Get converged singular values: largest singular value is stored in sigma_1.
-     In this example, we are not interested in the singular vectors
-  */
-  if (nconv1 > 0) {
-    ierr = SVDGetSingularTriplet(svd,0,&sigma_1,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  } else {
-    ierr = PetscPrintf(PETSC_COMM_WORLD," Unable to compute large singular value!\n\n");CHKERRQ(ierr);
-  } 
-
-  /*
-     Request an eigenvalue from the other end of the spectrum
-  */
-  ierr = SVDSetWhichSingularTriplets(svd,SVD_SMALLEST);CHKERRQ(ierr);
-  ierr = SVDSolve(svd);CHKERRQ(ierr);
-  /* 
-     Get number of converged eigenpairs
-  */
-  ierr = SVDGetConverged(svd,&nconv2);CHKERRQ(ierr);
-  /* 
-     Get converged singular values: smallest singular value is stored in sigma_n. 
-     As before, we are not interested in the singular vectors
-  */
-  if (nconv2 > 0) {
-    ierr = SVDGetSingularTriplet(svd,0,&sigma_n,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
-  } else {
-    ierr = PetscPrintf(PETSC_COMM_WORLD," Unable to compute small singular value!\n\n");CHKERRQ(ierr);
-  } 
-
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
-                    Display solution and clean up
-     - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-  if (nconv1 > 0 && nconv2 > 0) {
-    ierr = PetscPrintf(PETSC_COMM_WORLD," Computed singular values: sigma_1=%6f, sigma_n=%6f\n",sigma_1,sigma_n);CHKERRQ(ierr);
-    ierr = PetscPrintf(PETSC_COMM_WORLD," Estimated condition number: sigma_1/sigma_n=%6f\n\n",sigma_1/sigma_n);CHKERRQ(ierr);
-  }  
- 
-  /* 
-     Free work space
-  */
-  ierr = SVDDestroy(svd);CHKERRQ(ierr);
-  ierr = MatDestroy(A);CHKERRQ(ierr);
-  ierr = SlepcFinalize();CHKERRQ(ierr);
-  return 0;
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt N=30, Istart, Iend, i, col[5], nconv1, nconv2;
+    PetscScalar value[] = { -1, 1, 1, 1, 1 };
+    PetscReal tol=1e-2, kappa, sigma_1, sigma_n;
+    PetscTruth reference=PETSC_FALSE;
+    PetscLogDouble t0, t1, t2;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&N,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-tol",&tol,PETSC_NULL);
+    PetscOptionsGetTruth(PETSC_NULL,"-reference",&reference,PETSC_NULL);
+    PetscPrintf(PETSC_COMM_WORLD,"\nEstimate the condition number of a Grcar matrix, n=%d\n\n",N);
+
+    petsc_cxx::Matrix<T> A(N);
+
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for( i=Istart; i<Iend; i++ )
+	{
+	    col[0]=i-1; col[1]=i; col[2]=i+1; col[3]=i+2; col[4]=i+3;
+	    if (i==0) { MatSetValues(A,1,&i,PetscMin(4,N),col+1,value+1,INSERT_VALUES); }
+	    else { MatSetValues(A,1,&i,PetscMin(5,N-i+1),col,value,INSERT_VALUES); }
+	}
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+
+    // both ends from a single bidiagonalization
+    slepc_cxx::ConditionNumber condition(tol);
+
+    PetscGetTime(&t0);
+    kappa = condition(A);
+    PetscGetTime(&t1);
+
+    std::cout << condition;
+
+    if (reference)
+	{
+	    SVD svd;
+	    SVDCreate(PETSC_COMM_WORLD,&svd);
+	    SVDSetOperator(svd,A);
+	    SVDSetFromOptions(svd);
+	    SVDSetDimensions(svd,1,PETSC_IGNORE,PETSC_IGNORE);
+
+	    SVDSetWhichSingularTriplets(svd,SVD_LARGEST);
+	    SVDSolve(svd);
+	    SVDGetConverged(svd,&nconv1);
+	    if (nconv1 > 0) { SVDGetSingularTriplet(svd,0,&sigma_1,PETSC_NULL,PETSC_NULL); }
+
+	    SVDSetWhichSingularTriplets(svd,SVD_SMALLEST);
+	    SVDSolve(svd);
+	    SVDGetConverged(svd,&nconv2);
+	    if (nconv2 > 0) { SVDGetSingularTriplet(svd,0,&sigma_n,PETSC_NULL,PETSC_NULL); }
+	    PetscGetTime(&t2);
+
+	    SVDDestroy(svd);
+
+	    if (nconv1 > 0 && nconv2 > 0)
+		{
+		    PetscPrintf(PETSC_COMM_WORLD," Two SVD solves: sigma_1=%6f, sigma_n=%6f, sigma_1/sigma_n=%6f\n",sigma_1,sigma_n,sigma_1/sigma_n);
+		    PetscPrintf(PETSC_COMM_WORLD," Relative difference of the estimates: %g\n",PetscAbsReal(kappa-sigma_1/sigma_n)/(sigma_1/sigma_n));
+		}
+	    PetscPrintf(PETSC_COMM_WORLD," Bidiagonalization: %10.3f s\n",t1-t0);
+	    PetscPrintf(PETSC_COMM_WORLD," Two SVD solves:    %10.3f s\n\n",t2-t1);
+	}
+
+    return condition.converged() ? 0 : 1;
 }
-
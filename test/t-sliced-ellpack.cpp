@@ -0,0 +1,126 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Times the products and the eigensolves of the ex2 Laplacian and the ex5 Markov model in AIJ and in SELL-C-sigma storage.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions of the Laplacian in both dimensions.\n"
+  "  -m <m>, where <m> = number of grid subdivisions of the Markov model.\n"
+  "  -sigma <s>, where <s> = sorting window of the sliced rows.\n"
+  "  -products <p>, where <p> = number of products timed for each storage.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+static void benchmark(const char* name, Mat A, EPSProblemType type, PetscInt sigma, PetscInt products)
+{
+    slepc_cxx::SlicedEllpack sell(sigma);
+    PetscLogDouble t0, t1, t2, t3, t4, t5, conversion;
+    PetscReal difference;
+    PetscInt i;
+    Vec x, y, z;
+    Mat S;
+
+    PetscGetTime(&t0);
+    S = sell(A);
+    PetscGetTime(&t1);
+    conversion = t1-t0;
+
+    MatGetVecs(A,&x,&y);
+    VecDuplicate(y,&z);
+    VecSetRandom(x,PETSC_NULL);
+
+    PetscGetTime(&t2);
+    for ( i = 0; i < products; i++ ) { MatMult(A,x,y); }
+    PetscGetTime(&t3);
+    for ( i = 0; i < products; i++ ) { MatMult(S,x,z); }
+    PetscGetTime(&t4);
+
+    VecAXPY(z,-1.0,y);
+    VecNorm(z,NORM_2,&difference);
+
+    slepc_cxx::EPSolver<T> aij;
+    EPSSetProblemType(aij,type);
+
+    slepc_cxx::EPSolver<T> sliced;
+    EPSSetProblemType(sliced,type);
+    sliced.setSliced();
+    sliced.slicedEllpack().setSigma(sigma);
+
+    PetscGetTime(&t5);
+    aij.solve(A);
+    PetscGetTime(&t0);
+    sliced.solve(A);
+    PetscGetTime(&t1);
+
+    std::cout << sell;
+    PetscPrintf(PETSC_COMM_WORLD," %-10s products: AIJ %8.3f s, SELL %8.3f s, difference %9.2e, conversion %8.3f s\n",
+		name,t3-t2,t4-t3,difference,conversion);
+    PetscPrintf(PETSC_COMM_WORLD," %-10s solve:    AIJ %8.3f s, SELL %8.3f s, %d and %d eigenpairs\n\n",
+		name,t0-t5,t1-t0,aij.getConverged(),sliced.getConverged());
+
+    VecDestroy(x);
+    VecDestroy(y);
+    VecDestroy(z);
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat A, B;
+    PetscInt N, n=300, m=200, Istart, Iend, II, i, j, sigma=256, products=100;
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-sigma",&sigma,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-products",&products,PETSC_NULL);
+    N = n*n;
+
+    // the 2-D Laplacian of ex2
+    MatCreate(PETSC_COMM_WORLD,&A);
+    MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(A);
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for( II=Istart; II<Iend; II++ )
+	{
+	    i = II/n; j = II-i*n;
+	    if(i>0) { MatSetValue(A,II,II-n,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(A,II,II+n,-1.0,INSERT_VALUES); }
+	    if(j>0) { MatSetValue(A,II,II-1,-1.0,INSERT_VALUES); }
+	    if(j<n-1) { MatSetValue(A,II,II+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(A,II,II,4.0,INSERT_VALUES);
+	}
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+
+    // the Markov model of ex5, rows of 2 to 4 entries
+    slepc_cxx::MarkovModel markov(m);
+    markov.create(&B);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nLaplacian N=%d (%dx%d grid), Markov model N=%d, C=%d, sigma=%d\n\n",N,n,n,markov.size(),slepc_cxx::SlicedEllpack::Chunk,sigma);
+
+    benchmark("Laplacian",A,EPS_HEP,sigma,products);
+    benchmark("Markov",B,EPS_NHEP,sigma,products);
+
+    MatDestroy(A);
+    MatDestroy(B);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Stationary distribution of the Markov model of a random walk on a triangular grid, "
+  "computed with Arnoldi and with the known-eigenvalue power iteration.\n\n"
+  "The command line options are:\n"
+  "  -m <m>, where <m> = number of grid subdivisions in each dimension.\n"
+  "  -shift <s>, where <s> = shift of the power iteration, the walk is periodic so s > 0 is needed.\n"
+  "  -period <p>, where <p> = number of steps between extrapolations, 0 disables them.\n"
+  "  -tol <tol>, where <tol> = tolerance on ||Ax-x||_1.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt N, m=100, period=10, ops, nconv;
+    PetscReal shift=1.0, tol=1e-10, diff;
+    PetscScalar kr, ki, sum;
+    PetscLogDouble t0, t1, t2;
+    Vec v0, x;
+
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-period",&period,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-shift",&shift,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-tol",&tol,PETSC_NULL);
+
+    N = m*(m+1)/2;
+    PetscPrintf(PETSC_COMM_WORLD,"\nMarkov Model, N=%d (m=%d)\n\n",N,m);
+
+    petsc_cxx::Matrix<T> A(N);
+    slepc_cxx::MarkovModel( m ).assemble( A );
+
+    MatGetVecs(A,&v0,PETSC_NULL);
+    VecDuplicate(v0,&x);
+    VecSet(v0,1.0);
+
+    PetscGetTime(&t0);
+
+    slepc_cxx::EPSolver<T> eps;
+    EPSSetProblemType(eps,EPS_NHEP);
+    EPSSetWhichEigenpairs(eps,EPS_LARGEST_REAL);
+    EPSSetDimensions(eps,1,PETSC_DECIDE,PETSC_DECIDE);
+    EPSSetTolerances(eps,tol,PETSC_DECIDE);
+    EPSSetFromOptions(eps);
+    eps.setInitialSpace(1,&v0);
+    eps(A);
+
+    PetscGetTime(&t1);
+
+    slepc_cxx::StationaryDistribution stationary;
+    stationary.setShift(shift);
+    stationary.setExtrapolation(period);
+    stationary.setTolerances(tol,100000);
+    stationary.solve(A);
+
+    PetscGetTime(&t2);
+
+    std::cout << eps;
+    std::cout << stationary;
+
+    EPSGetOperationCounters(eps,&ops,PETSC_NULL,PETSC_NULL);
+    EPSGetConverged(eps,&nconv);
+
+    PetscPrintf(PETSC_COMM_WORLD," Arnoldi:     %10.3f s, %d matrix-vector products\n",t1-t0,ops);
+    PetscPrintf(PETSC_COMM_WORLD," Stationary:  %10.3f s, %d matrix-vector products\n",t2-t1,stationary.matvecs());
+
+    if (nconv>0)
+	{
+	    EPSGetEigenpair(eps,0,&kr,&ki,x,PETSC_NULL);
+	    VecSum(x,&sum);
+	    VecScale(x,1.0/sum);
+	    VecAXPY(x,-1.0,stationary.distribution());
+	    VecNorm(x,NORM_1,&diff);
+	    PetscPrintf(PETSC_COMM_WORLD," ||x_arnoldi - x_stationary||_1 = %g\n",diff);
+	}
+    PetscPrintf(PETSC_COMM_WORLD,"\n");
+
+    VecDestroy(v0);
+    VecDestroy(x);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+
+static char help[] = "Solves the quadratic eigenproblem of ex16 on a larger grid, linearized, compact and compact with its structure, whose eigenvalues then keep their pairing.\n"
+  "The orthogonalisation times of both compact modes are compared.\n\n"
+  "The command line options are:\n"
+  "  -n <n>, where <n> = number of grid subdivisions in each dimension.\n"
+  "  -damping <c>, where <c> = C is c times the identity instead of zero, which makes the problem symmetric instead of gyroscopic.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+// largest distance of the real parts to -c/2, where the structure puts every eigenvalue of this problem
+static PetscReal pairing(slepc_cxx::CompactQEP& qep, PetscReal c)
+{
+    PetscReal defect = 0;
+    PetscScalar kr, ki;
+
+    for ( PetscInt i = 0; i < qep.getConverged(); i++ )
+	{
+	    qep.getEigenpair(i,&kr,&ki);
+	    defect = PetscMax(defect,PetscAbsScalar(kr+c/2));
+	}
+    return defect;
+}
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    Mat M, C, K;
+    PetscInt N, n=100, Istart, Iend, II, i, j, ncv;
+    PetscReal c=0;
+    PetscLogDouble t0, t1, t2, t3, t4, t5;
+    const char* names[] = { "automatic", "general", "symmetric", "gyroscopic" };
+
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    PetscOptionsGetReal(PETSC_NULL,"-damping",&c,PETSC_NULL);
+    N = n*n;
+    PetscPrintf(PETSC_COMM_WORLD,"\nQuadratic Eigenproblem, N=%d (%dx%d grid), damping %g\n\n",N,n,n,c);
+
+    // K is the 2-D Laplacian
+    MatCreate(PETSC_COMM_WORLD,&K);
+    MatSetSizes(K,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(K);
+    MatGetOwnershipRange(K,&Istart,&Iend);
+    for( II=Istart; II<Iend; II++ )
+	{
+	    i = II/n; j = II-i*n;
+	    if(i>0) { MatSetValue(K,II,II-n,-1.0,INSERT_VALUES); }
+	    if(i<n-1) { MatSetValue(K,II,II+n,-1.0,INSERT_VALUES); }
+	    if(j>0) { MatSetValue(K,II,II-1,-1.0,INSERT_VALUES); }
+	    if(j<n-1) { MatSetValue(K,II,II+1,-1.0,INSERT_VALUES); }
+	    MatSetValue(K,II,II,4.0,INSERT_VALUES);
+	}
+    MatAssemblyBegin(K,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(K,MAT_FINAL_ASSEMBLY);
+
+    // C is c times the identity matrix
+    MatCreate(PETSC_COMM_WORLD,&C);
+    MatSetSizes(C,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(C);
+    MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);
+    if (c != 0) { MatShift(C,c); }
+
+    // M is the identity matrix
+    MatCreate(PETSC_COMM_WORLD,&M);
+    MatSetSizes(M,PETSC_DECIDE,PETSC_DECIDE,N,N);
+    MatSetFromOptions(M);
+    MatAssemblyBegin(M,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(M,MAT_FINAL_ASSEMBLY);
+    MatShift(M,1.0);
+
+    slepc_cxx::QEPSolver<T> qep;
+    QEPSetProblemType(qep,QEP_GENERAL);
+
+    PetscGetTime(&t0);
+    qep.solve(M,C,K);
+    PetscGetTime(&t1);
+
+    std::cout << qep;
+
+    // the same dimensions and tolerances for both compact solves, only the structure differs
+    slepc_cxx::QEPSolver<T> general;
+    general.setCompact();
+    general.compact().setStructure(slepc_cxx::CompactQEP::General);
+
+    PetscGetTime(&t2);
+    general.solve(M,C,K);
+    PetscGetTime(&t3);
+
+    std::cout << general;
+
+    slepc_cxx::QEPSolver<T> structured;
+    structured.setCompact();
+
+    PetscGetTime(&t4);
+    structured.solve(M,C,K);
+    PetscGetTime(&t5);
+
+    std::cout << structured;
+
+    QEPGetDimensions(qep,PETSC_NULL,&ncv,PETSC_NULL);
+    PetscPrintf(PETSC_COMM_WORLD," Linearized:          %10.3f s, basis of %d scalars\n",t1-t0,2*N*(ncv+1));
+    PetscPrintf(PETSC_COMM_WORLD," Compact general:     %10.3f s, %3d iterations, pairing defect %9.2e\n",
+		t3-t2,general.compact().iterations(),pairing(general.compact(),c));
+    PetscPrintf(PETSC_COMM_WORLD," Compact %-12s %10.3f s, %3d iterations, pairing defect %9.2e\n\n",
+		names[structured.compact().structure()],t5-t4,structured.compact().iterations(),pairing(structured.compact(),c));
+
+    // the structured mode pays the form on every new column, it is not expected to be the faster one
+    PetscLogDouble og = general.compact().orthogonalizationTime(), os = structured.compact().orthogonalizationTime();
+    PetscPrintf(PETSC_COMM_WORLD," Orthogonalisation: general %.3f s, %s %.3f s, ratio %.2f\n\n",
+		og,names[structured.compact().structure()],os,og > 0 ? os/og : 0.0);
+
+    MatDestroy(M);
+    MatDestroy(C);
+    MatDestroy(K);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#include <slepc_cxx/slepc_cxx>
+#include "tall_matrix.h"
+
+static char help[] = "Scaling of the TSQR singular value decomposition of a tall sparse matrix over 1, 2, 4, ... ranks.\n\n"
+  "Every rank count runs on a subcommunicator of the first ranks, the Krylov solver is timed once on all of them.\n"
+  "The command line options are:\n"
+  "  -m <m>, where <m> = number of rows.\n"
+  "  -n <n>, where <n> = number of columns.\n\n";
+
+typedef petsc_cxx::Scalar T;
+
+int main(int ac, char** av)
+{
+    slepc_cxx::Parser parser(ac, av, help);
+    petsc_cxx::Context context( parser );
+
+    PetscInt m=100000, n=100, i, nconv;
+    PetscMPIInt rank, size, p;
+    PetscReal sigma, reference, difference=0;
+    PetscLogDouble t0, t1;
+    MPI_Comm sub;
+    Mat A;
+
+    PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);
+    PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);
+    MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+    MPI_Comm_size(PETSC_COMM_WORLD,&size);
+
+    PetscPrintf(PETSC_COMM_WORLD,"\nTSQR SVD of a %dx%d sparse matrix\n\n",m,n);
+    PetscPrintf(PETSC_COMM_WORLD,"   ranks     levels       time (s)\n");
+
+    for( p=1; p<=size; p*=2 )
+	{
+	    MPI_Comm_split(PETSC_COMM_WORLD,rank<p ? 0 : MPI_UNDEFINED,rank,&sub);
+	    if (rank<p)
+		{
+		    A = tallMatrix(sub,m,n);
+		    slepc_cxx::TallSkinnySVD tsqr(sub);
+		    MPI_Barrier(sub);
+		    PetscGetTime(&t0);
+		    tsqr.solve(A);
+		    PetscGetTime(&t1);
+		    PetscPrintf(sub,"   %5d     %6d     %10.3f\n",p,tsqr.levels(),t1-t0);
+		    MatDestroy(A);
+		    MPI_Comm_free(&sub);
+		}
+	    MPI_Barrier(PETSC_COMM_WORLD);
+	}
+
+    // on all the ranks, against the Krylov path of the same front-end
+    A = tallMatrix(PETSC_COMM_WORLD,m,n);
+
+    slepc_cxx::SVDSolver<T> tsqr;
+    slepc_cxx::SVDSolver<T> krylov;
+    krylov.setTallSkinny(0);
+
+    PetscGetTime(&t0);
+    tsqr.solve(A);
+    PetscGetTime(&t1);
+    PetscPrintf(PETSC_COMM_WORLD,"\n TSQR:   %10.3f s (%s)\n",t1-t0,tsqr.used() == slepc_cxx::SVDSolver<T>::TallSkinny ? "selected" : "not selected");
+    PetscGetTime(&t0);
+    krylov.solve(A);
+    PetscGetTime(&t1);
+    PetscPrintf(PETSC_COMM_WORLD," Krylov: %10.3f s\n\n",t1-t0);
+
+    std::cout << tsqr;
+    std::cout << krylov;
+
+    nconv = PetscMin(tsqr.getConverged(),krylov.getConverged());
+    for( i=0; i<nconv; i++ )
+	{
+	    krylov.getSingularTriplet(i,&reference);
+	    tsqr.getSingularTriplet(i,&sigma);
+	    difference = PetscMax(difference,PetscAbsReal(sigma-reference)/reference);
+	}
+    PetscPrintf(PETSC_COMM_WORLD," Largest relative difference of the %d leading singular values: %g\n\n",nconv,difference);
+
+    MatDestroy(A);
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+// -*- mode: c++; c-indent-level: 4; c++-member-init-indent: 8; comment-column: 35; -*-
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Authors: Caner Candan <caner@candan.fr>, http://caner.candan.fr
+ */
+
+#ifndef _test_tall_matrix_h
+#define _test_tall_matrix_h
+
+#include <slepc_cxx/slepc_cxx>
+
+// rows [offset, offset+m) of the tall test matrix with n columns, five entries per row, scales decaying with the column
+static Mat tallMatrix(MPI_Comm comm, PetscInt m, PetscInt n, PetscInt offset = 0)
+{
+    PetscInt i, c, col, Istart, Iend;
+    PetscScalar value;
+    Mat A;
+
+    MatCreate(comm,&A);
+    MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m,n);
+    MatSetFromOptions(A);
+    MatGetOwnershipRange(A,&Istart,&Iend);
+    for( i=Istart; i<Iend; i++ )
+	{
+	    for( c=0; c<5; c++ )
+		{
+		    col = ((offset+i)*7+c*131)%n;
+		    value = (c+1.0)/(1.0+col);
+		    MatSetValues(A,1,&i,1,&col,&value,ADD_VALUES);
+		}
+	}
+    MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);
+    return A;
+}
+
+#endif // !_test_tall_matrix_h